@@ -25,9 +25,11 @@
 
 #include "Defines.h"
 
+#include <array>
 #include <string>
 #include <vector>
 #include <cstdint>
+#include <functional>
 #include <filesystem>
 #include <string_view>
 
@@ -95,6 +97,20 @@ struct CharClass
     bool                   negated = false;   ///< True for negated classes ([^...]).
     std::vector<char>      singles;           ///< Explicit characters.
     std::vector<CharRange> ranges;            ///< Character ranges.
+
+    std::array<std::uint64_t, 4> bitmap{};    ///< Compiled 256-bit membership set (negation applied).
+
+    /**
+     * @brief Tests a character against the compiled bitmap.
+     *
+     * @param ch Candidate character.
+     * @return true if @p ch belongs to the class.
+     */
+    bool Test(char ch) const noexcept
+    {
+        const unsigned char x = static_cast<unsigned char>(ch);
+        return (bitmap[x >> 6] >> (x & 63)) & 1u;
+    }
 };
 
 
@@ -173,7 +189,26 @@ struct Atom
  */
 struct Segment
 {
-    std::vector<Atom> atoms;  ///< Atoms composing the segment.
+    /**
+     * @brief Star-free run of fixed-width atoms.
+     *
+     * A segment compiles to the runs found between its '*' atoms; each run
+     * consumes exactly @ref width characters, which turns matching into a
+     * sequence of anchored checks and leftmost searches.
+     */
+    struct Chunk
+    {
+        std::size_t first      = 0;                       ///< First atom index (inclusive).
+        std::size_t last       = 0;                       ///< Last atom index (exclusive).
+        std::size_t width      = 0;                       ///< Characters consumed by the run.
+        std::size_t key        = static_cast<std::size_t>(-1); ///< Longest literal atom used as search key, or npos.
+        std::size_t key_offset = 0;                       ///< Offset of the key literal inside the run.
+    };
+
+    std::vector<Atom>  atoms;            ///< Atoms composing the segment.
+    std::vector<Chunk> chunks;           ///< Compiled runs split at '*' atoms.
+    std::size_t        min_len  = 0;     ///< Minimum name length able to match.
+    bool               compiled = false; ///< True once @ref chunks is valid.
 
     /**
      * @brief Checks whether this segment consists only of '**'.
@@ -221,13 +256,40 @@ struct Options
  */
 struct ExpandOptions
 {
-    bool follow_symlinks  = false;          ///< Follow symbolic links.
+    bool follow_symlinks  = false;          ///< Follow symbolic links (each real directory is walked once per pattern state).
     bool include_dotfiles = false;          ///< Include dotfiles.
+
+    /// Persistent directory listing cache file (empty disables it).
+    /// Listings are reused across runs while the directory mtime/inode are unchanged.
+    fs::path listing_cache{};
+
+    /// Drop the cached listings this call did not visit. Set it only on a pass expanding
+    /// every glob of the build, otherwise the listings of the other globs are thrown away.
+    bool prune_listing_cache = false;
+
+    /// Exclusion patterns, relative to the same base directory as the expanded ones.
+    /// A matching directory is never descended into and a matching file is never emitted.
+    std::vector<Pattern> exclude{};
+
+    /// Gitignore-style files honoured while walking (e.g. ".gitignore", ".arcignore"); empty disables.
+    /// Rules apply to the directory holding the file and below; ignored entries are not reached by
+    /// wildcard segments, while literal segments naming them still are.
+    std::vector<std::string> ignore_files{};
 };
 
 
 
 
+/**
+ * @brief Receives glob matches as the traversal finds them.
+ *
+ * Called with the index of the matching pattern and the generic path.
+ */
+using Sink = std::function<void(std::size_t pattern, const std::string& path)>;
+
+
+
+
 /**
  * @brief Captured value during glob matching.
  */
@@ -308,6 +370,52 @@ bool Expand(const Pattern& pattern, const fs::path& base_dir, std::vector<std::s
 
 
 
+/**
+ * @brief Expands several parsed glob patterns, streaming matches as they are found.
+ *
+ * Matches are delivered during the traversal, in walk order and without the
+ * final sort, so consumers can start working before the walk completes.
+ *
+ * @param[in]  patterns Parsed glob patterns.
+ * @param[in]  base_dir Base directory for relative patterns.
+ * @param[in]  sink Called with (pattern index, generic path) for every match.
+ * @param[in]  opt Expansion options.
+ * @param[in]  exclude_scopes Per-pattern indexes into opt.exclude; when empty every
+ *                            exclusion applies to every pattern.
+ *
+ * @return true on success, false if a start directory does not exist.
+ */
+bool ExpandStream(const std::vector<Pattern>& patterns, const fs::path& base_dir,
+                  const Sink& sink,
+                  const ExpandOptions& opt = ExpandOptions{},
+                  const std::vector<std::vector<std::size_t>>& exclude_scopes = {}) noexcept;
+
+
+
+/**
+ * @brief Expands several parsed glob patterns in one filesystem traversal.
+ *
+ * Patterns are matched together while walking, so every directory is listed
+ * at most once per call even when many patterns (or "**" segments) reach it.
+ *
+ * @param[in]  patterns Parsed glob patterns.
+ * @param[in]  base_dir Base directory for relative patterns.
+ * @param[out] outs Output lists of matched paths, one per pattern.
+ * @param[in]  opt Expansion options.
+ * @param[in]  exclude_scopes Per-pattern indexes into opt.exclude; when empty every
+ *                            exclusion applies to every pattern.
+ * @param[in]  on_match Optional observer called as matches are found, before sorting.
+ *
+ * @return true on success, false if a start directory does not exist.
+ */
+bool ExpandAll(const std::vector<Pattern>& patterns, const fs::path& base_dir,
+               std::vector<std::vector<std::string>>& outs,
+               const ExpandOptions& opt = ExpandOptions{},
+               const std::vector<std::vector<std::size_t>>& exclude_scopes = {},
+               const Sink& on_match = {}) noexcept;
+
+
+
 /**
  * @brief Maps one glob expansion to another glob pattern.
  *
@@ -324,13 +432,13 @@ bool Expand(const Pattern& pattern, const fs::path& base_dir, std::vector<std::s
  *
  * @return true on success, false on error.
  */
-bool MapGlobToGlob(std::vector<std::string>    from_glob,
-                    std::string_view                to_glob,
-                    std::vector<std::string> src_list,
-                    std::vector<std::string>&       out_list,
-                    ParseError&                     err_from,
-                    ParseError&                     err_to,
-                    MapError&                       err_map) noexcept;
+bool MapGlobToGlob(const std::vector<std::string>& from_glob,
+                   std::string_view                to_glob,
+                   const std::vector<std::string>& src_list,
+                   std::vector<std::string>&       out_list,
+                   ParseError&                     err_from,
+                   ParseError&                     err_to,
+                   MapError&                       err_map) noexcept;
 
 
 
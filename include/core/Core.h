@@ -25,7 +25,10 @@
 #include "Jobs.h"
 #include "Defines.h"
 
+#include <map>
 #include <thread>
+#include <cstdint>
+#include <string_view>
 
 
 BEGIN_MODULE(Core)
@@ -109,6 +112,8 @@ struct RunOptions
     bool     silent          = false;                               ///< Suppress standard output.
     bool     stop_on_error   = true;                                ///< Stop execution on first error.
     unsigned max_parallelism = std::thread::hardware_concurrency(); ///< Max concurrent jobs.
+
+    std::map<std::string, std::uint32_t> pools;                     ///< Resource pool sizes (`using pool`).
 };
 
 
@@ -155,7 +160,7 @@ symbol(Core::SymbolType type) noexcept;
  * @return Corresponding SymbolType or SymbolType::UNDEFINED.
  */
 SymbolType
-is_symbol(const std::string& symbol) noexcept;
+is_symbol(std::string_view symbol) noexcept;
 
 
 
@@ -184,7 +189,7 @@ is_symbol_set(Core::SymbolType type) noexcept;
  * @brief Checks whether a string matches a supported operating system identifier.
  */
 bool
-is_os(const std::string& param) noexcept;
+is_os(std::string_view param) noexcept;
 
 
 
@@ -192,7 +197,7 @@ is_os(const std::string& param) noexcept;
  * @brief Checks whether a string matches a supported architecture identifier.
  */
 bool
-is_arch(const std::string& param) noexcept;
+is_arch(std::string_view param) noexcept;
 
 
 
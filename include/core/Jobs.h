@@ -26,6 +26,7 @@
 #include "Defines.h"
 #include "Semantic.h"
 
+#include <cstdint>
 #include <variant>
 #include <unordered_set>
 
@@ -71,12 +72,15 @@ class List;
  */
 struct Job
 {
-    std::string            name;            ///< Job name.
-    Semantic::Task::Instrs instructions;    ///< Instructions to execute.
-    Semantic::Interpreter  interpreter;     ///< Interpreter used to run the job.
-    bool                   parallelizable;  ///< Whether the job can run in parallel.
-    bool                   expanded;
-    bool                   echo;            ///< Whether command echoing is enabled.
+    std::string              name;            ///< Job name.
+    Semantic::Task::Instrs   instructions;    ///< Instructions to execute.
+    Semantic::Task::Elements elements;        ///< List element of each instruction (expanded jobs only).
+    Semantic::Interpreter    interpreter;     ///< Interpreter used to run the job.
+    std::string              pool;            ///< Resource pool the instructions are charged to (may be empty).
+    std::uint32_t            weight;          ///< Cost of each instruction against thread and pool budgets.
+    bool                     parallelizable;  ///< Whether the job can run in parallel.
+    bool                     expanded;
+    bool                     echo;            ///< Whether command echoing is enabled.
 };
 
 
@@ -106,19 +110,23 @@ struct Job
 class List
 {
 public:
-    List()            = default;
-    List(const List&) = default;
+    List()                       = default;
+    List(const List&)            = delete;
+    List(List&&)                 = default;
+    List& operator=(const List&) = delete;
+    List& operator=(List&&)      = default;
 
     /**
      * @brief Builds a job list from a semantic environment.
      *
      * @param[in]  environment Semantic environment.
      * @param[out] out Output job list.
+     * @param[in]  consume Move task instructions out of the environment into the jobs.
      *
     * @return ARCANA_RESULT__OK on success, otherwise a failure code.
      */
     static Arcana_Result
-    FromEnv(Semantic::Enviroment& environment, List& out, std::vector<std::string>& recovery) noexcept;
+    FromEnv(Semantic::Enviroment& environment, List& out, std::vector<std::string>& recovery, bool consume = true) noexcept;
 
     /**
      * @brief Returns all jobs in execution order.
@@ -132,8 +140,7 @@ public:
     std::string main_job; ///< Name of the main job.
 
 private:
-    void Insert(const std::optional<Job>& j);
-    void Insert(std::vector<Job>& vj);
+    void Insert(std::optional<Job>&& j);
 
     std::unordered_set<std::string> index; ///< Job name index for uniqueness.
     std::vector<Job>                data;  ///< Ordered job list.
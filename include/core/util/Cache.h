@@ -27,8 +27,16 @@
 #include <cstddef>
 #include <cstdint>
 #include <string>
+#include <string_view>
 #include <map>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
 #include <filesystem>
+#include <unordered_map>
+#include <unordered_set>
+#include <condition_variable>
 
 
 
@@ -214,6 +222,68 @@ private:
 
 
 
+/**
+ * @brief Process-wide path intern table.
+ *
+ * Every distinct path is stored once and handed out as a dense integer id,
+ * so glob results, cache lookups and job pruning can refer to files by id.
+ * The binary MD5 of the path (the key of the input cache records) is computed
+ * once, when the path is first interned.
+ *
+ * This class is a singleton, cannot be copied or moved and is thread safe.
+ */
+class PathTable
+{
+public:
+    using Id = std::uint32_t;
+
+    PathTable(const PathTable&)              = delete;
+    PathTable& operator = (const PathTable&) = delete;
+
+    /**
+     * @brief Returns the global path table instance.
+     */
+    static PathTable& Instance()
+    {
+        static PathTable t;
+        return t;
+    }
+
+    /**
+     * @brief Returns the id of a path, interning it on first use.
+     *
+     * @param[in] path File path, compared as spelled (not canonicalized).
+     * @return Dense id of the path.
+     */
+    Id Intern(std::string_view path) noexcept;
+
+    /**
+     * @brief Returns the path interned under an id.
+     */
+    const std::string& Path(Id id) const noexcept;
+
+    /**
+     * @brief Returns the binary MD5 of the path interned under an id.
+     */
+    const std::string& Key(Id id) const noexcept;
+
+private:
+    /** @brief Private constructor for singleton enforcement. */
+    PathTable() = default;
+
+    struct Entry
+    {
+        std::string path;   ///< Interned path.
+        std::string key;    ///< Binary MD5 of the path.
+    };
+
+    mutable std::mutex                       _mutex;   ///< Guards the tables below.
+    std::deque<Entry>                        _entries; ///< Entries by id (stable addresses).
+    std::unordered_map<std::string_view, Id> _ids;     ///< Path (view into _entries) -> id.
+};
+
+
+
 /**
  * @brief Global cache manager.
  *
@@ -231,7 +301,7 @@ public:
     Manager(Manager&&)                    noexcept = delete;
     Manager& operator = (const Manager&&) noexcept = delete;
 
-    ~Manager() = default;
+    ~Manager();
 
     /**
      * @brief Returns the global cache manager instance.
@@ -244,9 +314,11 @@ public:
 
 
     /**
-     * @brief Removes all cached data from disk.
+     * @brief Appends the current record of a file to the cache on disk.
+     *
+     * @param[in] file Interned file path.
      */
-    void Store(const std::string& key) noexcept;
+    void Store(PathTable::Id file) noexcept;
 
 
 
@@ -264,9 +336,11 @@ public:
 
 
     /**
-     * @brief Clears the in-memory cache state.
+     * @brief Drops files from the in-memory cache state.
+     *
+     * @param[in] files Interned file paths.
      */
-    void ClearCache(const std::vector<std::string>& keys = {}) noexcept;
+    void ClearCache(const std::vector<PathTable::Id>& files = {}) noexcept;
 
 
     /**
@@ -280,10 +354,30 @@ public:
     /**
      * @brief Checks whether a file has changed since the last cache update.
      *
-     * @param[in] path Path to the file to check.
+     * @param[in] file Interned path of the file to check.
      * @return true if the file content differs from the cached version.
      */
-    bool HasFileChanged(const std::string& path) noexcept;
+    bool HasFileChanged(PathTable::Id file) noexcept;
+
+
+    /**
+     * @brief Queues a file for background content hashing.
+     *
+     * HasFileChanged() reuses the digest instead of reading the file again, so
+     * hashing overlaps with the work done before cache checks (e.g. globbing).
+     *
+     * @param[in] file Interned path of the file to hash.
+     */
+    void Prefetch(PathTable::Id file) noexcept;
+
+
+    /**
+     * @brief Stops and joins the prefetch workers.
+     *
+     * Queued paths nobody asked for yet are dropped. Called before the process
+     * exits, so no worker outlives the tables it reads.
+     */
+    void StopHashers() noexcept;
 
 
     /**
@@ -301,12 +395,84 @@ public:
                          const std::string& content,
                          const std::string& ext = "") noexcept;
 
+
+    /**
+     * @brief Writes a content-addressed response file.
+     *
+     * The file is named after the digest of its content, so an unchanged list
+     * maps to the same file and is not written again.
+     *
+     * @param[in] content Response file content.
+     *
+     * @return Path to the response file.
+     */
+    fs::path WriteResponseFile(const std::string& content) noexcept;
+
+
+    /**
+     * @brief Deletes the response files not written or reused by this run.
+     *
+     * Response files are content-addressed, so every changed list leaves its
+     * previous file behind; pruning after the run keeps only the current ones.
+     */
+    void PruneResponseFiles() noexcept;
+
+
+    /**
+     * @brief Restores an aligned semantic environment from its snapshot.
+     *
+     * The snapshot is used only if it was taken for the same selector and
+     * every source script it was built from still has the same content.
+     * The MAIN, PROFILE and THREADS symbols recorded with it are re-applied.
+     *
+     * @param[in]  selector Run selector (arcfile, CLI overrides, platform).
+     * @param[out] env      Restored environment.
+     *
+     * @return true if the environment was restored.
+     */
+    bool LoadEnvironment(const std::string& selector, Semantic::Enviroment& env) noexcept;
+
+
+    /**
+     * @brief Writes the snapshot of an aligned semantic environment.
+     *
+     * Snapshots of other selectors are deleted, so only the latest one is kept.
+     *
+     * @param[in] selector Run selector (arcfile, CLI overrides, platform).
+     * @param[in] sources  Scripts the environment was built from.
+     * @param[in] env      Environment after CheckArgs() and AlignEnviroment().
+     */
+    void StoreEnvironment(const std::string& selector,
+                          const std::vector<std::string>& sources,
+                          const Semantic::Enviroment& env) noexcept;
+
+
+    /**
+     * @brief Returns the path of the persistent glob listing cache.
+     *
+     * @return Listing cache file path (inside the cache folder).
+     */
+    const fs::path& GlobListingPath() const noexcept { return _glob_path; }
+
 private:
     /** @brief Private constructor for singleton enforcement. */
     Manager();
 
     static constexpr std::size_t MD5_RAW_SIZE   = 16;
     static constexpr std::size_t FILE_REC_SIZE  = 32;
+    static constexpr unsigned    HASH_WORKERS   = 4;
+
+    /** @brief Returns the content digest of a file, memoized for the whole run. */
+    std::string Digest(PathTable::Id file) noexcept;
+
+    /** @brief Background hashing loop fed by Prefetch(). */
+    void HashWorker() noexcept;
+
+    /** @brief Serializes the snapshot payload of an environment. */
+    static void EncodeEnvironment(const Semantic::Enviroment& env, std::string& out) noexcept;
+
+    /** @brief Restores an environment from a snapshot payload, false if malformed. */
+    static bool DecodeEnvironment(std::string_view in, Semantic::Enviroment& env) noexcept;
 
     class PairMap : public std::map<std::string, std::pair<bool, std::string>>
     {
@@ -336,12 +502,26 @@ private:
     fs::path _cache_folder;                             ///< Cache root directory.
     fs::path _script_path;                              ///< Script output directory.
     fs::path _binary;                                   ///< Cached items file.
+    fs::path _glob_path;                                ///< Glob directory listing cache file.
+    fs::path _rsp_path;                                 ///< Response file directory.
+    fs::path _env_path;                                 ///< Environment snapshot directory.
 
     uint64_t _store_idx;
 
     BinFile             _mnt_binary;
     std::string         _cached_profile;                        ///< Cached profile identifier.
     PairMap             _cached_files;
+
+    std::mutex                                     _hash_mutex;     ///< Guards the prefetch state below.
+    std::condition_variable                        _hash_cv;        ///< Signals queued paths and finished digests.
+    std::deque<PathTable::Id>                      _hash_queue;     ///< Paths waiting for a worker.
+    std::unordered_set<PathTable::Id>              _hash_pending;   ///< Paths queued or being hashed.
+    std::unordered_map<PathTable::Id, std::string> _hashed;         ///< Content digests by path, kept for the run.
+    std::vector<std::thread>                       _hashers;        ///< Workers, started on first Prefetch().
+    bool                                           _hash_stop;      ///< Set on shutdown.
+
+    std::mutex                                     _rsp_mutex;      ///< Serializes response file writes.
+    std::unordered_set<std::string>                _rsp_used;       ///< Response file names of this run.
 };
 
 
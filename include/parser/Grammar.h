@@ -2,8 +2,8 @@
 #define __ARCANA_GRAMMAR__H__
 
 
-#include <map>
 #include <set>
+#include <array>
 #include <vector>
 
 #include "Lexer.h"
@@ -547,10 +547,16 @@ struct Match
  * - The match_out object will be updated to signal completion or errors.
  *
  * Internals:
- * - _rules holds grammar productions.
+ * - _table holds the productions compiled into per-state transition nodes:
+ *   a state is a (rule, position) pair and each node stores the accepted
+ *   TokenType set as a bitmask, so a transition is a single bit test.
+ * - _rules keeps the source productions, used only to build diagnostics.
  * - _index stores capture indices per rule.
  * - EngineCache tracks current in-flight rule candidates and auxiliary state
  *   (e.g. opened curly braces for multi-line bodies).
+ *
+ * After construction match() performs no allocation per token; error context
+ * (expected terminals, candidate rules) is materialized only on failure.
  */
 class Engine
 {
@@ -574,34 +580,69 @@ public:
     void match(const Scan::Token& token, Match& match);
     
 private:
+    /// Number of rule slots (indexed by Rule value, slot 0 is UNDEFINED).
+    static constexpr std::size_t RULES = _I(Rule::ASSERT_ACT) + 1;
+
+    // Node::accept HOLDS ONE BIT PER TokenType (OPT_NEWLINE IS THE LAST ONE), EngineCache::keys ONE BIT PER Rule
+    static_assert(_I(Scan::TokenType::OPT_NEWLINE) < 64, "Node::accept is too narrow for Scan::TokenType");
+    static_assert(RULES <= 32,                           "EngineCache::keys is too narrow for Rule");
+
+    /**
+     * @brief Compiled production node (one grammar state).
+     */
+    struct Node
+    {
+        /// Bitmask of TokenType values accepted by this node.
+        uint64_t accept;
+
+        /// True if the node is an ANY wildcard.
+        bool     any;
+
+        /// True if the node is an OPT_NEWLINE slot.
+        bool     opt;
+    };
+
+    /**
+     * @brief Visited state, recorded per token to rebuild error context on failure.
+     */
+    struct Step
+    {
+        Rule     rule;
+        uint32_t position;
+    };
+
+    void _compile(const Rule rule, const NonTerminal& production);
     void _collect_input(const Scan::Token& token, const Scan::TokenType tt, const Rule st, const uint32_t pos);
     void _reset();
 
     struct EngineCache
     {
-        EngineCache() : opened_curly_braces(0) {}
+        EngineCache() : keys(0), data{}, opened_curly_braces(0), active(false) {}
 
-        /// Candidate rules still compatible with the current input prefix.
-        UniqueRule                  keys;
+        /// Candidate rules still compatible with the current input prefix (bit per Rule).
+        uint32_t                       keys;
 
         /// Per-rule cursor/progress position in the production.
-        std::map<Rule, uint32_t>    data;
-
-        /// Per-rule captured raw items (implementation-defined usage).
-        std::map<Rule, std::string> items;
+        std::array<uint32_t, RULES>    data;
 
         /// Tracks nested curly braces when parsing task bodies.
-        std::size_t                 opened_curly_braces;
+        std::size_t                    opened_curly_braces;
+
+        /// True while a statement is being matched.
+        bool                           active;
 
         /// Resets the cache to the initial state.
-        void reset() { keys.clear(); data.clear(); items.clear(); opened_curly_braces = 0; }
+        void reset() { keys = 0; data.fill(0); opened_curly_braces = 0; active = false; }
     } _cache;
     
-    /// Grammar productions table.
-    Production                         _rules;
+    /// Grammar productions table (diagnostics only).
+    std::array<NonTerminal, RULES>        _rules;
+
+    /// Compiled transition table, one node vector per rule.
+    std::array<std::vector<Node>, RULES>  _table;
 
     /// Captured indices per rule during matching.
-    std::map<Rule, std::vector<Index>> _index;
+    std::array<std::vector<Index>, RULES> _index;
 };
 
 
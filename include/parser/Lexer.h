@@ -3,10 +3,12 @@
 
 
 #include <set>
+#include <string>
 #include <vector>
 #include <sstream>
 #include <istream>
 #include <fstream>
+#include <string_view>
 
 #include "Defines.h"
 
@@ -19,11 +21,11 @@
  * This header defines the tokenization layer. The lexer consumes an Arcana script
  * source and produces a stream of Token objects. Each Token records:
  * - token type (TokenType)
- * - matched lexeme (raw text)
+ * - matched lexeme (view into the source buffer)
  * - source location metadata (line and span indices)
  *
- * The lexer also retains the original source lines to support diagnostics and
- * error reporting with line excerpts.
+ * The whole script is held in a single buffer (memory-mapped when possible);
+ * source lines for diagnostics are sliced from it on demand.
  */
 
 /**
@@ -176,13 +178,15 @@ enum class TokenType : uint32_t
 /// - line: 1-based line number in the source file
 /// - start/end: indices of the lexeme span (implementation-defined; commonly column offsets)
 ///              start is inclusive, end is exclusive.
+///
+/// The lexeme is a view into the Lexer buffer and is valid while the Lexer lives.
 struct Token 
 {
-    TokenType    type;         //<! Type of token
-    std::string  lexeme;       //<! lexeme matched   
-    std::size_t  line;         //<! Line of match
-    std::size_t  start;        //<! Lexeme start index match  
-    std::size_t  end;          //<! Lexeme end index match
+    TokenType         type;    //<! Type of token
+    std::string_view  lexeme;  //<! lexeme matched   
+    std::size_t       line;    //<! Line of match
+    std::size_t       start;   //<! Lexeme start index match  
+    std::size_t       end;     //<! Lexeme end index match
 };
 
 
@@ -201,16 +205,19 @@ struct Token
  * @brief Arcana script lexer (scanner).
  *
  * Lexer is a stateful token generator:
- * - it reads from an input stream (file_ / in_)
+ * - it reads the whole script once into a single buffer (data_ / size_),
+ *   memory-mapped when the platform allows it
  * - tracks current character and source position (line_/col_)
  * - exposes Lexer::next() to obtain the next Token
  *
- * The lexer also stores all source lines (lines vector) to support diagnostics.
+ * Source lines for diagnostics are not stored: line starts are indexed lazily,
+ * only up to the highest line requested through operator[].
  *
  * Ownership/lifetime notes:  
  * - arcscript_ is stored as a reference to the constructor argument, so the
  *   referenced string must outlive the Lexer instance.  
- * - file_ holds the underlying file stream when constructed from a path.
+ * - token lexemes and returned lines are views into the buffer, valid while
+ *   the Lexer lives.
  */
 class Lexer 
 {
@@ -225,6 +232,14 @@ public:
      */
     explicit Lexer(const std::string& arcscript);
 
+    /**
+     * @brief Releases the source mapping, if any.
+     */
+    ~Lexer();
+
+    Lexer(const Lexer&)              = delete;
+    Lexer& operator = (const Lexer&) = delete;
+
     /**
      * @brief Returns the next token in the input stream.
      *
@@ -239,12 +254,9 @@ public:
      * @brief Returns the raw source line at index pos (0-based).
      *
      * @param pos 0-based line index.
-     * @return Copy of the stored source line.
+     * @return View of the source line (without '\n'), empty when out of range.
      */
-    inline std::string operator[] (const size_t pos) 
-    {
-        return lines[pos];
-    }
+    std::string_view operator[] (const size_t pos);
 
     /**
      * @brief Returns the raw source line containing the given token.
@@ -252,11 +264,11 @@ public:
      * Token.line is treated as 1-based, therefore the lookup uses (line - 1).
      *
      * @param token Token whose line should be retrieved.
-     * @return Reference to the stored source line.
+     * @return View of the source line.
      */
-    inline std::string& operator[] (const Token& token) 
+    inline std::string_view operator[] (const Token& token) 
     {
-        return lines[token.line - 1];
+        return (*this)[token.line - 1];
     }
 
     /**
@@ -266,20 +278,32 @@ public:
      */
     inline const std::string& source() const { return arcscript_; }
 
+    /**
+     * @brief Returns the whole source buffer.
+     *
+     * @return View of the script contents (valid for the lexer lifetime).
+     */
+    inline std::string_view buffer() const noexcept { return { data_, size_ }; }
+
 private:
-    char                     current_;   ///< Current character under examination.
-    std::size_t              line_;      ///< Current 1-based line counter.
-    std::size_t              col_;       ///< Current column counter (implementation-defined).
-    std::size_t              nlcol_;     ///< Column counter used for newline handling (implementation-defined).
-    std::ifstream            file_;      ///< File stream backing the lexer (when reading from file).
-    std::istream&            in_;        ///< Input stream reference used by the lexer.
-    const std::string&       arcscript_; ///< Reference to script path string (must outlive Lexer).
-    std::vector<std::string> lines;      ///< Cached source lines for diagnostics.
-
-    /// Loads the entire input stream into the lines vector (diagnostic support).
-    void  load_file_lines(std::istream& in);
-
-    /// Advances the stream by one character, updating position counters.
+    char                     current_;     ///< Current character under examination.
+    std::size_t              line_;        ///< Current 1-based line counter.
+    std::size_t              col_;         ///< Current column counter (implementation-defined).
+    std::size_t              nlcol_;       ///< Column counter used for newline handling (implementation-defined).
+    const char*              data_;        ///< Source buffer (mapping or owned_).
+    std::size_t              size_;        ///< Source buffer size in bytes.
+    std::size_t              pos_;         ///< Offset of the next character to read.
+    bool                     eof_;         ///< Set once a read runs past the end of the buffer.
+    void*                    map_;         ///< Memory mapping of the script (nullptr when not mapped).
+    std::string              owned_;       ///< Owned copy of the script when it cannot be mapped.
+    const std::string&       arcscript_;   ///< Reference to script path string (must outlive Lexer).
+    std::vector<std::size_t> line_starts_; ///< Offsets of the line starts indexed so far.
+    bool                     lines_done_;  ///< True once line_starts_ covers the whole buffer.
+
+    /// Maps (or reads) the whole script into the source buffer.
+    void  load_source();
+
+    /// Advances the buffer by one character, updating position counters.
     void  advance();
 
     /// Skips whitespace (except newlines if NEWLINE is significant).
@@ -295,7 +319,7 @@ private:
     Token number();
 
     /// Constructs a token with explicit payload and location.
-    Token makeToken(TokenType type, std::string lexeme,
+    Token makeToken(TokenType type, std::string_view lexeme,
                     std::size_t line, std::size_t start, std::size_t end);
 };
 
@@ -6,7 +6,10 @@
 #include "Grammar.h"
 #include "Semantic.h"
 
+#include <string>
+#include <vector>
 #include <functional>
+#include <unordered_map>
 
 
 
@@ -97,6 +100,100 @@ using PostProcError = std::function<Arcana_Result (const std::string& ctx, const
 //                                                                                                                                                                  
 
 
+/**
+ * @brief Parsed environments of imported scripts, built ahead of the main parse.
+ *
+ * Prefetch() pre-scans the import graph reachable from the root script,
+ * deduplicates files by canonical path and content hash and parses each
+ * distinct file once, concurrently, level by level (imported files first).
+ * Parser::Handle_Import then merges a copy of the cached environment at the
+ * position of the import statement, so merge order is unchanged.
+ *
+ * Files that fail to parse, or that are part of an import cycle, are left
+ * out of the cache: the parser falls back to parsing them in place, which
+ * reports diagnostics exactly as before. Prefetch parses leave the builtin
+ * symbols alone; their updates are recorded and applied on merge.
+ */
+class ImportCache
+{
+public:
+    /**
+     * @brief Discover and parse every file imported (transitively) by a script.
+     *
+     * @param root    Root script path.
+     * @param threads Maximum number of parsing threads.
+     */
+    void Prefetch(const std::string& root, std::size_t threads) noexcept;
+
+    /**
+     * @brief Look up the parsed environment of an imported script.
+     *
+     * The symbol updates recorded while parsing it are applied to @p engine.
+     *
+     * @param script Import path as written in the script.
+     * @param engine Engine of the importing script.
+     * @return Pointer to the cached environment, nullptr if not available.
+     */
+    const Semantic::Enviroment* Find(const std::string& script, Semantic::Engine& engine) const noexcept;
+
+    /**
+     * @brief Hand out the parsed environment of a script imported by the root.
+     *
+     * The environment is copied, except for the last import expected from the
+     * root script which moves it out; the entry is then no longer cached.
+     * The symbol updates recorded while parsing it are applied to @p engine
+     * first, so they land in import order.
+     * Not thread safe: only used by the main (sequential) parse.
+     *
+     * @param script Import path as written in the script.
+     * @param env    Output environment.
+     * @param engine Engine of the importing script.
+     * @return True if the environment was available.
+     */
+    bool                        Take(const std::string& script, Semantic::Enviroment& env, Semantic::Engine& engine) noexcept;
+
+    /**
+     * @brief Canonical paths of every script discovered by Prefetch().
+     */
+    std::vector<std::string>    Files() const noexcept;
+
+private:
+    /// Missing entry marker.
+    static constexpr std::size_t npos = std::size_t(-1);
+
+    /// Resolve an import path to a parsed entry index (npos if unavailable).
+    std::size_t Lookup(const std::string& script) const noexcept;
+
+    struct Entry
+    {
+        /// Import path as first seen.
+        std::string              script;
+
+        /// Entries imported by this script.
+        std::vector<std::size_t> imports;
+
+        /// Parse outcome.
+        Arcana_Result            result = Arcana_Result::ARCANA_RESULT__NOK;
+
+        /// Imports of this script expected from the root script.
+        std::size_t              takes  = 0;
+
+        /// Parsed environment (valid when result is OK).
+        Semantic::Enviroment     env;
+
+        /// Builtin symbol updates recorded while parsing.
+        Semantic::DeferredSymbols symbols;
+    };
+
+    /// Distinct imported scripts.
+    std::vector<Entry>                           _entries;
+
+    /// Canonical path -> entry index.
+    std::unordered_map<std::string, std::size_t> _paths;
+};
+
+
+
 /**
  * @brief High-level parser that builds a Semantic::Enviroment from an Arcana script.
  *
@@ -161,6 +258,37 @@ public:
      */
     void          Set_PostProcessError_Handler(const PostProcError& ecb) noexcept { PostProc_Error = std::move(ecb); }
 
+    /**
+     * @brief Sets the cache of pre-parsed imports consulted by Handle_Import.
+     *
+     * @param cache      Import cache (must outlive the parser), nullptr to disable.
+     * @param cache_only When true, imports missing from the cache fail silently
+     *                   instead of being parsed in place, and builtin symbol
+     *                   updates are recorded instead of applied (used by prefetch workers).
+     */
+    void          Set_ImportCache(ImportCache* cache, bool cache_only = false) noexcept
+    {
+        imports      = cache;
+        imports_only = cache_only;
+
+        if (cache_only)
+        {
+            instr_engine.DeferSymbols();
+        }
+    }
+
+    /**
+     * @brief Builtin symbol updates recorded by a cache-only parse.
+     */
+    const Semantic::DeferredSymbols& Deferred() const noexcept { return instr_engine.Deferred(); }
+
+    /**
+     * @brief Scripts parsed in place by Handle_Import (transitively), in parse order.
+     *
+     * Imports served by the ImportCache are not listed; see ImportCache::Files().
+     */
+    const std::vector<std::string>& Sources() const noexcept { return sources; }
+
 
 private:
     /// Lexer reference (external ownership).
@@ -181,6 +309,15 @@ private:
     /// Optional post-processing error callback.
     PostProcError    PostProc_Error;
 
+    /// Pre-parsed imports (external ownership, may be nullptr).
+    ImportCache*     imports;
+
+    /// Resolve imports only through the cache.
+    bool             imports_only;
+
+    /// Scripts parsed in place by Handle_Import.
+    std::vector<std::string> sources;
+
     /**
      * @brief Handles Rule::VARIABLE_ASSIGN semantic action.
      *
@@ -3,7 +3,10 @@
 
 
 #include <array>
-#include <regex>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include <optional>
 #include <algorithm>
@@ -108,6 +111,8 @@ enum class Type
     EXCLUDE             ,   //!< Exclusion pattern(s) from glob/expansion
     GLOB                ,   //!< Glob pattern(s)
     IFOS                ,   //!< OS-specific selection (mangled with @@<os>)
+    POOL                ,   //!< Resource pool the task instructions are charged to
+    WEIGHT              ,   //!< Cost of each task instruction against thread and pool budgets
 
     ATTRIBUTE__UNKNOWN  ,   //!< Sentinel for invalid/unrecognized attribute
     ATTRIBUTE__COUNT    ,   //!< Total number of attribute types (must be last valid index + 1)
@@ -188,6 +193,26 @@ using Targets    = std::vector<Target>;
  */
 using Rules      = std::array<Semantic::Rule, _I(Type::ATTRIBUTE__COUNT)>;
 
+/**
+ * @brief Bitset of attribute types carried by an entity (one bit per `Attr::Type`).
+ */
+using Mask       = std::uint32_t;
+
+static_assert(_I(Type::ATTRIBUTE__COUNT) <= 32, "Attr::Mask is too narrow for Attr::Type");
+
+/**
+ * @brief Bit of an attribute type inside an `Attr::Mask`.
+ */
+constexpr Mask bit(const Type t) noexcept
+{
+    return Mask(1) << _I(t);
+}
+
+/**
+ * @brief Shared empty property list, returned for attributes an entity does not carry.
+ */
+inline const Properties NO_PROPERTIES{};
+
 
 
 /**
@@ -273,6 +298,27 @@ using Inputs = std::vector<std::string>;
  */
 using Instrs = std::vector<std::string>;
 
+/**
+ * @brief List element an expanded instruction was instantiated from.
+ *
+ * `list` identifies the root of the `map` chain of the `list` references on the
+ * line, so an instruction over `OBJECTS[i]` mapped from `SOURCES` and one over
+ * `SOURCES[i]` share the same element. Lines without `list` references, lines whose
+ * `list` references have different roots and lines that also reference another
+ * glob-derived variable (plain, `inline` or `rsp`) carry a null `list`.
+ * The pointer is an identity only and is never dereferenced.
+ */
+struct Element
+{
+    const std::vector<std::string>* list  = nullptr; ///< Root list identity, or null.
+    std::size_t                     index = 0;       ///< Position within the root list.
+};
+
+/**
+ * @brief List elements of the expanded instructions (parallel to Instrs).
+ */
+using Elements = std::vector<Element>;
+
 END_NAMESPACE(Task)
 
 
@@ -306,6 +352,8 @@ enum class Type
     PROFILES             = 0,  //!< `using profiles ...`
     INTERPRETER             ,  //!< `using default interpreter ...`
     THREADS                 ,  //!< `using threads ...`
+    IGNORE                  ,  //!< `using ignore [files...]`
+    POOL                    ,  //!< `using pool <name> <size>`
 };
 
 
@@ -384,14 +432,15 @@ using CRef = std::reference_wrapper<const T>;
 /**
  * @brief Variable table: maps variable name to assignment instruction.
  *
- * @note `std::map` ensures stable ordering (useful for deterministic output).
+ * @note `std::map` ensures stable ordering (useful for deterministic output);
+ *       the transparent comparator lets `name@@profile` probes skip concatenation.
  */
-using VTable      = std::map<std::string, InstructionAssign>;
+using VTable      = std::map<std::string, InstructionAssign, Support::TableKeyLess>;
 
 /**
  * @brief Task table: maps task name to task instruction.
  */
-using FTable      = std::map<std::string, InstructionTask>;
+using FTable      = std::map<std::string, InstructionTask, Support::TableKeyLess>;
 
 /**
  * @brief Assertions list.
@@ -508,7 +557,8 @@ struct InstructionAssign
 {
     std::string var_name;                     //!< Variable identifier
     std::vector<std::string> var_value;       //!< Raw value string (may contain `{arc:...}` tokens)
-    Attr::List  attributes;                   //!< Attributes attached to this variable
+    Attr::List  attributes;                   //!< Attributes attached to this variable (write via setAttributes/addAttribute)
+    Attr::Mask  attr_mask = 0;                //!< Bitset mirror of `attributes` types
 
     std::vector<std::string> glob_expansion;  //!< Result of glob expansion (if var_value is a glob)
 
@@ -530,6 +580,10 @@ struct InstructionAssign
     InstructionAssign(const InstructionAssign& other)             = default;
     InstructionAssign& operator=(const InstructionAssign & other) = default;
 
+    // move
+    InstructionAssign(InstructionAssign&& other)                  = default;
+    InstructionAssign& operator=(InstructionAssign&& other)       = default;
+
     inline std::string GetListValue() const
     {
         if (var_value.size() == 1) return var_value[0];
@@ -546,31 +600,54 @@ struct InstructionAssign
         return ss.str();
     }
 
+    /**
+     * @brief Replace the attribute list, rebuilding the bitset.
+     * @param list New attributes.
+     */
+    void setAttributes(Attr::List&& list)
+    {
+        attributes = std::move(list);
+        attr_mask  = 0;
+
+        for (const auto& a : attributes) attr_mask |= Attr::bit(a.type);
+    }
+
+    /**
+     * @brief Append an attribute, updating the bitset.
+     * @param attr Attribute to attach.
+     */
+    void addAttribute(Attr::Attribute&& attr)
+    {
+        attr_mask |= Attr::bit(attr.type);
+        attributes.push_back(std::move(attr));
+    }
+
     /**
      * @brief Check whether an attribute is present.
      * @param attr Attribute type.
      * @return true if attribute list contains `attr`.
      */
-    bool hasAttribute(const Attr::Type attr) const
+    bool hasAttribute(const Attr::Type attr) const noexcept
     {
-        return (std::find(attributes.begin(), attributes.end(), attr) != attributes.end());
+        return (attr_mask & Attr::bit(attr)) != 0;
     }
 
     /**
      * @brief Get properties for a given attribute type.
      * @param attr Attribute type to search for.
-     * @return Properties list (copy). Empty if not present.
-     *
-     * @note This returns by value; if you need performance, consider returning a pointer/view.
+     * @return Properties of the first matching attribute. Empty if not present.
      */
-    const Attr::Properties
-    getProperties(const Attr::Type attr) const
+    const Attr::Properties&
+    getProperties(const Attr::Type attr) const noexcept
     {
-        for (const auto& a : attributes)
-            if (a.type == attr)
-                return a.props;
+        if (hasAttribute(attr))
+        {
+            for (const auto& a : attributes)
+                if (a.type == attr)
+                    return a.props;
+        }
 
-        return {};
+        return Attr::NO_PROPERTIES;
     }
 };
 
@@ -590,13 +667,15 @@ struct InstructionAssign
  */
 struct InstructionTask
 {
-    std::string  task_name;     //!< Task identifier
-    Task::Instrs task_instrs;   //!< Instruction strings (command templates)
-    FListCRef    dependencies;   //!< Resolved dependency tasks (const references)
-    FListCRef    thens;         //!< Resolved successor tasks (const references)
-    Attr::List   attributes;    //!< Attributes attached to task
-    Interpreter  interpreter;   //!< Interpreter override (if any)
-    bool         expanded;
+    std::string    task_name;     //!< Task identifier
+    Task::Instrs   task_instrs;   //!< Instruction strings (command templates)
+    Task::Elements task_elements; //!< List element of each expanded instruction (parallel to task_instrs)
+    FListCRef      dependencies;  //!< Resolved dependency tasks (const references)
+    FListCRef      thens;         //!< Resolved successor tasks (const references)
+    Attr::List     attributes;    //!< Attributes attached to task (write via setAttributes/addAttribute)
+    Attr::Mask     attr_mask = 0; //!< Bitset mirror of `attributes` types
+    Interpreter    interpreter;   //!< Interpreter override (if any)
+    bool           expanded;
     struct Cache
     {
         enum Type { TRACK, UNTRACK, STORE } type = UNTRACK;
@@ -614,46 +693,75 @@ struct InstructionTask
      * @param instrs Task instruction templates.
      */
     InstructionTask(const std::string&  name,
-                    const Task::Instrs& instrs)
+                    Task::Instrs        instrs)
         :
         task_name(name),
-        task_instrs(instrs)
+        task_instrs(std::move(instrs))
     {}
 
     // copy
     InstructionTask(const InstructionTask& other)            = default;
     InstructionTask& operator=(const InstructionTask& other) = default;
 
+    // move
+    InstructionTask(InstructionTask&& other)                 = default;
+    InstructionTask& operator=(InstructionTask&& other)      = default;
+
+    /**
+     * @brief Replace the attribute list, rebuilding the bitset.
+     * @param list New attributes.
+     */
+    void setAttributes(Attr::List&& list)
+    {
+        attributes = std::move(list);
+        attr_mask  = 0;
+
+        for (const auto& a : attributes) attr_mask |= Attr::bit(a.type);
+    }
+
+    /**
+     * @brief Append an attribute, updating the bitset.
+     * @param attr Attribute to attach.
+     */
+    void addAttribute(Attr::Attribute&& attr)
+    {
+        attr_mask |= Attr::bit(attr.type);
+        attributes.push_back(std::move(attr));
+    }
+
     /**
      * @brief Check whether an attribute is present.
      * @param attr Attribute type.
      * @return true if attribute list contains `attr`.
      */
-    bool hasAttribute(const Attr::Type attr) const
+    bool hasAttribute(const Attr::Type attr) const noexcept
     {
-        return (std::find(attributes.begin(), attributes.end(), attr) != attributes.end());
+        return (attr_mask & Attr::bit(attr)) != 0;
     }
 
     /**
      * @brief Get properties for a given attribute type.
      * @param attr Attribute type to search for.
-     * @return Properties list (copy). Empty if not present.
+     * @return Properties of the first matching attribute. Empty if not present.
      */
-    const Attr::Properties
-    getProperties(const Attr::Type attr) const
+    const Attr::Properties&
+    getProperties(const Attr::Type attr) const noexcept
     {
-        for (const auto& a : attributes)
-            if (a.type == attr)
-                return a.props;
+        if (hasAttribute(attr))
+        {
+            for (const auto& a : attributes)
+                if (a.type == attr)
+                    return a.props;
+        }
 
-        return {};
+        return Attr::NO_PROPERTIES;
     }
 
     /**
      * @brief Remove the first occurrence of an attribute type.
      * @param attr Attribute type to remove.
      *
-     * @note This removes only the first match and returns immediately.
+     * @note This removes only the first match; the bit stays set while a duplicate remains.
      */
     void removeAttribute(const Attr::Type attr)
     {
@@ -662,9 +770,14 @@ struct InstructionTask
             if (it->type == attr)
             {
                 attributes.erase(it);
-                return;
+                break;
             }
         }
+
+        if (std::find(attributes.begin(), attributes.end(), attr) == attributes.end())
+        {
+            attr_mask &= ~Attr::bit(attr);
+        }
     }
 };
 
@@ -687,12 +800,12 @@ struct Profile
      * @brief Merge another profile list into this one.
      * @param other Other profile container.
      *
-     * @note This performs an append; it does not de-duplicate.
+     * @note This performs an append; it does not de-duplicate. Values are moved out of @p other.
      */
     void merge(Profile& other)
     {
-        for (const auto& val : other.profiles)
-            this->profiles.push_back(val);
+        for (auto& val : other.profiles)
+            this->profiles.push_back(std::move(val));
     }
 };
 
@@ -718,8 +831,8 @@ struct Profile
 struct Enviroment
 {
     friend class Engine;
-    friend class Manager;
-    friend inline void EnvMerge(Enviroment& dst, Enviroment& src);
+    friend class Cache::Manager;
+    friend inline std::optional<std::string> EnvMerge(Enviroment& dst, Enviroment&& src);
 
 public:
     /**
@@ -743,6 +856,15 @@ public:
      */
     const std::optional<std::string> AlignEnviroment() noexcept;
 
+    /**
+     * @brief Validate `@pool` and `@weight` against the pools declared by `using pool`.
+     *
+     * Reports the first invalid task (with a hint for a misspelled pool).
+     *
+     * @return ARCANA_RESULT__OK or ARCANA_RESULT__NOK.
+     */
+    Arcana_Result                    CheckPools() noexcept;
+
     /**
      * @brief Validate CLI arguments against the collected environment.
      *
@@ -766,9 +888,13 @@ public:
      * - compute glob expansion lists for variables
      * - expand strings inside tasks and asserts
      *
+     * Only the tasks reachable from the run and the variables they reference
+     * are expanded and globbed (see `CollectReachable`).
+     *
+     * @param wanted Item requested with `--value`, expanded as an extra root.
      * @return optional error message. Empty optional on success.
      */
-    const std::optional<std::string> Expand() noexcept;
+    const std::optional<std::string> Expand(const std::string& wanted = "") noexcept;
 
     /**
      * @brief Evaluate collected assertions after expansion.
@@ -789,21 +915,67 @@ public:
      */
     uint32_t                         GetThreads()     noexcept { return max_threads;         }
 
+    /**
+     * @brief Get the resource pools declared by `using pool`.
+     */
+    const std::map<std::string, uint32_t>& GetPools() const noexcept { return pools; }
+
     /**
      * @brief Get profile configuration and selection.
      */
     Profile&                         GetProfile()     noexcept { return profile;             }
 
+    /**
+     * @brief Tasks carrying an attribute, in table (key) order.
+     *
+     * Served by the attribute index, which AlignEnviroment() and the snapshot
+     * loader rebuild once the table is final (and which is otherwise built on first use).
+     *
+     * @param attr Attribute type.
+     * @return Tasks with `attr`, possibly empty.
+     */
+    const std::vector<InstructionTask*>& TasksWith(const Attr::Type attr) noexcept;
+
 private:
+    /**
+     * @brief Attribute -> tasks index over `ftable`.
+     *
+     * Holds pointers into the table nodes; copying an environment yields an
+     * unbuilt index so the copy never points into its source.
+     */
+    struct TaskIndex
+    {
+        std::array<std::vector<InstructionTask*>, _I(Attr::Type::ATTRIBUTE__COUNT)> by_attr;
+        bool built = false;
+
+        TaskIndex() = default;
+
+        // copy
+        TaskIndex(const TaskIndex&) noexcept {}
+        TaskIndex& operator=(const TaskIndex&) noexcept { by_attr = {}; built = false; return *this; }
+
+        // move
+        TaskIndex(TaskIndex&&)            = default;
+        TaskIndex& operator=(TaskIndex&&) = default;
+    };
+
     Profile     profile;             //!< Profiles list and selected profile
     Interpreter default_interpreter; //!< Default interpreter for tasks without override
     uint32_t    max_threads;         //!< Max parallelism configured by `using threads`
+    std::vector<std::string> ignore_files; //!< Ignore files honoured by globs (`using ignore`)
+    std::map<std::string, uint32_t> pools; //!< Resource pool sizes (`using pool`)
+    TaskIndex   task_index;          //!< Attribute index over `ftable`
+
+    /**
+     * @brief Rebuild the attribute index from `ftable` in a single pass.
+     */
+    void IndexTasks() noexcept;
 
     /**
      * @brief Helper that encapsulates expansion logic.
      *
-     * The helper owns pre-compiled regex patterns, and operates on strings
-     * by reference, using the parent env for lookups.
+     * The helper locates `{arc:...}` and `{fs:...}` tokens with a linear scanner,
+     * and operates on strings by reference, using the parent env for lookups.
      */
     struct Expander
     {        
@@ -815,48 +987,51 @@ private:
             NORMAL,
             LIST,
             INLINE,
+            RSP,    //!< Glob expansion written to a response file, replaced by `@path`
         };
 
-        using ExpansionMap = Support::AbstractKeywordMap<Algorithm>;
-
-        Enviroment& env;                  //!< Reference to parent environment
+        /**
+         * @brief `{arc:<mode>:<var>}` mode name -> algorithm (compile-time, case-insensitive).
+         */
+        static constexpr auto Expansion_Map = Support::make_keyword_map<Algorithm>({
+            { "list"   , Algorithm::LIST   },
+            { "inline" , Algorithm::INLINE },
+            { "rsp"    , Algorithm::RSP    },
+        });
 
-        const std::regex re_intern;       //!< Matches internal `{arc:__...__}` symbols
-        const std::regex re_arc;          //!< Matches `{arc:NAME}` variable references
-        const std::regex re_arc_mode;     //!< Matches `{arc:<mode>:<var>}` variable references
-        const std::regex re_fs;           //!< Matches `{fs:...}` filesystem search path directives
+        static_assert(Expansion_Map.valid(), "Expansion_Map: colliding keys");
 
-        const ExpansionMap Expansion_Map;
+        Enviroment& env;                  //!< Reference to parent environment
 
-        struct List
+        /**
+         * @brief Instruction compiled into literal spans and variable slots.
+         *
+         * Literal spans and `NORMAL`/`INLINE` slots are fixed text (views into the
+         * instruction and into the joined-value cache); `LIST` slots select one
+         * element of a glob expansion per instantiation.
+         */
+        struct Template
         {
-            struct Match
+            struct Piece
             {
-                Algorithm   algo;
-                size_t      start;
-                size_t      count;
-                size_t      pattern_len;
-                Arcana::Semantic::InstructionAssign* datasource;
+                std::string_view                text; //!< Fixed text (when list is null)
+                const std::vector<std::string>* list; //!< Per-instance element source, or null
             };
 
-            std::string        source;
-            std::vector<Match> matches;
+            std::vector<Piece> pieces;
+            std::size_t        fixed_len = 0;         //!< Total length of the fixed pieces
         };
 
+        std::unordered_map<const Arcana::Semantic::InstructionAssign*, std::string> joined_values; //!< Cached GetListValue()
+        std::unordered_map<const Arcana::Semantic::InstructionAssign*, std::string> joined_globs;  //!< Cached GetListGlob()
+        std::unordered_map<const Arcana::Semantic::InstructionAssign*, std::string> joined_rsps;   //!< Cached `@path` of response files
+
         /**
          * @brief Construct an expander for the given environment.
          * @param e Environment reference.
          */
         explicit Expander(Enviroment& e) noexcept
             : env(e)
-            , re_intern(R"(\{arc:(__profile__|__version__|__release__|__main__|__root__|__max_threads__|__threads__|__os__|__arch__)\})")
-            , re_arc(R"(\{arc:([A-Za-z_][A-Za-z0-9_]+)\})")
-            , re_arc_mode(R"(\{arc:([a-z]+):([a-zA-Z][a-zA-Z0-9]*)\})")
-            , re_fs(R"(\{fs:([^}]+)\})")
-            , Expansion_Map ({
-                { "list"   , Algorithm::LIST   },
-                { "inline" , Algorithm::INLINE },
-            })
         {}
 
         /**
@@ -873,10 +1048,26 @@ private:
          */
         std::optional<std::string> ExpandArcAll(std::string& s,
                                                 const std::vector<Algorithm>& allowed_algorithms,
-                                                std::vector<std::string>* list_exp) noexcept;
+                                                std::vector<std::string>* list_exp,
+                                                Task::Elements* list_elems = nullptr) noexcept;
 
         std::optional<std::string> ExpandLists();
 
+        /**
+         * @brief Joined values of a variable, computed once and cached.
+         * @param var Variable to join.
+         * @param algo `NORMAL` for var_value, `INLINE` for glob_expansion, `RSP` for
+         *             the `@path` of a response file holding glob_expansion.
+         * @return Reference to the cached joined string.
+         */
+        const std::string& Joined(const Arcana::Semantic::InstructionAssign& var, Algorithm algo) noexcept;
+
+        /**
+         * @brief Drop cached joined values.
+         * @param var Variable whose values changed, or null to drop everything.
+         */
+        void Invalidate(const Arcana::Semantic::InstructionAssign* var = nullptr) noexcept;
+
         /**
          * @brief Expand one string:
          * - internal expansion
@@ -887,7 +1078,22 @@ private:
          */
         std::optional<std::string> ExpandText(std::string& s,
                                               const std::vector<Algorithm>& allowed_algorithms,
-                                              std::vector<std::string>* list_exp = nullptr) noexcept;
+                                              std::vector<std::string>* list_exp = nullptr,
+                                              Task::Elements* list_elems = nullptr) noexcept;
+
+        /**
+         * @brief Expand every value of a variable whose references are already expanded.
+         * @param var Variable to expand in-place.
+         * @return optional error message.
+         */
+        std::optional<std::string> ExpandVariable(Arcana::Semantic::InstructionAssign& var) noexcept;
+
+        /**
+         * @brief Expand a task: `@cache` inputs, interpreter override and instruction lines.
+         * @param task Task to expand in-place.
+         * @return optional error message.
+         */
+        std::optional<std::string> ExpandTask(Arcana::Semantic::InstructionTask& task) noexcept;
 
         /**
          * @brief Extract all `{fs:...}` occurrences from an expanded string.
@@ -898,6 +1104,13 @@ private:
          */
         void ExtractFsPaths(const std::string& s, std::vector<std::filesystem::path>& out) noexcept;
 
+        /**
+         * @brief Extract the variable names referenced by `{arc:NAME}` and `{arc:<mode>:NAME}`.
+         * @param s String to scan (not modified).
+         * @param out Output list of referenced names (appended).
+         */
+        void ExtractVarRefs(const std::string& s, std::vector<std::string>& out) noexcept;
+
         /**
          * @brief Expand one side of an assert and update `AssertCheck` accordingly.
          *
@@ -912,6 +1125,36 @@ private:
          */
         std::optional<std::string> ExpandAssertSide(std::string& stmt, AssertCheck& assert) noexcept;
     };
+
+    /**
+     * @brief Collect the tasks and variables a run can actually touch.
+     *
+     * Roots are the main task, `@always` tasks, assert callbacks and the item
+     * requested with `--value`; tasks follow `@requires`/`@then` links, and
+     * variables follow value references, `@exclude` and `map` sources.
+     *
+     * @param ex     Expander used to scan references.
+     * @param wanted Extra task or variable root (may be empty).
+     * @param tasks  Output set of reachable tasks.
+     * @param vars   Output set of referenced variable keys.
+     */
+    void CollectReachable(Expander& ex, const std::string& wanted,
+                          std::unordered_set<const InstructionTask*>& tasks,
+                          std::unordered_set<std::string>& vars) noexcept;
+
+    /**
+     * @brief Order variables into levels of the `{arc:NAME}` dependency graph.
+     *
+     * Every variable of a level only references variables of earlier levels,
+     * so the variables of one level can be expanded concurrently.
+     *
+     * @param ex     Expander used to scan references.
+     * @param vars   Variable keys to order.
+     * @param levels Output levels, in expansion order.
+     * @return optional error message (circular references).
+     */
+    std::optional<std::string> LevelVariables(Expander& ex, const std::unordered_set<std::string>& vars,
+                                              std::vector<std::vector<InstructionAssign*>>& levels) noexcept;
 };
 
 
@@ -924,12 +1167,27 @@ private:
  * - profile list merged (append)
  * - default interpreter overwritten by src interpreter
  * - max_threads overwritten only if src.max_threads != 0
+ * - ignore files merged (append unique)
+ * - pools merged; a pool declared on both sides with different sizes is an error
  * - asserts appended
  *
  * @warning This merge is destructive for `src` (moves out values).
+ *
+ * @return optional error message. Empty optional on success (nothing is merged on error).
  */
-inline void EnvMerge(Enviroment& dst, Enviroment& src)
+inline std::optional<std::string> EnvMerge(Enviroment& dst, Enviroment&& src)
 {
+    // SAME RULE AS `using pool`: A POOL IS DECLARED ONCE (THE SAME SCRIPT MAY BE IMPORTED TWICE)
+    for (const auto& [k, v] : src.pools)
+    {
+        if (auto it = dst.pools.find(k); it != dst.pools.end() && it->second != v)
+        {
+            std::stringstream ss;
+            ss << "Duplicate item in statement " << TOKEN_MAGENTA("using pool") << ": " << TOKEN_MAGENTA(k) << ANSI_RESET;
+            return ss.str();
+        }
+    }
+
     for (auto& [k, v] : src.vtable)
         dst.vtable[k] = std::move(v);
 
@@ -945,12 +1203,37 @@ inline void EnvMerge(Enviroment& dst, Enviroment& src)
         dst.max_threads = src.max_threads;
     }
 
+    for (auto& f : src.ignore_files)
+    {
+        if (std::find(dst.ignore_files.begin(), dst.ignore_files.end(), f) == dst.ignore_files.end())
+            dst.ignore_files.push_back(f);
+    }
+
+    dst.pools.insert(src.pools.begin(), src.pools.end());
+
     for (auto& a : src.atable)
-        dst.atable.push_back(a);
+        dst.atable.push_back(std::move(a));
+
+    return std::nullopt;
 }
 
 
 
+/**
+ * @brief Builtin symbol updates recorded by an engine whose symbols are deferred.
+ *
+ * Scripts parsed ahead of the main parse (see Parsing::ImportCache) must not
+ * touch the global builtin symbols: their updates are recorded here and applied
+ * when the script is merged, at the position of its import statement.
+ */
+struct DeferredSymbols
+{
+    std::string main;    //!< Task tagged with @main (empty if none)
+    std::string threads; //!< Last `using threads` value (empty if none)
+};
+
+
+
 /**
  * @brief Semantic engine collecting instructions from parser events.
  *
@@ -960,8 +1243,8 @@ inline void EnvMerge(Enviroment& dst, Enviroment& src)
  * - builds up VTable/FTable/ATable
  * - enforces invariants (e.g. single MAIN task)
  *
- * @note The engine owns its environment; caller can obtain a copy via GetEnvironment()
- *       or a mutable reference via EnvRef().
+ * @note The engine owns its environment; caller can obtain a copy via GetEnvironment(),
+ *       take it over with std::move(engine).GetEnvironment() or a mutable reference via EnvRef().
  */
 class Engine
 {
@@ -993,7 +1276,7 @@ public:
      * @param instrs Instruction lines.
      * @return SemanticOutput containing status and error/hint if any.
      */
-    SemanticOutput Collect_Task      (const std::string& name, const Task::Instrs& instrs);
+    SemanticOutput Collect_Task      (const std::string& name, Task::Instrs&& instrs);
 
     /**
      * @brief Collect a `using` directive.
@@ -1030,7 +1313,15 @@ public:
      *
      * @note Copying may be expensive if tables are large.
      */
-    Enviroment                       GetEnvironment()  const noexcept { return _env; }
+    Enviroment                       GetEnvironment()  const& noexcept { return _env; }
+
+    /**
+     * @brief Hand the collected environment over to the caller.
+     * @return Environment moved out of the engine.
+     *
+     * @note The engine is left with an empty environment.
+     */
+    Enviroment                       GetEnvironment()  && noexcept     { return std::move(_env); }
 
     /**
      * @brief Get a mutable reference to the collected environment.
@@ -1040,11 +1331,47 @@ public:
      */
     Enviroment&                      EnvRef()                         { return _env; }
 
+    /**
+     * @brief Record MAIN/THREADS updates instead of applying them to the global symbols.
+     *
+     * Checks against the main task then only see the tasks of this engine.
+     */
+    void                             DeferSymbols()                   noexcept { _defer_symbols = true; }
+
+    /**
+     * @brief Symbol updates recorded since DeferSymbols().
+     */
+    const DeferredSymbols&           Deferred()                 const noexcept { return _deferred; }
+
+    /**
+     * @brief Apply the symbol updates recorded by another engine.
+     *
+     * Nothing is applied if the recorded main task would clash with the one
+     * already set: the caller must then collect the script again in place,
+     * which reports the diagnostic at its original position.
+     *
+     * @param symbols Recorded updates.
+     * @return false on a main task clash.
+     */
+    bool                             ApplySymbols(const DeferredSymbols& symbols) noexcept;
+
 private:
-    Attr::Rules  _attr_rules;   //!< Attribute rule table (indexed by Attr::Type)
-    Attr::List   _attr_pending; //!< Attributes pending attachment to next entity (variable/task)
+    /** @brief True if a main task was already tagged (globally or in the deferred record). */
+    bool                             IsMainSet() const noexcept;
+
+    /** @brief Set the main task symbol (globally or in the deferred record). */
+    void                             SetMain(const std::string& name) noexcept;
+
+    /** @brief Set the threads symbol (globally or in the deferred record). */
+    void                             SetThreads(const std::string& threads) noexcept;
+
+    Attr::Rules     _attr_rules;          //!< Attribute rule table (indexed by Attr::Type)
+    Attr::List      _attr_pending;        //!< Attributes pending attachment to next entity (variable/task)
     
-    Enviroment   _env;          //!< Owned environment
+    Enviroment      _env;                 //!< Owned environment
+
+    bool            _defer_symbols = false; //!< Record symbol updates instead of applying them
+    DeferredSymbols _deferred;            //!< Recorded symbol updates
 };
 
 
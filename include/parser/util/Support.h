@@ -5,6 +5,7 @@
 #include <map>
 #include <set>
 #include <cctype>
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <limits>
@@ -39,7 +40,7 @@
  * - mangling helpers for profile/OS specialized keys
  * - string representations for grammar/scanner entities
  * - fuzzy matching helpers (closest string)
- * - transparent hashing/equality for std::string_view keyed maps
+ * - compile-time perfect-hash keyword tables
  */
 
 /**
@@ -249,7 +250,7 @@ using UniqueNonTerminal = std::set<Terminal>;
 END_MODULE(Grammar)
 
 using Point             = const Arcana::Grammar::Index*;
-using Input             = std::string&;
+using Input             = std::string_view;
 using Lexeme            = std::string;
 using Statement         = std::vector<std::string>;
 
@@ -290,35 +291,46 @@ BEGIN_MODULE(Support)
 //                                                                                                               
 
 /**
- * @brief Transparent hash for std::string_view.
+ * @brief Mangled table key `base@@tag`, kept as its two halves.
  *
- * Enables heterogeneous lookup in unordered containers keyed by std::string_view
- * (e.g. find with std::string, const char*, std::string_view).
+ * Lets profile/OS lookups probe a table without building the mangled string.
  */
-struct StringViewHash
+struct MangledKey
 {
-    using is_transparent = void;
-
-    /**
-     * @brief Hashes a string_view.
-     */
-    std::size_t operator()(std::string_view s) const noexcept;
+    std::string_view base;   //!< Unmangled identifier
+    std::string_view tag;    //!< Profile or OS name
 };
 
 
 /**
- * @brief Transparent equality for std::string_view.
+ * @brief Transparent ordering for semantic table keys.
  *
- * Enables heterogeneous comparison in unordered containers keyed by std::string_view.
+ * Orders exactly like `std::less<std::string>`, and additionally accepts
+ * std::string_view and MangledKey probes (the latter compared piecewise).
  */
-struct StringViewEq
+struct TableKeyLess
 {
     using is_transparent = void;
 
+    bool operator() (std::string_view a, std::string_view b) const noexcept
+    {
+        return a < b;
+    }
+
+    bool operator() (std::string_view a, const MangledKey& b) const noexcept
+    {
+        return compare(a, b) < 0;
+    }
+
+    bool operator() (const MangledKey& a, std::string_view b) const noexcept
+    {
+        return compare(b, a) > 0;
+    }
+
     /**
-     * @brief Compares two string_view values for equality.
+     * @brief Three-way compares a key with the concatenation `base@@tag`.
      */
-    bool operator() (std::string_view a, std::string_view b) const noexcept;
+    static int compare(std::string_view key, const MangledKey& mangled) noexcept;
 };
 
 
@@ -450,6 +462,13 @@ std::string rtrim(const std::string& s);
 
 
 
+/// @brief check whether a string only holds whitespace characters
+/// @param s the input string
+/// @return true if @ref s is empty or whitespace only
+bool is_blank(std::string_view s) noexcept;
+
+
+
 /**
  * @brief Converts an ASCII character to lower-case.
  *
@@ -558,17 +577,141 @@ std::optional<std::string> FindClosest(const std::vector<std::string> & list,
 
 
 /**
- * @brief Unordered map keyed by std::string_view with transparent hashing/equality.
- *
- * Allows heterogeneous lookup (std::string, std::string_view, const char*).
+ * @brief Key/value pair used to spell a StaticKeywordMap.
  */
 template < typename T >
-using AbstractKeywordMap = std::unordered_map<
-    std::string_view,
-    T,
-    StringViewHash,
-    StringViewEq
->;
+struct KeywordEntry
+{
+    std::string_view key;
+    T                value;
+};
+
+
+
+/**
+ * @brief Compile-time perfect-hash table keyed by string literals.
+ *
+ * The constructor runs in a constant expression and searches a seed that
+ * sends every key to its own slot, so a table costs nothing at startup and
+ * a lookup is one hash, one slot load and one compare.
+ *
+ * @tparam T    Mapped literal type.
+ * @tparam N    Number of keys.
+ * @tparam FOLD Hash and compare keys ASCII case-insensitively.
+ *
+ * @note Build it with make_keyword_map() and check valid() in a static_assert
+ *       (it is false when keys collide, e.g. duplicates). For a constexpr table
+ *       duplicates usually stop the build earlier: the exhaustive seed search
+ *       exceeds the compiler's constant evaluation limit.
+ */
+template < typename T, std::size_t N, bool FOLD >
+class StaticKeywordMap
+{
+public:
+    constexpr explicit StaticKeywordMap(const KeywordEntry<T> (&entries)[N]) noexcept
+        : _slots{}
+        , _seed(0)
+        , _valid(false)
+    {
+        for (; _seed < MAX_SEED && !_valid; ++_seed)
+        {
+            _valid = place(entries);
+        }
+
+        --_seed;
+    }
+
+    /**
+     * @brief Looks up a key.
+     * @return Pointer to the mapped value, or nullptr when absent.
+     */
+    constexpr const T* find(std::string_view key) const noexcept
+    {
+        const Slot& slot = _slots[hash(key, _seed) & (SLOTS - 1)];
+
+        return (slot.used && equal(slot.key, key)) ? &slot.value : nullptr;
+    }
+
+    /**
+     * @brief Whether the seed search placed every key.
+     */
+    constexpr bool valid() const noexcept { return _valid; }
+
+private:
+    struct Slot
+    {
+        std::string_view key   {};
+        T                value {};
+        bool             used  = false;
+    };
+
+    // 4x OVERSIZED POWER OF TWO: A FEW SEEDS ARE ENOUGH FOR SMALL KEYWORD SETS
+    static constexpr std::size_t SLOTS    = [] { std::size_t n = 1; while (n < 4 * N) n <<= 1; return n; }();
+    static constexpr std::uint32_t MAX_SEED = 1u << 16;
+
+    static constexpr char fold(char c) noexcept
+    {
+        return (FOLD && c >= 'A' && c <= 'Z') ? char(c + ('a' - 'A')) : c;
+    }
+
+    static constexpr std::uint32_t hash(std::string_view key, std::uint32_t seed) noexcept
+    {
+        std::uint32_t h = 2166136261u ^ (seed * 0x9E3779B9u);
+
+        for (char c : key)
+        {
+            h = (h ^ static_cast<unsigned char>(fold(c))) * 16777619u;
+        }
+
+        return h ^ (h >> 15);
+    }
+
+    static constexpr bool equal(std::string_view a, std::string_view b) noexcept
+    {
+        if (a.size() != b.size()) return false;
+
+        for (std::size_t i = 0; i < a.size(); ++i)
+        {
+            if (fold(a[i]) != fold(b[i])) return false;
+        }
+
+        return true;
+    }
+
+    constexpr bool place(const KeywordEntry<T> (&entries)[N]) noexcept
+    {
+        for (auto& slot : _slots) slot = Slot{};
+
+        for (const auto& e : entries)
+        {
+            Slot& slot = _slots[hash(e.key, _seed) & (SLOTS - 1)];
+
+            if (slot.used) return false;
+
+            slot = Slot{ e.key, e.value, true };
+        }
+
+        return true;
+    }
+
+    Slot          _slots[SLOTS];
+    std::uint32_t _seed;
+    bool          _valid;
+};
+
+
+
+/**
+ * @brief Builds a StaticKeywordMap, deducing its size from the entry list.
+ *
+ * @tparam T    Mapped literal type.
+ * @tparam FOLD Case-insensitive keys (the default, as for script keywords).
+ */
+template < typename T, bool FOLD = true, std::size_t N >
+constexpr StaticKeywordMap<T, N, FOLD> make_keyword_map(const KeywordEntry<T> (&entries)[N]) noexcept
+{
+    return StaticKeywordMap<T, N, FOLD>(entries);
+}
 
 
 
@@ -225,7 +225,7 @@ GetValues(TABLE& table, const Arcana::Semantic::Attr::Type attr)
  * @brief Looks up a key in a table, with optional profile-based mangling fallback.
  *
  * If `key` is not present, attempts lookup using a mangled key for each profile
- * in the provided list (via Support::generate_mangling()).
+ * in the provided list (probed as Support::MangledKey, without concatenating).
  *
  * @tparam TABLE Map-like container type.
  * @param table Table to query.
@@ -243,9 +243,7 @@ GetValue(TABLE& table, const typename TABLE::key_type& key, const std::vector<st
     {
         for (const auto& profile : profiles)
         {
-            const auto mangled = Support::generate_mangling(key, profile);
-
-            it = table.find(mangled);
+            it = table.find(Support::MangledKey{ key, profile });
 
             if (it != table.end())
             {
@@ -285,9 +283,7 @@ GetValue(TABLE& table, const typename TABLE::key_type& key, const std::vector<st
 
     for (const auto& profile : profiles)
     {
-        const auto mangled = Support::generate_mangling(key, profile);
-
-        it = table.find(mangled);
+        it = table.find(Support::MangledKey{ key, profile });
         if (it != table.end() && HasAttrOnMapped(it->second, attr))
         {
             return std::ref(it->second);
@@ -316,9 +312,7 @@ GetValue(TABLE& table, const typename TABLE::key_type& key, const std::string& p
 
     if (it == table.end())
     {
-        const auto mangled = Support::generate_mangling(key, profile);
-
-        it = table.find(mangled);
+        it = table.find(Support::MangledKey{ key, profile });
 
         if (it != table.end())
         {
@@ -356,9 +350,7 @@ GetValue(TABLE& table, const typename TABLE::key_type& key, const std::string& p
         return std::ref(it->second);
     }
 
-    const auto mangled = Support::generate_mangling(key, profile);
-
-    it = table.find(mangled);
+    it = table.find(Support::MangledKey{ key, profile });
     if (it != table.end() && HasAttrOnMapped(it->second, attr))
     {
         return std::ref(it->second);
@@ -471,9 +463,7 @@ TakeValue(TABLE& table, const typename TABLE::key_type& key, const std::string&
         return value;
     }
 
-    const auto mangled = Support::generate_mangling(key, profile);
-
-    it = table.find(mangled);
+    it = table.find(Support::MangledKey{ key, profile });
 
     if (it != table.end())
     {
@@ -511,9 +501,7 @@ TakeValue(TABLE& table, const typename TABLE::key_type& key, const std::vector<s
 
     for (const auto& profile : profiles)
     {
-        const auto mangled = Support::generate_mangling(key, profile);
-
-        it = table.find(mangled);
+        it = table.find(Support::MangledKey{ key, profile });
 
         if (it != table.end())
         {
@@ -551,9 +539,7 @@ TakeValue(TABLE& table, const typename TABLE::key_type& key, const std::string&
         return value;
     }
 
-    const auto mangled = Support::generate_mangling(key, profile);
-
-    it = table.find(mangled);
+    it = table.find(Support::MangledKey{ key, profile });
 
     if (it != table.end() && HasAttrOnMapped(it->second, attr))
     {
@@ -592,9 +578,7 @@ TakeValue(TABLE& table, const typename TABLE::key_type& key, const std::vector<s
 
     for (const auto& profile : profiles)
     {
-        const auto mangled = Support::generate_mangling(key, profile);
-
-        it = table.find(mangled);
+        it = table.find(Support::MangledKey{ key, profile });
 
         if (it != table.end() && HasAttrOnMapped(it->second, attr))
         {
@@ -753,8 +737,8 @@ AlignOnProfile(TABLE& table, const std::string& profile)
         const auto pos = key.find("@@");
         if (pos == std::string::npos) continue;
 
-        const std::string base     = key.substr(0, pos);
-        const std::string prof_key = key.substr(pos + 2);
+        const std::string      base     = key.substr(0, pos);
+        const std::string_view prof_key = std::string_view(key).substr(pos + 2);
 
         if (prof_key != profile)
         {
@@ -823,8 +807,8 @@ AlignOnOS(TABLE& table)
         const auto pos = key.find("@@");
         if (pos == std::string::npos) continue;
 
-        const std::string base   = key.substr(0, pos);
-        const std::string os_key = key.substr(pos + 2);
+        const std::string      base   = key.substr(0, pos);
+        const std::string_view os_key = std::string_view(key).substr(pos + 2);
 
         if (os_key != Core::symbol(Core::SymbolType::OS))
         {
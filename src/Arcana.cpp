@@ -7,10 +7,10 @@
 #include "Defines.h"
 #include "Semantic.h"
 #include "Profiler.h"
-#include "TableHelper.h"
 
 #include <cerrno>
 #include <cstring>
+#include <thread>
 #include <iostream>
 #include <unistd.h>
 #include <filesystem>
@@ -44,20 +44,26 @@ static Semantic::Enviroment env;
 
 
 /**
- * @brief Parse and process the Arcana source file.
+ * @brief Build the aligned environment from the Arcana source file.
  *
- * This function performs lexical analysis, parsing, semantic validation,
- * environment alignment, variable expansion, and assertion execution.
+ * This function performs lexical analysis, parsing, semantic validation and
+ * environment alignment, then snapshots the result for later runs.
  *
  * @param args Parsed command-line arguments.
+ * @param selector Snapshot selector of this run.
  * @return Arcana_Result::ARCANA_RESULT__OK on success, NOK on failure.
  */
-static Arcana_Result Parse(const Support::Arguments& args)
+static Arcana_Result Build(const Support::Arguments& args, const std::string& selector)
 {
     // INITIALIZE LEXER, GRAMMAR ENGINE, AND PARSER.
     Scan::Lexer          lexer(args.arcfile);
     Grammar::Engine      engine;
     Parsing::Parser      parser(lexer, engine);
+    Parsing::ImportCache imports;
+
+    // PARSE IMPORTED SCRIPTS AHEAD, CONCURRENTLY AND ONCE PER DISTINCT FILE.
+    imports.Prefetch(args.arcfile, std::thread::hardware_concurrency());
+    parser.Set_ImportCache(&imports);
 
     // REGISTER PARSING, SEMANTIC, AND POST-PROCESS ERROR HANDLERS.
     parser.Set_ParsingError_Handler    (Support::ParserError   {lexer} );
@@ -73,11 +79,55 @@ static Arcana_Result Parse(const Support::Arguments& args)
     // ALIGN ENVIRONMENT TABLES AND DEFAULTS.
     CHECK_STR_RESULT(env.AlignEnviroment());
 
-    // EXPAND VARIABLES, GLOBS, AND ATTRIBUTE-DRIVEN TRANSFORMS.
-    CHECK_STR_RESULT(env.Expand());
+    // VALIDATE TASK POOLS AND WEIGHTS.
+    CHECK_RESULT(env.CheckPools());
+
+    // SNAPSHOT THE ALIGNED ENVIRONMENT, KEYED BY EVERY SCRIPT IT WAS BUILT FROM.
+    std::vector<std::string> sources = imports.Files();
+
+    sources.push_back(args.arcfile);
+    sources.insert(sources.end(), parser.Sources().begin(), parser.Sources().end());
+
+    Cache::Manager::Instance().StoreEnvironment(selector, sources, env);
+
+    return Arcana_Result::ARCANA_RESULT__OK;
+}
+
+
+
+/**
+ * @brief Parse and process the Arcana source file.
+ *
+ * The aligned environment is restored from its snapshot when the arcfile,
+ * its imports and the CLI overrides are unchanged, otherwise it is built.
+ * Variable expansion always runs.
+ *
+ * @param args Parsed command-line arguments.
+ * @return Arcana_Result::ARCANA_RESULT__OK on success, NOK on failure.
+ */
+static Arcana_Result Parse(const Support::Arguments& args)
+{
+    std::stringstream selector;
+
+    // EVERYTHING BESIDES SCRIPT CONTENT THAT SHAPES THE ALIGNED ENVIRONMENT.
+    selector << Core::symbol(Core::SymbolType::VERSION) << '|'
+             << Core::symbol(Core::SymbolType::OS)      << '|'
+             << Core::symbol(Core::SymbolType::ARCH)    << '|'
+             << args.arcfile                            << '|'
+             << (args.profile ? "p:" + args.profile.value : std::string{}) << '|'
+             << (args.task    ? "t:" + args.task.value    : std::string{}) << '|'
+             << (args.threads ? "j:" + args.threads.svalue : std::string{});
+
+    if (!Cache::Manager::Instance().LoadEnvironment(selector.str(), env))
+    {
+        CHECK_RESULT(Build(args, selector.str()));
+    }
+
+    // EXPAND VARIABLES, GLOBS, AND ATTRIBUTE-DRIVEN TRANSFORMS REACHABLE FROM THIS RUN.
+    CHECK_STR_RESULT(env.Expand(args.value ? args.value.value : std::string{}));
 
     // CHECK FOR PUBLIC TASKS PRESENCE.
-    if (!Table::GetValues(env.ftable, Semantic::Attr::Type::PUBLIC))
+    if (env.TasksWith(Semantic::Attr::Type::PUBLIC).empty())
     {
         std::stringstream ss;
         ss << "Arcfile " << TOKEN_MAGENTA(args.arcfile) << " has no public tasks"; 
@@ -115,8 +165,8 @@ static Arcana_Result Execute(const Support::Arguments& args)
         }
     } 
 
-    // BUILD JOBLIST FROM CURRENT ENVIRONMENT.
-    CHECK_RESULT(Jobs::List::FromEnv(env, joblist, recovery));
+    // BUILD JOBLIST FROM CURRENT ENVIRONMENT (--value STILL PRINTS TASK INSTRUCTIONS FROM IT).
+    CHECK_RESULT(Jobs::List::FromEnv(env, joblist, recovery, !args.value));
 
     // HANDLE POST PARSE EARLY-EXIT OPTIONS.
     CHECK_RESULT(Support::HandleArgsPostParse(args, env, joblist));
@@ -124,6 +174,7 @@ static Arcana_Result Execute(const Support::Arguments& args)
     // CONFIGURE RUNTIME EXECUTION OPTIONS.
     runopt.silent          = args.silent;
     runopt.max_parallelism = env.GetThreads();
+    runopt.pools           = env.GetPools();
 
     // EXECUTE JOBS
     Arcana_Result result;
@@ -132,11 +183,34 @@ static Arcana_Result Execute(const Support::Arguments& args)
         Cache::Manager::Instance().Freeze();
     }
 
+    // DROP RESPONSE FILES LEFT BY PREVIOUS RUNS.
+    Cache::Manager::Instance().PruneResponseFiles();
+
     return result;
 }
                                                                                                    
                                                                                                                                                                                       
                                                                     
+/**
+ * @brief Parse the arcfile, then build the job list and execute it.
+ *
+ * @param args Parsed command-line arguments.
+ * @return Arcana_Result::ARCANA_RESULT__OK on success, NOK on failure.
+ */
+static Arcana_Result Run(const Support::Arguments& args)
+{
+    // PARSE ARCFILE AND PREPARE THE SEMANTIC ENVIRONMENT.
+    CHECK_RESULT(Parse(args));
+
+    // LOAD CACHE.
+    Cache::Manager::Instance().LoadCache(env.GetProfile().selected);
+
+    // GENERATE JOBLIST AND EXECUTE.
+    return Execute(args);
+}
+
+
+
 /**
  * @brief Arcana program entry point.
  *
@@ -156,12 +230,11 @@ int main(int argc, char** argv)
 
     ARC(ANSI_GRAY << "Building Environment" << ANSI_RESET);
 
-    // PARSE ARCFILE AND PREPARE THE SEMANTIC ENVIRONMENT.
-    CHECK_RESULT(Parse(args));
+    // PARSE, PLAN AND EXECUTE.
+    const auto result = Run(args);
 
-    // LOAD CACHE.
-    Cache::Manager::Instance().LoadCache(env.GetProfile().selected);
+    // NO PREFETCH WORKER MAY OUTLIVE main (EARLY EXITS CAN LEAVE QUEUED FILES).
+    Cache::Manager::Instance().StopHashers();
 
-    // GENERATE JOBLIST AND EXECUTE.
-    return Execute(args);
+    return result;
 }
\ No newline at end of file
@@ -1,7 +1,17 @@
 #include "Glob.h"
 #include "Profiler.h"
 
+#include <map>
+#include <deque>
+#include <chrono>
+#include <fstream>
+#include <iterator>
 #include <algorithm>
+#include <memory_resource>
+
+#if !defined(_WIN32)
+#include <sys/stat.h>
+#endif
 
 USE_MODULE(Arcana::Glob);
 
@@ -131,6 +141,117 @@ static bool EmitLiteralIfAny(std::string& lit, Segment& out) noexcept
 
 
 
+/**
+ * @brief Compile a parsed character class into its 256-bit membership bitmap.
+ *
+ * Singles and ranges are folded into the bitmap and the negation is applied
+ * once, so matching a character is a single bit test.
+ *
+ * @param cc Character class to compile in place.
+ */
+static void CompileCharClass(CharClass& cc) noexcept
+{
+    cc.bitmap.fill(0);
+
+    auto set = [&cc] (unsigned char x) noexcept
+    {
+        cc.bitmap[x >> 6] |= (std::uint64_t{1} << (x & 63));
+    };
+
+    for (char c : cc.singles)
+    {
+        set(static_cast<unsigned char>(c));
+    }
+
+    for (const auto& r : cc.ranges)
+    {
+        const unsigned a = static_cast<unsigned char>(r.first);
+        const unsigned b = static_cast<unsigned char>(r.last);
+
+        for (unsigned x = a; x <= b; ++x)
+        {
+            set(static_cast<unsigned char>(x));
+        }
+    }
+
+    // APPLY NEGATION TO THE WHOLE SET
+    if (cc.negated)
+    {
+        for (auto& w : cc.bitmap)
+        {
+            w = ~w;
+        }
+    }
+}
+
+
+
+/**
+ * @brief Compile a parsed segment into its star-separated chunk program.
+ *
+ * Every run of non-'*' atoms becomes a @ref Segment::Chunk with a fixed width
+ * and, when the run holds a literal, the longest literal as search key. The
+ * first run is anchored at the start of the name, the last one at the end,
+ * and the runs in between are located with a leftmost search.
+ *
+ * Segments holding '**' are left uncompiled.
+ *
+ * @param seg Segment to compile in place.
+ */
+static void CompileSegment(Segment& seg) noexcept
+{
+    seg.chunks.clear();
+    seg.min_len  = 0;
+    seg.compiled = false;
+
+    Segment::Chunk cur{};
+
+    for (std::size_t i = 0; i <= seg.atoms.size(); ++i)
+    {
+        // CLOSE THE CURRENT RUN AT EACH STAR AND AT THE END
+        if (i == seg.atoms.size() || seg.atoms[i].kind == Atom::Kind::STAR)
+        {
+            cur.last     = i;
+            seg.min_len += cur.width;
+            seg.chunks.push_back(cur);
+
+            cur            = Segment::Chunk{};
+            cur.first      = i + 1;
+            continue;
+        }
+
+        const Atom& a = seg.atoms[i];
+
+        switch (a.kind)
+        {
+            case Atom::Kind::LITERAL:
+                // KEEP THE LONGEST LITERAL AS SEARCH KEY
+                if (cur.key == static_cast<std::size_t>(-1) || a.literal.size() > seg.atoms[cur.key].literal.size())
+                {
+                    cur.key        = i;
+                    cur.key_offset = cur.width;
+                }
+                cur.width += a.literal.size();
+                break;
+
+            case Atom::Kind::QMARK:
+            case Atom::Kind::CHARCLASS:
+                cur.width += 1;
+                break;
+
+            default:
+                // DOUBLESTAR: NOT A SEGMENT-LOCAL ATOM
+                seg.chunks.clear();
+                seg.min_len = 0;
+                return;
+        }
+    }
+
+    seg.compiled = true;
+}
+
+
+
 /**
  * @brief Parse a character class starting at '[' within a segment.
  *
@@ -225,6 +346,7 @@ static bool ParseCharClass(std::string_view seg, std::size_t& i, CharClass& out,
             }
 
             // LEAVE i ON THE ']'
+            CompileCharClass(out);
             return true;
         }
 
@@ -302,6 +424,7 @@ static bool ParseSegment(std::string_view seg, Segment& out, std::size_t base_of
     // EMPTY SEGMENTS ARE ACCEPTED (THE CALLER CONTROLS SPLITTING RULES)
     if (seg.empty())
     {
+        CompileSegment(out);
         return true;
     }
 
@@ -415,6 +538,7 @@ static bool ParseSegment(std::string_view seg, Segment& out, std::size_t base_of
         }
     }
 
+    CompileSegment(out);
     return true;
 }
 
@@ -569,10 +693,8 @@ static bool SegmentIsLiteralOnly(const Segment& seg, std::string_view& out_lit)
 /**
  * @brief Match a single character against a parsed character class.
  *
- * The class can be:
- * - A list of single characters
- * - A list of inclusive ranges
- * - Optionally negated
+ * Singles, ranges and negation are folded into the class bitmap at parse
+ * time (see CompileCharClass), so this is a single bit test.
  *
  * @param cc Parsed character class.
  * @param ch Candidate character.
@@ -580,42 +702,111 @@ static bool SegmentIsLiteralOnly(const Segment& seg, std::string_view& out_lit)
  */
 static bool CharClassMatch(const CharClass& cc, char ch) noexcept
 {
-    bool hit = false;
+    return cc.Test(ch);
+}
 
-    // CHECK SINGLES FIRST
-    for (char c : cc.singles)
+
+
+/**
+ * @brief Check a compiled chunk anchored at a given position of the name.
+ *
+ * @param seg   Compiled segment owning the chunk.
+ * @param chunk Chunk to check.
+ * @param name  Candidate name.
+ * @param pos   Start position (the caller guarantees pos + width <= size).
+ * @return true if every atom of the chunk matches at @p pos.
+ */
+static bool MatchChunkAt(const Segment& seg, const Segment::Chunk& chunk, std::string_view name, std::size_t pos) noexcept
+{
+    for (std::size_t i = chunk.first; i < chunk.last; ++i)
     {
-        if (c == ch)
+        const Atom& a = seg.atoms[i];
+
+        switch (a.kind)
         {
-            hit = true;
-            break;
+            case Atom::Kind::LITERAL:
+                if (name.compare(pos, a.literal.size(), a.literal) != 0)
+                {
+                    return false;
+                }
+                pos += a.literal.size();
+                break;
+
+            case Atom::Kind::CHARCLASS:
+                if (!a.cls.Test(name[pos]))
+                {
+                    return false;
+                }
+                pos += 1;
+                break;
+
+            default:
+                // QMARK: ANY SINGLE CHARACTER
+                pos += 1;
+                break;
         }
     }
 
-    // CHECK RANGES IF NOT MATCHED
-    if (!hit)
+    return true;
+}
+
+
+
+/**
+ * @brief Find the leftmost position where a chunk matches inside a window.
+ *
+ * When the chunk holds a literal, candidates are located by searching its
+ * longest literal (memchr/memcmp via string_view::find) and only those are
+ * verified; otherwise every position of the window is tried.
+ *
+ * @param seg   Compiled segment owning the chunk.
+ * @param chunk Chunk to locate.
+ * @param name  Candidate name.
+ * @param from  First allowed start position.
+ * @param limit End of the window (the chunk must end at or before it).
+ * @return Start position of the match, or npos.
+ */
+static std::size_t FindChunk(const Segment& seg, const Segment::Chunk& chunk, std::string_view name, std::size_t from, std::size_t limit) noexcept
+{
+    if (from + chunk.width > limit)
+    {
+        return std::string_view::npos;
+    }
+
+    // NO LITERAL TO SEARCH: TRY EVERY START POSITION
+    if (chunk.key == static_cast<std::size_t>(-1))
     {
-        for (const auto& r : cc.ranges)
+        for (std::size_t p = from; p + chunk.width <= limit; ++p)
         {
-            unsigned char a = static_cast<unsigned char>(r.first);
-            unsigned char b = static_cast<unsigned char>(r.last);
-            unsigned char x = static_cast<unsigned char>(ch);
-
-            if (x >= a && x <= b)
+            if (MatchChunkAt(seg, chunk, name, p))
             {
-                hit = true;
-                break;
+                return p;
             }
         }
+        return std::string_view::npos;
     }
 
-    // APPLY NEGATION
-    if (cc.negated)
+    // SEARCH THE KEY LITERAL AND VERIFY THE SURROUNDING ATOMS
+    const std::string& key = seg.atoms[chunk.key].literal;
+
+    std::size_t at = from + chunk.key_offset;
+    while ((at = name.find(key, at)) != std::string_view::npos)
     {
-        return !hit;
+        const std::size_t p = at - chunk.key_offset;
+
+        if (p + chunk.width > limit)
+        {
+            break;
+        }
+        if (MatchChunkAt(seg, chunk, name, p))
+        {
+            return p;
+        }
+
+        at += 1;
     }
 
-    return hit;
+    return std::string_view::npos;
 }
 
 
@@ -623,7 +814,10 @@ static bool CharClassMatch(const CharClass& cc, char ch) noexcept
 /**
  * @brief Match a segment against a single filename segment.
  *
- * This implements matching for segment-local atoms using a DP table:
+ * Compiled segments are matched without backtracking: the first chunk is
+ * anchored at the start, the last one at the end, and each chunk in between
+ * is placed at its leftmost match (which is always safe since only '*'
+ * separates chunks). Uncompiled segments fall back to a DP over atoms:
  * - LITERAL: match exact substring
  * - QMARK: match exactly one character
  * - STAR: match any sequence (including empty) within this segment
@@ -633,111 +827,58 @@ static bool CharClassMatch(const CharClass& cc, char ch) noexcept
  * @param name Candidate name (single path segment).
  * @return true if the segment matches the name.
  */
-static bool MatchSegmentAtoms(const Segment& seg, const std::string& name) noexcept
+static bool MatchSegmentAtoms(const Segment& seg, std::string_view name) noexcept
 {
-    // FAST-PATHS FOR COMMON SEGMENT SHAPES (AVOID DP)
     // NOTE: DOTFILE POLICY IS HANDLED BY THE CALLER.
 
-    auto starts_with = [] (std::string_view s, std::string_view pre) noexcept -> bool
+    if (seg.compiled)
     {
-        if (s.size() < pre.size())
-        {
-            return false;
-        }
-        return s.substr(0, pre.size()) == pre;
-    };
+        const std::string_view sv(name);
+        const std::size_t      N = sv.size();
 
-    auto ends_with = [] (std::string_view s, std::string_view suf) noexcept -> bool
-    {
-        if (s.size() < suf.size())
+        if (N < seg.min_len)
         {
             return false;
         }
-        return s.substr(s.size() - suf.size(), suf.size()) == suf;
-    };
 
-    const std::size_t Afast = seg.atoms.size();
-    if (Afast == 0)
-    {
-        return name.empty();
-    }
-
-    // SINGLE ATOM CASES
-    if (Afast == 1)
-    {
-        const Atom& a0 = seg.atoms[0];
+        const Segment::Chunk& head = seg.chunks.front();
 
-        if (a0.kind == Atom::Kind::LITERAL)
-        {
-            return name == a0.literal;
-        }
-        if (a0.kind == Atom::Kind::STAR)
-        {
-            return true;
-        }
-        if (a0.kind == Atom::Kind::QMARK)
-        {
-            return name.size() == 1;
-        }
-        if (a0.kind == Atom::Kind::CHARCLASS)
+        // NO STAR: THE WHOLE NAME IS A SINGLE FIXED-WIDTH RUN
+        if (seg.chunks.size() == 1)
         {
-            return (name.size() == 1) && CharClassMatch(a0.cls, name[0]);
+            return N == head.width && MatchChunkAt(seg, head, sv, 0);
         }
-    }
 
-    // PURE QMARKS: EXACT LENGTH MATCH
-    bool only_qmarks = true;
-    for (const auto& a : seg.atoms)
-    {
-        if (a.kind != Atom::Kind::QMARK)
-        {
-            only_qmarks = false;
-            break;
-        }
-    }
-    if (only_qmarks)
-    {
-        return name.size() == seg.atoms.size();
-    }
+        const Segment::Chunk& tail = seg.chunks.back();
 
-    // SIMPLE STAR FORMS WITHOUT CHARCLASSES:
-    //   "*.ext"   => STAR + LITERAL
-    //   "pre*"    => LITERAL + STAR
-    //   "pre*suf" => LITERAL + STAR + LITERAL
-    //   "*suf"    => STAR + LITERAL
-    //   "pre*"    => LITERAL + STAR
-    bool has_charclass = false;
-    for (const auto& a : seg.atoms)
-    {
-        if (a.kind == Atom::Kind::CHARCLASS)
+        // ANCHORED PREFIX AND SUFFIX RUNS
+        if (!MatchChunkAt(seg, head, sv, 0) || !MatchChunkAt(seg, tail, sv, N - tail.width))
         {
-            has_charclass = true;
-            break;
+            return false;
         }
-    }
 
-    if (!has_charclass)
-    {
-        if (Afast == 2 && seg.atoms[0].kind == Atom::Kind::STAR && seg.atoms[1].kind == Atom::Kind::LITERAL)
-        {
-            return ends_with(name, seg.atoms[1].literal);
-        }
-        if (Afast == 2 && seg.atoms[0].kind == Atom::Kind::LITERAL && seg.atoms[1].kind == Atom::Kind::STAR)
-        {
-            return starts_with(name, seg.atoms[0].literal);
-        }
-        if (Afast == 3 && seg.atoms[0].kind == Atom::Kind::LITERAL && seg.atoms[1].kind == Atom::Kind::STAR && seg.atoms[2].kind == Atom::Kind::LITERAL)
+        // INNER RUNS: LEFTMOST PLACEMENT BETWEEN THE ANCHORS
+        std::size_t       pos   = head.width;
+        const std::size_t limit = N - tail.width;
+
+        for (std::size_t c = 1; c + 1 < seg.chunks.size(); ++c)
         {
-            const std::string& pre = seg.atoms[0].literal;
-            const std::string& suf = seg.atoms[2].literal;
+            const Segment::Chunk& chunk = seg.chunks[c];
+            if (chunk.width == 0)
+            {
+                continue;
+            }
 
-            if (name.size() < pre.size() + suf.size())
+            const std::size_t at = FindChunk(seg, chunk, sv, pos, limit);
+            if (at == std::string_view::npos)
             {
                 return false;
             }
 
-            return starts_with(name, pre) && ends_with(name, suf);
+            pos = at + chunk.width;
         }
+
+        return true;
     }
 
     const std::size_t A = seg.atoms.size();
@@ -835,196 +976,1064 @@ static bool MatchSegmentAtoms(const Segment& seg, const std::string& name) noexc
 
 
 /**
- * @brief List directory entries with deterministic ordering.
+ * @brief Format tag written at the head of a listing cache file.
+ */
+static const std::string LISTING_CACHE_MAGIC = "ARCGLOB2";
+
+
+
+/**
+ * @brief Widest filesystem timestamp granularity guarded against (FAT keeps 2 seconds).
+ */
+static constexpr std::int64_t RACY_WINDOW_NS = 2000000000LL;
+
+
+
+/**
+ * @brief Directory entry as seen by the expander.
  *
- * The entries are collected into @p entries and sorted by filename (generic string)
- * to keep expansion deterministic across platforms/filesystems.
+ * Only the data needed for matching is kept, so a listing can be persisted
+ * and restored by the listing cache without touching the filesystem.
+ */
+struct DirEntry
+{
+    std::string name;                   ///< Entry filename (single segment).
+    bool        is_dir     = false;     ///< Entry is a directory (symlinks followed).
+    bool        is_symlink = false;     ///< Entry itself is a symbolic link.
+};
+
+
+
+/**
+ * @brief Directory stamp used to validate a cached listing.
  *
- * @param dir Directory path to list.
- * @param entries Output vector of directory entries.
+ * Adding, removing or renaming an entry updates the directory mtime, while
+ * dev/inode catch a directory replaced by another one at the same path.
+ * On Windows there is no inode: the identity is a hash of the canonical path.
  */
-static void ListDir(const fs::path& dir, std::vector<fs::directory_entry>& entries) noexcept
+struct DirStamp
 {
-    // RESET OUTPUT
-    entries.clear();
+    std::uint64_t dev   = 0;            ///< Device id.
+    std::uint64_t ino   = 0;            ///< Inode number.
+    std::int64_t  mtime = 0;            ///< Modification time (nanoseconds).
 
-    std::error_code ec;
-    fs::directory_iterator it(dir, ec);
-    if (ec)
+    bool operator == (const DirStamp& o) const noexcept
     {
-        return;
+        return dev == o.dev && ino == o.ino && mtime == o.mtime;
     }
+};
 
-    // COLLECT ENTRIES
-    for (const auto& de : it)
+
+
+/**
+ * @brief Persistent directory listing cache (see ExpandOptions::listing_cache).
+ *
+ * Listings are keyed by normalized directory path. Only the directories visited
+ * during the current expansion are written back, so the file tracks the shape
+ * of the arcfile globs instead of growing without bound.
+ */
+struct ListingCache
+{
+    struct Record
     {
-        entries.push_back(de);
-    }
+        DirStamp              stamp;    ///< Stamp observed when the listing was taken.
+        std::int64_t          listed;   ///< Time the listing was taken (same clock as the stamp mtime).
+        std::vector<DirEntry> entries;  ///< Sorted listing.
+        bool                  used;     ///< Visited during this expansion.
+
+        /**
+         * @brief A listing taken within the timestamp granularity of the directory
+         *        mtime could miss a change stamped with that same mtime: never trust it.
+         */
+        bool racy() const noexcept
+        {
+            return stamp.mtime > listed - RACY_WINDOW_NS;
+        }
+    };
 
-    // SORT FOR DETERMINISTIC OUTPUT
-    std::sort(entries.begin(), entries.end(),
-                [] (const fs::directory_entry& a, const fs::directory_entry& b) {
-                    return a.path().filename().generic_string() < b.path().filename().generic_string();
-                });
-}
+    std::map<std::string, Record> records;
+    bool                          dirty = false;
+};
 
 
 
 /**
- * @brief Determine whether a directory_entry should be treated as a directory.
+ * @brief Read the stamp of a directory.
  *
- * This optionally follows symlinks. When symlink following is disabled, symlinks
- * are treated conservatively (symlink-to-dir does not count as a directory).
- *
- * @param de Directory entry to test.
- * @param follow_symlinks Whether symlinks should be followed.
- * @return true if the entry is a directory per the chosen policy.
+ * @param dir Directory path.
+ * @param out Output stamp.
+ * @return false if the directory cannot be stat'ed.
  */
-static bool IsDir(const fs::directory_entry& de, bool follow_symlinks) noexcept
+static bool StampDir(const fs::path& dir, DirStamp& out) noexcept
 {
+#if defined(_WIN32)
     std::error_code ec;
 
-    // FOLLOW SYMLINKS IF REQUESTED
-    if (follow_symlinks)
-    {
-        return de.is_directory(ec);
-    }
+    const auto mtime     = fs::last_write_time(dir, ec);
+    if (ec) return false;
 
-    // CONSERVATIVE MODE: DO NOT TREAT SYMLINKS AS DIRECTORIES
-    if (de.is_symlink(ec))
+    const auto canonical = fs::canonical(dir, ec);
+    if (ec) return false;
+
+    out.dev   = 0;
+    out.ino   = static_cast<std::uint64_t>(fs::hash_value(canonical));
+    out.mtime = std::chrono::duration_cast<std::chrono::nanoseconds>(mtime.time_since_epoch()).count();
+#else
+    struct stat st;
+
+    if (::stat(dir.c_str(), &st) != 0)
     {
         return false;
     }
 
-    return de.is_directory(ec);
+    out.dev = static_cast<std::uint64_t>(st.st_dev);
+    out.ino = static_cast<std::uint64_t>(st.st_ino);
+
+#if defined(__APPLE__)
+    out.mtime = static_cast<std::int64_t>(st.st_mtimespec.tv_sec) * 1000000000LL + st.st_mtimespec.tv_nsec;
+#else
+    out.mtime = static_cast<std::int64_t>(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec;
+#endif
+#endif
+
+    return true;
+}
+
+
+
+/**
+ * @brief Current time on the clock directory stamps are taken from.
+ * @return Nanoseconds since that clock epoch.
+ */
+static std::int64_t StampNow() noexcept
+{
+#if defined(_WIN32)
+    const auto now = fs::file_time_type::clock::now();
+#else
+    const auto now = std::chrono::system_clock::now();
+#endif
+
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();
 }
 
 
 
 /**
- * @brief Recursive filesystem expansion of a parsed glob pattern.
+ * @brief Load a listing cache file.
  *
- * The algorithm walks pattern segments while descending the filesystem:
- * - For a DOUBLESTAR segment, it tries the 0-directory case and then recurses into each subdirectory
- *   reusing the same segment index (to match multiple levels).
- * - For a normal segment, it lists the current directory, matches entries against the segment atoms,
- *   and then advances to the next segment.
+ * A missing, truncated or foreign file simply yields an empty cache.
  *
- * @param pattern Parsed glob pattern.
- * @param opt Expansion options (dotfiles policy, symlink policy).
- * @param cur_dir Current directory in the traversal.
- * @param seg_index Index of the current pattern segment.
- * @param out Output list of matched generic paths.
+ * @param file Cache file path.
+ * @param cache Output cache.
  */
-static void ExpandRec(const Pattern& pattern, const ExpandOptions& opt, const fs::path& cur_dir, std::size_t seg_index, std::vector<std::string>& out) noexcept
+static void LoadListingCache(const fs::path& file, ListingCache& cache) noexcept
 {
-    // TERMINATION: ALL SEGMENTS CONSUMED
-    if (seg_index >= pattern.segments.size())
+    std::ifstream in(file, std::ios::binary);
+
+    if (!in)
     {
-        // EMIT FINAL MATCH PATH
-        out.push_back(cur_dir.lexically_normal().generic_string());
         return;
     }
 
-    const Segment& seg = pattern.segments[seg_index];
-
-    // HANDLE DOUBLESTAR SEGMENT: 0..N DIRECTORIES
-    if (seg.IsDoubleStarOnly())
+    auto read_u64 = [&] (std::uint64_t& v) -> bool
     {
-        // TRY 0-DIRECTORY MATCH (ADVANCE PATTERN WITHOUT DESCENT)
-        ExpandRec(pattern, opt, cur_dir, seg_index + 1, out);
-
-        // TRY N-DIRECTORY MATCHES (DESCEND INTO EACH SUBDIR AND REUSE SEG_INDEX)
-        std::vector<fs::directory_entry> entries;
-        ListDir(cur_dir, entries);
+        return static_cast<bool>(in.read(reinterpret_cast<char*>(&v), sizeof(v)));
+    };
 
-        for (const auto& de : entries)
+    auto read_str = [&] (std::string& s) -> bool
+    {
+        std::uint64_t len;
+        if (!read_u64(len) || len > 4096)
         {
-            std::string name = de.path().filename().generic_string();
-
-            // APPLY DOTFILE FILTER AT DIRECTORY TRAVERSAL TIME
-            if (!opt.include_dotfiles && StartsWithDot(name))
-            {
-                continue;
-            }
-
-            // ONLY DESCEND INTO DIRECTORIES UNDER THE SELECTED POLICY
-            if (!IsDir(de, opt.follow_symlinks))
-            {
-                continue;
-            }
-
-            ExpandRec(pattern, opt, de.path(), seg_index, out);
+            return false;
         }
+        s.resize(static_cast<std::size_t>(len));
+        return static_cast<bool>(in.read(s.data(), static_cast<std::streamsize>(len)));
+    };
 
+    // CHECK FORMAT MAGIC
+    std::string magic;
+    if (!read_str(magic) || magic != LISTING_CACHE_MAGIC)
+    {
         return;
     }
 
-    // FAST-PATH: LITERAL-ONLY SEGMENT CAN BE RESOLVED WITHOUT ENUMERATION.
-    // THIS IS SEMANTICALLY IDENTICAL TO LISTDIR+MATCH BUT AVOIDS SCANNING.
+    std::uint64_t ndirs;
+    if (!read_u64(ndirs))
     {
-        std::string_view lit;
-        if (SegmentIsLiteralOnly(seg, lit))
+        return;
+    }
+
+    // READ DIRECTORY RECORDS, STOP AT THE FIRST DAMAGED ONE
+    for (std::uint64_t d = 0; d < ndirs; ++d)
+    {
+        std::string           key;
+        ListingCache::Record  rec{};
+        std::uint64_t         mtime;
+        std::uint64_t         listed;
+        std::uint64_t         nentries;
+
+        if (!read_str(key) || !read_u64(rec.stamp.dev) || !read_u64(rec.stamp.ino) || !read_u64(mtime) || !read_u64(listed) || !read_u64(nentries))
         {
-            // DOTFILES POLICY: A LEADING '.' IS EXPLICIT, SO IT IS ALLOWED
-            // EVEN WHEN include_dotfiles IS FALSE.
-            std::error_code ec;
-            fs::path next = cur_dir / fs::path(std::string(lit));
+            return;
+        }
 
-            if (!fs::exists(next, ec))
-            {
-                return;
-            }
+        rec.stamp.mtime = static_cast<std::int64_t>(mtime);
+        rec.listed      = static_cast<std::int64_t>(listed);
+        rec.entries.resize(static_cast<std::size_t>(nentries));
 
-            // IF THERE ARE MORE SEGMENTS, WE MUST DESCEND INTO A DIRECTORY
-            if (seg_index + 1 < pattern.segments.size())
+        for (auto& e : rec.entries)
+        {
+            char flags;
+            if (!read_str(e.name) || !in.get(flags))
             {
-                if (!fs::is_directory(next, ec))
-                {
-                    return;
-                }
+                return;
             }
 
-            ExpandRec(pattern, opt, next, seg_index + 1, out);
-            return;
+            e.is_dir     = (flags & 0x01) != 0;
+            e.is_symlink = (flags & 0x02) != 0;
         }
-    }
 
-    // NORMAL SEGMENT: MATCH IN CURRENT DIRECTORY AND ADVANCE
-    std::vector<fs::directory_entry> entries;
-    ListDir(cur_dir, entries);
+        cache.records.emplace(std::move(key), std::move(rec));
+    }
+}
+
+
+
+/**
+ * @brief Write back the listing cache.
+ *
+ * @param file Cache file path.
+ * @param cache Cache to persist.
+ * @param prune Drop the listings not visited during this expansion.
+ */
+static void SaveListingCache(const fs::path& file, const ListingCache& cache, const bool prune) noexcept
+{
+    std::error_code ec;
+
+    // ENSURE PARENT FOLDER EXISTS
+    if (file.has_parent_path())
+    {
+        fs::create_directories(file.parent_path(), ec);
+    }
+
+    std::ofstream out(file, std::ios::binary | std::ios::trunc);
+
+    if (!out)
+    {
+        return;
+    }
+
+    auto write_u64 = [&] (std::uint64_t v)
+    {
+        out.write(reinterpret_cast<const char*>(&v), sizeof(v));
+    };
+
+    auto write_str = [&] (const std::string& s)
+    {
+        write_u64(s.size());
+        out.write(s.data(), static_cast<std::streamsize>(s.size()));
+    };
+
+    std::uint64_t ndirs = 0;
+
+    for (const auto& [key, rec] : cache.records)
+    {
+        ndirs += (rec.used || !prune) ? 1 : 0;
+    }
+
+    write_str(LISTING_CACHE_MAGIC);
+    write_u64(ndirs);
+
+    for (const auto& [key, rec] : cache.records)
+    {
+        if (!rec.used && prune)
+        {
+            continue;
+        }
+
+        write_str(key);
+        write_u64(rec.stamp.dev);
+        write_u64(rec.stamp.ino);
+        write_u64(static_cast<std::uint64_t>(rec.stamp.mtime));
+        write_u64(static_cast<std::uint64_t>(rec.listed));
+        write_u64(rec.entries.size());
+
+        for (const auto& e : rec.entries)
+        {
+            write_str(e.name);
+            out.put(static_cast<char>((e.is_dir ? 0x01 : 0x00) | (e.is_symlink ? 0x02 : 0x00)));
+        }
+    }
+}
+
+
+
+/**
+ * @brief List directory entries with deterministic ordering.
+ *
+ * The entries are collected into @p entries and sorted by filename (generic string)
+ * to keep expansion deterministic across platforms/filesystems.
+ *
+ * When a listing cache is provided, a cached listing is reused as long as the
+ * directory stamp is unchanged and the listing was taken clearly after that
+ * stamp; otherwise the directory is read and the cache record refreshed.
+ *
+ * @param dir Directory path to list.
+ * @param entries Output vector of directory entries.
+ * @param cache Optional persistent listing cache.
+ */
+static void ListDir(const fs::path& dir, std::vector<DirEntry>& entries, ListingCache* cache) noexcept
+{
+    // RESET OUTPUT
+    entries.clear();
+
+    std::string  key;
+    DirStamp     stamp;
+    std::int64_t listed  = 0;
+    bool         stamped = false;
+
+    // REUSE A CACHED LISTING WHILE THE DIRECTORY IS UNCHANGED
+    if (cache != nullptr)
+    {
+        key     = dir.lexically_normal().generic_string();
+        listed  = StampNow();
+        stamped = StampDir(dir, stamp);
+
+        if (auto it = cache->records.find(key); stamped && it != cache->records.end())
+        {
+            it->second.used = true;
+
+            if (it->second.stamp == stamp && !it->second.racy())
+            {
+                entries = it->second.entries;
+                return;
+            }
+        }
+    }
+
+    std::error_code ec;
+    fs::directory_iterator it(dir, ec);
+    if (ec)
+    {
+        return;
+    }
+
+    // COLLECT ENTRIES
+    for (const auto& de : it)
+    {
+        DirEntry e;
+        e.name       = de.path().filename().generic_string();
+        e.is_dir     = de.is_directory(ec);
+        e.is_symlink = de.is_symlink(ec);
+
+        entries.push_back(std::move(e));
+    }
+
+    // SORT FOR DETERMINISTIC OUTPUT
+    std::sort(entries.begin(), entries.end(),
+                [] (const DirEntry& a, const DirEntry& b) {
+                    return a.name < b.name;
+                });
+
+    // REFRESH CACHE RECORD
+    if (cache != nullptr && stamped)
+    {
+        cache->records[key] = ListingCache::Record{ stamp, listed, entries, true };
+        cache->dirty        = true;
+    }
+}
+
+
+
+/**
+ * @brief Determine whether a directory entry should be treated as a directory.
+ *
+ * This optionally follows symlinks. When symlink following is disabled, symlinks
+ * are treated conservatively (symlink-to-dir does not count as a directory).
+ *
+ * @param de Directory entry to test.
+ * @param follow_symlinks Whether symlinks should be followed.
+ * @return true if the entry is a directory per the chosen policy.
+ */
+static bool IsDir(const DirEntry& de, bool follow_symlinks) noexcept
+{
+    // CONSERVATIVE MODE: DO NOT TREAT SYMLINKS AS DIRECTORIES
+    if (!follow_symlinks && de.is_symlink)
+    {
+        return false;
+    }
+
+    return de.is_dir;
+}
+
+
+
+/**
+ * @brief Active matcher state during a multi-pattern walk.
+ *
+ * Each state is a (pattern index, segment index) pair: the pattern identified by
+ * the first element still has to match its segments starting at the second one.
+ */
+using WalkState  = std::pair<std::size_t, std::size_t>;
+using WalkStates = std::vector<WalkState>;
+
+
+
+/**
+ * @brief Shared state of a multi-pattern walk.
+ */
+struct WalkContext
+{
+    const std::vector<const Pattern*>&     patterns;    ///< Patterns being expanded.
+    const std::vector<const Pattern*>&     excludes;    ///< Exclusion patterns (ExpandOptions::exclude).
+    const std::vector<std::vector<std::size_t>>& scopes;///< Exclusions applying to each pattern (empty: all).
+    const ExpandOptions&                   opt;         ///< Expansion options.
+    ListingCache*                          cache;       ///< Optional persistent listing cache.
+    const Sink&                            sink;        ///< Receives (pattern, path) as matches are found.
+
+    std::deque<Pattern>                    ignore_rules;///< Rules loaded from ignore files (stable storage).
+    std::vector<const Pattern*>            ignores;     ///< Views over ignore_rules, indexed by rule id.
+    std::vector<std::uint8_t>              ignore_flags;///< IGNORE_* flags, indexed by rule id.
+
+    /// States already expanded in each real directory, keyed by (dev, inode).
+    /// Only filled with ExpandOptions::follow_symlinks, where links can alias or loop.
+    std::map<std::pair<std::uint64_t, std::uint64_t>, WalkStates> visited;
+};
+
+
+
+/**
+ * @brief Ignore rule flags.
+ */
+static constexpr std::uint8_t IGNORE_NEGATE   = 0x01;   ///< "!" rule: re-include a previously ignored entry.
+static constexpr std::uint8_t IGNORE_DIR_ONLY = 0x02;   ///< Trailing "/" rule: only matches directories.
+
+
+
+/**
+ * @brief Close a state set over DOUBLESTAR segments and canonicalize it.
+ *
+ * A DOUBLESTAR segment can match zero directories, so every state sitting on a
+ * "**" also activates the state on the following segment in the same directory.
+ * The resulting set is sorted and deduplicated.
+ *
+ * @param patterns Patterns referenced by the states.
+ * @param states State set to close in-place.
+ */
+static void CloseStates(const std::vector<const Pattern*>& patterns, WalkStates& states) noexcept
+{
+    // ZERO-DIRECTORY MATCH FOR EVERY '**' (NEW STATES ARE VISITED TOO)
+    for (std::size_t k = 0; k < states.size(); ++k)
+    {
+        const auto [p, i]     = states[k];
+        const Pattern& pat    = *patterns[p];
+
+        if (i < pat.segments.size() && pat.segments[i].IsDoubleStarOnly())
+        {
+            states.emplace_back(p, i + 1);
+        }
+    }
+
+    // CANONICAL ORDER, NO DUPLICATES
+    std::sort(states.begin(), states.end());
+    states.erase(std::unique(states.begin(), states.end()), states.end());
+}
+
+
+
+/**
+ * @brief Advance filter states (exclusions, ignore rules) into a child entry.
+ *
+ * Filter patterns are walked alongside the include patterns, so matching a
+ * child costs one segment match per active filter instead of a full-path match.
+ *
+ * @param excludes Filter patterns.
+ * @param active Closed filter states of the parent directory.
+ * @param name Child entry name.
+ * @return Closed filter states of the child.
+ */
+static WalkStates AdvanceStates(const std::vector<const Pattern*>& excludes, const WalkStates& active, std::string_view name) noexcept
+{
+    WalkStates next;
+
+    for (const auto& [x, i] : active)
+    {
+        const Pattern& pat = *excludes[x];
+
+        // TERMINAL STATES DO NOT EXTEND TO CHILDREN
+        if (i >= pat.segments.size())
+        {
+            continue;
+        }
+
+        const Segment& seg = pat.segments[i];
+
+        // '**' SPANS ANY NUMBER OF DIRECTORIES (HIDDEN ONES INCLUDED)
+        if (seg.IsDoubleStarOnly())
+        {
+            next.emplace_back(x, i);
+            continue;
+        }
+
+        if (MatchSegmentAtoms(seg, name))
+        {
+            next.emplace_back(x, i + 1);
+        }
+    }
+
+    CloseStates(excludes, next);
+    return next;
+}
+
+
+
+/**
+ * @brief Check whether a fully matched exclusion applies to a pattern.
+ *
+ * @param ctx Walk context.
+ * @param p Include pattern index.
+ * @param excluded Closed exclusion states of the current entry.
+ * @return true if the entry must be pruned for pattern @p p.
+ */
+static bool IsExcluded(const WalkContext& ctx, std::size_t p, const WalkStates& excluded) noexcept
+{
+    for (const auto& [x, i] : excluded)
+    {
+        if (i < ctx.excludes[x]->segments.size())
+        {
+            continue;
+        }
+
+        if (ctx.scopes.empty() || std::binary_search(ctx.scopes[p].begin(), ctx.scopes[p].end(), x))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+
+/**
+ * @brief Load one gitignore-style file and activate its rules at @p dir.
+ *
+ * Supported syntax: blank lines and '#' comments, "!" negation, trailing "/"
+ * for directory-only rules, and anchoring: a rule containing "/" is relative to
+ * @p dir, any other rule matches at every depth (as if prefixed with "**").
+ * Rules are compiled with Glob::Parse; invalid ones are skipped.
+ *
+ * @param ctx Walk context receiving the rules.
+ * @param file Ignore file path.
+ * @param active Ignore states of @p dir, extended with the new rules.
+ */
+static void LoadIgnoreFile(WalkContext& ctx, const fs::path& file, WalkStates& active) noexcept
+{
+    std::ifstream in(file);
+
+    if (!in)
+    {
+        return;
+    }
+
+    std::string line;
+
+    while (std::getline(in, line))
+    {
+        std::uint8_t flags = 0;
+
+        // NORMALIZE CRLF AND TRAILING BLANKS
+        while (!line.empty() && (line.back() == '\r' || line.back() == ' ' || line.back() == '\t'))
+        {
+            line.pop_back();
+        }
+
+        // SKIP BLANK LINES AND COMMENTS
+        if (line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+
+        // NEGATION (A LEADING BACKSLASH KEEPS '!' AND '#' LITERAL)
+        if (line[0] == '!')
+        {
+            flags |= IGNORE_NEGATE;
+            line.erase(0, 1);
+        }
+        else if (line.size() > 1 && line[0] == '\\' && (line[1] == '!' || line[1] == '#'))
+        {
+            line.erase(0, 1);
+        }
+
+        // DIRECTORY-ONLY RULE
+        if (!line.empty() && line.back() == '/')
+        {
+            flags |= IGNORE_DIR_ONLY;
+            line.pop_back();
+        }
+
+        if (line.empty())
+        {
+            continue;
+        }
+
+        // ANCHORED RULES ARE RELATIVE TO THE IGNORE FILE, OTHERS MATCH AT ANY DEPTH
+        if (line.find('/') == std::string::npos)
+        {
+            line.insert(0, "**/");
+        }
+        else if (line[0] == '/')
+        {
+            line.erase(0, 1);
+        }
+
+        Pattern    rule;
+        ParseError err;
+
+        if (!Parse(line, rule, err) || rule.absolute)
+        {
+            continue;
+        }
+
+        ctx.ignore_rules.push_back(std::move(rule));
+        ctx.ignores.push_back(&ctx.ignore_rules.back());
+        ctx.ignore_flags.push_back(flags);
+
+        active.emplace_back(ctx.ignores.size() - 1, 0);
+    }
+}
+
+
+
+/**
+ * @brief Decide whether an entry is ignored by the active ignore rules.
+ *
+ * As in git, the last matching rule wins: rules from deeper ignore files and
+ * later lines have higher ids, so the highest fully matched rule decides.
+ *
+ * @param ctx Walk context.
+ * @param ignored Closed ignore states of the entry.
+ * @param entry Listing entry (its directory flag decides directory-only rules).
+ * @return true if the entry is ignored.
+ */
+static bool IsIgnored(const WalkContext& ctx, const WalkStates& ignored, const DirEntry& entry) noexcept
+{
+    for (auto it = ignored.rbegin(); it != ignored.rend(); ++it)
+    {
+        const auto [r, i] = *it;
+
+        if (i < ctx.ignores[r]->segments.size())
+        {
+            continue;
+        }
+
+        if ((ctx.ignore_flags[r] & IGNORE_DIR_ONLY) && !entry.is_dir)
+        {
+            continue;
+        }
+
+        return (ctx.ignore_flags[r] & IGNORE_NEGATE) == 0;
+    }
+
+    return false;
+}
+
+
+
+/**
+ * @brief Recursive filesystem walk serving several parsed patterns at once.
+ *
+ * All patterns advance together, like a trie over their segments: the states of
+ * every pattern that reach the same directory are merged, so the directory is
+ * listed at most once no matter how many patterns (or "**" segments) need it.
+ * - A terminal state emits @p cur_dir for its pattern.
+ * - A literal-only segment is resolved with a single lookup (no enumeration).
+ * - DOUBLESTAR and wildcard segments share one listing of @p cur_dir: "**" keeps
+ *   its segment index while descending, the others advance to the next segment.
+ * - A child fully matched by an exclusion pattern is dropped for the patterns the
+ *   exclusion applies to; when no pattern is left the subtree is never entered.
+ * - With ExpandOptions::ignore_files, ignore files found in @p cur_dir add rules;
+ *   an ignored child is no longer reached by wildcard or "**" segments, while
+ *   literal segments naming it explicitly still descend.
+ * - With ExpandOptions::follow_symlinks, a state is expanded at most once per real
+ *   directory (dev, inode): symlink loops terminate and aliased subtrees are
+ *   reported under the first path that reached them.
+ *
+ * @param ctx Walk context (patterns, options, listing cache, outputs).
+ * @param cur_dir Current directory in the traversal.
+ * @param states Active states for @p cur_dir.
+ * @param excluded Closed exclusion states for @p cur_dir.
+ * @param ignored Closed ignore states for @p cur_dir (inherited from ancestors).
+ */
+static void ExpandWalk(WalkContext& ctx, const fs::path& cur_dir, WalkStates states, const WalkStates& excluded, WalkStates ignored) noexcept
+{
+    const auto& patterns = ctx.patterns;
+    const auto& opt      = ctx.opt;
+
+    CloseStates(patterns, states);
+
+    // CHILD NAME -> STATES TO CONTINUE WITH (ORDERED FOR DETERMINISM)
+    // NAMED STATES REACH THE CHILD THROUGH A LITERAL SEGMENT, MATCHED ONES THROUGH A WILDCARD
+    struct Child
+    {
+        using allocator_type = std::pmr::polymorphic_allocator<WalkState>;
+
+        explicit Child(const allocator_type& alloc) : named(alloc), matched(alloc) {}
+
+        std::pmr::vector<WalkState> named;
+        std::pmr::vector<WalkState> matched;
+        const DirEntry*             entry = nullptr;    ///< Listing entry behind `matched`.
+    };
+
+    // PER-DIRECTORY SCRATCH LIVES IN A STACK ARENA RELEASED IN ONE STEP WITH THE FRAME.
+    // NAMES ARE VIEWS INTO THE LISTING BELOW OR INTO THE PATTERN LITERALS
+    std::array<std::byte, 4096>             scratch;
+    std::pmr::monotonic_buffer_resource     arena(scratch.data(), scratch.size());
+    std::vector<DirEntry>                   entries;
+    std::pmr::map<std::string_view, Child>  children(&arena);
+
+    auto needs_listing = [&] () noexcept -> bool
+    {
+        return std::any_of(states.begin(), states.end(),
+                           [&] (const WalkState& st) { return st.second < patterns[st.first]->segments.size(); });
+    };
+
+    bool descends = needs_listing();
+
+    // SKIP STATES ALREADY EXPANDED IN THIS REAL DIRECTORY (SYMLINK ALIASES AND LOOPS)
+    if (descends && opt.follow_symlinks)
+    {
+        DirStamp stamp{};
+
+        if (StampDir(cur_dir, stamp))
+        {
+            WalkStates& seen = ctx.visited[{ stamp.dev, stamp.ino }];
+            WalkStates  fresh;
+
+            std::set_difference(states.begin(), states.end(), seen.begin(), seen.end(), std::back_inserter(fresh));
+
+            if (fresh.empty())
+            {
+                return;
+            }
+
+            WalkStates merged;
+            std::set_union(seen.begin(), seen.end(), fresh.begin(), fresh.end(), std::back_inserter(merged));
+
+            seen.swap(merged);
+            states.swap(fresh);
+            descends = needs_listing();
+        }
+    }
+
+    // LOAD IGNORE RULES ONLY WHERE CHILDREN WILL BE LOOKED AT
+
+    if (descends && !opt.ignore_files.empty())
+    {
+        const std::size_t loaded = ctx.ignores.size();
+
+        for (const auto& file : opt.ignore_files)
+        {
+            LoadIgnoreFile(ctx, cur_dir / file, ignored);
+        }
+
+        if (ctx.ignores.size() != loaded)
+        {
+            CloseStates(ctx.ignores, ignored);
+        }
+    }
+
+    // STATES THAT NEED THE DIRECTORY LISTING
+    WalkStates listed;
+
+    for (const auto& [p, i] : states)
+    {
+        const Pattern& pat = *patterns[p];
+
+        // TERMINATION: ALL SEGMENTS CONSUMED
+        if (i >= pat.segments.size())
+        {
+            ctx.sink(p, cur_dir.lexically_normal().generic_string());
+            continue;
+        }
+
+        const Segment& seg = pat.segments[i];
+
+        // FAST-PATH: LITERAL-ONLY SEGMENT CAN BE RESOLVED WITHOUT ENUMERATION.
+        // DOTFILES POLICY: A LEADING '.' IS EXPLICIT, SO IT IS ALLOWED
+        // EVEN WHEN include_dotfiles IS FALSE.
+        std::string_view lit;
+        if (!seg.IsDoubleStarOnly() && SegmentIsLiteralOnly(seg, lit))
+        {
+            std::error_code ec;
+            fs::path next = cur_dir / fs::path(std::string(lit));
+
+            if (!fs::exists(next, ec))
+            {
+                continue;
+            }
+
+            // IF THERE ARE MORE SEGMENTS, WE MUST DESCEND INTO A DIRECTORY
+            if (i + 1 < pat.segments.size() && !fs::is_directory(next, ec))
+            {
+                continue;
+            }
+
+            children[lit].named.emplace_back(p, i + 1);
+            continue;
+        }
+
+        listed.emplace_back(p, i);
+    }
+
+    // SINGLE LISTING SHARED BY ALL WILDCARD AND DOUBLESTAR STATES
+    if (!listed.empty())
+    {
+        ListDir(cur_dir, entries, ctx.cache);
+
+        for (const auto& de : entries)
+        {
+            const std::string& name   = de.name;
+            const bool         dot    = StartsWithDot(name);
+            const bool         is_dir = IsDir(de, opt.follow_symlinks);
+
+            for (const auto& [p, i] : listed)
+            {
+                const Pattern& pat = *patterns[p];
+                const Segment& seg = pat.segments[i];
+
+                // DOUBLESTAR: DESCEND INTO VISIBLE DIRECTORIES, REUSING THE SEGMENT
+                if (seg.IsDoubleStarOnly())
+                {
+                    if ((!opt.include_dotfiles && dot) || !is_dir)
+                    {
+                        continue;
+                    }
+
+                    auto& child = children[name];
+                    child.entry = &de;
+                    child.matched.emplace_back(p, i);
+                    continue;
+                }
+
+                // DOTFILES ARE ALLOWED IF EXPLICITLY ENABLED OR THE SEGMENT LEADS WITH '.'
+                if (dot && !opt.include_dotfiles && !SegmentAllowsDotfiles(seg))
+                {
+                    continue;
+                }
+
+                // MATCH THIS SEGMENT AGAINST THE ENTRY NAME
+                if (!MatchSegmentAtoms(seg, name))
+                {
+                    continue;
+                }
+
+                // IF THERE ARE MORE SEGMENTS, WE MUST DESCEND INTO A DIRECTORY
+                if (i + 1 < pat.segments.size() && !is_dir)
+                {
+                    continue;
+                }
+
+                auto& child = children[name];
+                child.entry = &de;
+                child.matched.emplace_back(p, i + 1);
+            }
+        }
+    }
+
+    // VISIT EACH CHILD ONCE WITH THE UNION OF ITS STATES
+    for (auto& [name, child] : children)
+    {
+        WalkStates next_excluded;
+        WalkStates next_ignored;
+
+        // IGNORED ENTRIES ARE ONLY REACHABLE THROUGH LITERAL SEGMENTS
+        if (!ignored.empty())
+        {
+            next_ignored = AdvanceStates(ctx.ignores, ignored, name);
+
+            if (!child.matched.empty() && IsIgnored(ctx, next_ignored, *child.entry))
+            {
+                child.matched.clear();
+            }
+        }
+
+        if (child.named.empty() && child.matched.empty())
+        {
+            continue;
+        }
+
+        WalkStates next;
+        next.reserve(child.named.size() + child.matched.size());
+        next.insert(next.end(), child.named.begin(), child.named.end());
+        next.insert(next.end(), child.matched.begin(), child.matched.end());
+
+        // PRUNE PATTERNS EXCLUDING THIS CHILD BEFORE DESCENDING
+        if (!excluded.empty())
+        {
+            next_excluded = AdvanceStates(ctx.excludes, excluded, name);
+
+            next.erase(std::remove_if(next.begin(), next.end(),
+                                      [&] (const WalkState& st) { return IsExcluded(ctx, st.first, next_excluded); }),
+                       next.end());
+
+            if (next.empty())
+            {
+                continue;
+            }
+        }
+
+        ExpandWalk(ctx, cur_dir / name, std::move(next), next_excluded, std::move(next_ignored));
+    }
+}
+
+
+
+/**
+ * @brief Resolve the start directory of a pattern.
+ *
+ * @param pattern Parsed pattern.
+ * @param base_dir Base directory used for relative patterns.
+ * @return base_dir for relative patterns, the filesystem root for absolute ones.
+ */
+static fs::path StartDir(const Pattern& pattern, const fs::path& base_dir) noexcept
+{
+    if (!pattern.absolute)
+    {
+        return base_dir;
+    }
+
+    // RESOLVE ROOT DIRECTORY FOR ABSOLUTE PATTERNS
+    fs::path root = base_dir.root_path();
+    if (root.empty())
+    {
+        root = fs::path("/");
+    }
+
+    return root;
+}
+
+
+
+/**
+ * @brief Expand a set of patterns sharing the same start directory.
+ *
+ * @param ctx Walk context.
+ * @param indexes Indexes (into ctx.patterns) of the patterns rooted at @p start.
+ * @param absolute Whether @p start is the filesystem root (selects exclusions).
+ * @param start Start directory.
+ * @return false if @p start does not exist.
+ */
+static bool ExpandFrom(WalkContext& ctx, const std::vector<std::size_t>& indexes, bool absolute, const fs::path& start) noexcept
+{
+    std::error_code ec;
+
+    if (indexes.empty())
+    {
+        return true;
+    }
+
+    // FAIL IF START DOES NOT EXIST
+    if (!fs::exists(start, ec))
+    {
+        return false;
+    }
 
-    // DOTFILES ARE ALLOWED IF EXPLICITLY ENABLED OR THE SEGMENT LEADS WITH '.'
-    bool allow_dot = opt.include_dotfiles || SegmentAllowsDotfiles(seg);
+    // SEED EVERY PATTERN AT ITS FIRST SEGMENT
+    WalkStates states;
+    states.reserve(indexes.size());
 
-    for (const auto& de : entries)
+    for (std::size_t p : indexes)
     {
-        std::string name = de.path().filename().generic_string();
+        states.emplace_back(p, 0);
+    }
 
-        // FILTER DOTFILES WHEN NOT ALLOWED
-        if (!allow_dot && StartsWithDot(name))
-        {
-            continue;
-        }
+    // SEED EXCLUSIONS ROOTED AT THE SAME START
+    WalkStates excluded;
 
-        // MATCH THIS SEGMENT AGAINST THE ENTRY NAME
-        if (!MatchSegmentAtoms(seg, name))
+    for (std::size_t x = 0; x < ctx.excludes.size(); ++x)
+    {
+        if (ctx.excludes[x]->absolute == absolute)
         {
-            continue;
+            excluded.emplace_back(x, 0);
         }
+    }
+
+    CloseStates(ctx.excludes, excluded);
+
+    ExpandWalk(ctx, start, std::move(states), excluded, {});
+    return true;
+}
+
+
+
+/**
+ * @brief Run a walk over @p patterns, loading and saving the listing cache if enabled.
+ *
+ * @param patterns Patterns being expanded.
+ * @param base_dir Base directory used for relative patterns.
+ * @param sink Receives every match as soon as it is found.
+ * @param opt Expansion options.
+ * @param scopes Exclusions applying to each pattern (empty: all).
+ * @return true if every start path exists.
+ */
+static bool ExpandPatterns(const std::vector<const Pattern*>&           patterns,
+                           const fs::path&                              base_dir,
+                           const Sink&                                  sink,
+                           const ExpandOptions&                         opt,
+                           const std::vector<std::vector<std::size_t>>& scopes) noexcept
+{
+    std::vector<std::size_t>    relative;
+    std::vector<std::size_t>    absolute;
+    std::vector<const Pattern*> excludes;
+    ListingCache                cache;
+
+    for (const auto& pattern : opt.exclude)
+    {
+        excludes.push_back(&pattern);
+    }
+
+    // LOAD PERSISTED LISTINGS
+    if (!opt.listing_cache.empty())
+    {
+        LoadListingCache(opt.listing_cache, cache);
+    }
+
+    WalkContext ctx { patterns, excludes, scopes, opt, opt.listing_cache.empty() ? nullptr : &cache, sink, {}, {}, {}, {} };
+
+    // GROUP PATTERNS BY START DIRECTORY
+    for (std::size_t p = 0; p < patterns.size(); ++p)
+    {
+        (patterns[p]->absolute ? absolute : relative).push_back(p);
+    }
+
+    bool ok = true;
+
+    if (!relative.empty())
+    {
+        ok &= ExpandFrom(ctx, relative, false, StartDir(*patterns[relative[0]], base_dir));
+    }
+
+    if (!absolute.empty())
+    {
+        ok &= ExpandFrom(ctx, absolute, true, StartDir(*patterns[absolute[0]], base_dir));
+    }
+
+    // PERSIST ONLY WHEN SOMETHING CHANGED OR WENT STALE (STALENESS IS ONLY KNOWN TO A BUILD-WIDE PASS)
+    if (ctx.cache != nullptr)
+    {
+        bool stale = opt.prune_listing_cache &&
+                     std::any_of(cache.records.begin(), cache.records.end(),
+                                 [] (const auto& kv) { return !kv.second.used; });
 
-        // IF THERE ARE MORE SEGMENTS, WE MUST DESCEND INTO A DIRECTORY
-        if (seg_index + 1 < pattern.segments.size())
+        if (cache.dirty || stale)
         {
-            if (!IsDir(de, opt.follow_symlinks))
-            {
-                continue;
-            }
+            SaveListingCache(opt.listing_cache, cache, opt.prune_listing_cache);
         }
-
-        // RECURSE TO NEXT SEGMENT
-        ExpandRec(pattern, opt, de.path(), seg_index + 1, out);
     }
+
+    return ok;
 }
 
 
@@ -1104,220 +2113,137 @@ static std::string JoinPathSegments(const std::vector<std::string_view>& segs,
 
 
 /**
- * @brief DP predecessor metadata for segment-matching with captures.
+ * @brief Reusable buffers for glob-to-glob mapping.
  *
- * This structure is used to reconstruct capture slices during backtracking.
+ * One instance is shared by every source path of a MapGlobToGlob() call, so
+ * matching and instantiation do not allocate once the buffers have grown to
+ * the largest path seen.
  */
-struct PrevCell
+struct MapScratch
 {
-    bool        has_prev = false;
-    std::size_t pi       = 0;
-    std::size_t pj       = 0;
-
-    bool        capture  = false;
-    Capture::Kind kind   = Capture::Kind::SEGMENT;
-    std::size_t  cs      = 0;
-    std::size_t  ce      = 0;
+    std::vector<std::string_view> src_segs;       ///< Source path split into segments.
+    std::vector<std::uint8_t>     memo_fail;      ///< Flat (pattern segment x source segment) failure table.
+    std::size_t                   stride = 0;     ///< Row width of memo_fail.
+    bool                          contiguous = false; ///< True if source segments are separated by single '/'.
+    std::vector<std::size_t>      starts;         ///< Chunk start positions of the segment being matched.
+    std::vector<Capture>          caps;           ///< Capture accumulator.
+    std::vector<std::string_view> mid;            ///< PATH capture split used during instantiation.
 };
 
 
 
 /**
- * @brief Match a segment against a name while producing capture tokens.
+ * @brief Match a compiled segment against a name while producing capture tokens.
  *
  * Captures are emitted for:
  * - QMARK and CHARCLASS: a single character (CHAR capture)
  * - STAR: a variable-length substring within the segment (SEGMENT capture)
  *
- * The algorithm:
- * - Runs a DP like MatchSegmentAtoms but keeps a predecessor table to backtrack.
- * - Uses deterministic predecessor selection (first time a state is reached wins).
+ * Chunks are placed exactly like MatchSegmentAtoms() does (anchored head and
+ * tail, leftmost inner runs), which gives every '*' but the last its shortest
+ * possible capture; this is deterministic and needs no DP table.
  *
  * @param seg Parsed segment.
  * @param name Candidate segment name.
- * @param out_caps Output captures in forward order.
- * @return true if the segment matches and captures were produced, false otherwise.
+ * @param starts Scratch buffer for chunk start positions.
+ * @param caps Capture accumulator (captures are appended in forward order).
+ * @return true if the segment matches, false otherwise.
  */
-static bool MatchSegmentCapture(const Segment&           seg,
-                                std::string_view         name,
-                                std::vector<Capture>&    out_caps) noexcept
+static bool MatchSegmentCapture(const Segment&            seg,
+                                std::string_view          name,
+                                std::vector<std::size_t>& starts,
+                                std::vector<Capture>&     caps) noexcept
 {
-    // RESET OUTPUT
-    out_caps.clear();
+    // ONLY '**' SEGMENTS ARE LEFT UNCOMPILED, AND THEY NEVER MATCH A SINGLE NAME
+    if (!seg.compiled)
+    {
+        return false;
+    }
 
-    const std::size_t A = seg.atoms.size();
     const std::size_t N = name.size();
+    const std::size_t C = seg.chunks.size();
+
+    if (N < seg.min_len)
+    {
+        return false;
+    }
 
-    // DP + PREDECESSOR TABLE
-    std::vector<std::vector<bool>>     dp(A + 1, std::vector<bool>(N + 1, false));
-    std::vector<std::vector<PrevCell>> prev(A + 1, std::vector<PrevCell>(N + 1));
+    const Segment::Chunk& head = seg.chunks.front();
+    const Segment::Chunk& tail = seg.chunks.back();
 
-    // BASE STATE
-    dp[0][0] = true;
-    prev[0][0].has_prev = true;
-    prev[0][0].pi = 0;
-    prev[0][0].pj = 0;
+    starts.resize(C);
+    starts[0] = 0;
 
-    // ADVANCE OVER ATOMS
-    for (std::size_t i = 0; i < A; ++i)
+    // PLACE CHUNKS
+    if (C == 1)
     {
-        const Atom& a = seg.atoms[i];
-
-        // DOUBLESTAR IS NOT ALLOWED INSIDE A NORMAL SEGMENT
-        if (a.kind == Atom::Kind::DOUBLESTAR)
+        if (N != head.width || !MatchChunkAt(seg, head, name, 0))
         {
             return false;
         }
-
-        if (a.kind == Atom::Kind::LITERAL)
+    }
+    else
+    {
+        if (!MatchChunkAt(seg, head, name, 0) || !MatchChunkAt(seg, tail, name, N - tail.width))
         {
-            // LITERAL: NO CAPTURE, JUST ADVANCE IF IT MATCHES
-            const std::string& lit = a.literal;
-
-            for (std::size_t j = 0; j <= N; ++j)
-            {
-                if (!dp[i][j])
-                {
-                    continue;
-                }
-
-                if (j + lit.size() <= N && name.substr(j, lit.size()) == lit)
-                {
-                    if (!dp[i + 1][j + lit.size()])
-                    {
-                        dp[i + 1][j + lit.size()] = true;
-
-                        prev[i + 1][j + lit.size()].has_prev = true;
-                        prev[i + 1][j + lit.size()].pi = i;
-                        prev[i + 1][j + lit.size()].pj = j;
-                    }
-                }
-            }
+            return false;
         }
-        else if (a.kind == Atom::Kind::QMARK)
-        {
-            // QMARK: CAPTURE ONE CHAR
-            for (std::size_t j = 0; j < N; ++j)
-            {
-                if (!dp[i][j])
-                {
-                    continue;
-                }
-
-                if (!dp[i + 1][j + 1])
-                {
-                    dp[i + 1][j + 1] = true;
 
-                    PrevCell& p = prev[i + 1][j + 1];
-                    p.has_prev = true;
-                    p.pi = i;
-                    p.pj = j;
+        std::size_t       pos   = head.width;
+        const std::size_t limit = N - tail.width;
 
-                    p.capture = true;
-                    p.kind = Capture::Kind::CHAR;
-                    p.cs = j;
-                    p.ce = j + 1;
-                }
-            }
-        }
-        else if (a.kind == Atom::Kind::CHARCLASS)
+        for (std::size_t c = 1; c + 1 < C; ++c)
         {
-            // CHARCLASS: CAPTURE ONE CHAR IF IT MATCHES
-            for (std::size_t j = 0; j < N; ++j)
-            {
-                if (!dp[i][j])
-                {
-                    continue;
-                }
-
-                if (!CharClassMatch(a.cls, name[j]))
-                {
-                    continue;
-                }
-
-                if (!dp[i + 1][j + 1])
-                {
-                    dp[i + 1][j + 1] = true;
+            const Segment::Chunk& chunk = seg.chunks[c];
 
-                    PrevCell& p = prev[i + 1][j + 1];
-                    p.has_prev = true;
-                    p.pi = i;
-                    p.pj = j;
-
-                    p.capture = true;
-                    p.kind = Capture::Kind::CHAR;
-                    p.cs = j;
-                    p.ce = j + 1;
-                }
-            }
-        }
-        else if (a.kind == Atom::Kind::STAR)
-        {
-            // STAR: CAPTURE A SUBSTRING (INCLUDING EMPTY)
-            for (std::size_t j = 0; j <= N; ++j)
+            std::size_t at = pos;
+            if (chunk.width != 0)
             {
-                if (!dp[i][j])
-                {
-                    continue;
-                }
-
-                // DETERMINISTIC: FIRST TIME A STATE IS REACHED WINS
-                for (std::size_t k = j; k <= N; ++k)
+                at = FindChunk(seg, chunk, name, pos, limit);
+                if (at == std::string_view::npos)
                 {
-                    if (!dp[i + 1][k])
-                    {
-                        dp[i + 1][k] = true;
-
-                        PrevCell& p = prev[i + 1][k];
-                        p.has_prev = true;
-                        p.pi = i;
-                        p.pj = j;
-
-                        p.capture = true;
-                        p.kind = Capture::Kind::SEGMENT;
-                        p.cs = j;
-                        p.ce = k;
-                    }
+                    return false;
                 }
             }
+
+            starts[c] = at;
+            pos       = at + chunk.width;
         }
+
+        starts[C - 1] = limit;
     }
 
-    // REQUIRE FULL MATCH
-    if (!dp[A][N])
+    // EMIT CAPTURES IN FORWARD ORDER
+    for (std::size_t c = 0; c < C; ++c)
     {
-        return false;
-    }
+        const Segment::Chunk& chunk = seg.chunks[c];
+        std::size_t           pos   = starts[c];
 
-    // BACKTRACK CAPTURES IN REVERSE ORDER
-    std::vector<Capture> rev;
+        for (std::size_t i = chunk.first; i < chunk.last; ++i)
+        {
+            const Atom& a = seg.atoms[i];
 
-    std::size_t ci = A;
-    std::size_t cj = N;
+            if (a.kind == Atom::Kind::LITERAL)
+            {
+                pos += a.literal.size();
+                continue;
+            }
 
-    while (!(ci == 0 && cj == 0))
-    {
-        const PrevCell& p = prev[ci][cj];
-        if (!p.has_prev)
-        {
-            return false;
+            caps.emplace_back();
+            caps.back().kind = Capture::Kind::CHAR;
+            caps.back().value.assign(name.substr(pos, 1));
+            pos += 1;
         }
 
-        if (p.capture)
+        // THE STAR AFTER THIS CHUNK SPANS UP TO THE NEXT ONE
+        if (c + 1 < C)
         {
-            Capture cap{};
-            cap.kind = p.kind;
-            cap.value.assign(name.substr(p.cs, p.ce - p.cs));
-            rev.push_back(std::move(cap));
+            caps.emplace_back();
+            caps.back().kind = Capture::Kind::SEGMENT;
+            caps.back().value.assign(name.substr(pos, starts[c + 1] - pos));
         }
-
-        ci = p.pi;
-        cj = p.pj;
     }
 
-    // REVERSE TO FORWARD ORDER
-    std::reverse(rev.begin(), rev.end());
-    out_caps = std::move(rev);
     return true;
 }
 
@@ -1330,24 +2256,23 @@ static bool MatchSegmentCapture(const Segment&           seg,
  * It supports multiple DOUBLESTAR segments and produces captures in the order required
  * by the instantiation logic.
  *
- * memo_fail is used as a visited-failure table:
- * - memo_fail[pi][si] == 0 means "this (pattern index, src index) state already failed".
+ * scratch.memo_fail is used as a visited-failure table:
+ * - memo_fail[pi * stride + si] != 0 means "this (pattern index, src index) state already failed".
  *
  * @param from_pat Parsed pattern being matched.
- * @param src_segs Source path segments.
  * @param pi Current pattern segment index.
  * @param si Current source segment index.
- * @param caps Capture accumulator.
- * @param memo_fail Failure memo table.
+ * @param scratch Reusable buffers (segments, memo table, capture accumulator).
  * @return true if a match is found, false otherwise.
  */
-static bool MatchCaptureRec(const Pattern&                        from_pat,
-                            const std::vector<std::string_view>&   src_segs,
-                            std::size_t                            pi,
-                            std::size_t                            si,
-                            std::vector<Capture>&                  caps,
-                            std::vector<std::vector<std::int8_t>>& memo_fail) noexcept
+static bool MatchCaptureRec(const Pattern&   from_pat,
+                            std::size_t      pi,
+                            std::size_t      si,
+                            MapScratch&      scratch) noexcept
 {
+    const auto& src_segs = scratch.src_segs;
+    auto&       caps     = scratch.caps;
+
     // TERMINATION: ALL PATTERN SEGMENTS CONSUMED
     if (pi == from_pat.segments.size())
     {
@@ -1361,7 +2286,8 @@ static bool MatchCaptureRec(const Pattern&                        from_pat,
     }
 
     // FAIL-FAST IF THIS STATE WAS ALREADY PROVEN IMPOSSIBLE
-    if (memo_fail[pi][si] == 0)
+    std::uint8_t& failed = scratch.memo_fail[pi * scratch.stride + si];
+    if (failed)
     {
         return false;
     }
@@ -1374,13 +2300,26 @@ static bool MatchCaptureRec(const Pattern&                        from_pat,
         // TRY SHORTEST MATCH FIRST FOR DETERMINISM
         for (std::size_t t = si; t <= src_segs.size(); ++t)
         {
-            Capture c{};
-            c.kind = Capture::Kind::PATH;
-            c.value = JoinPathSegments(src_segs, si, t);
+            caps.emplace_back();
+            caps.back().kind = Capture::Kind::PATH;
 
-            caps.push_back(std::move(c));
+            // SLICE THE SOURCE DIRECTLY WHEN SEPARATORS ARE NOT DOUBLED
+            if (t == si)
+            {
+                // EMPTY PATH
+            }
+            else if (scratch.contiguous)
+            {
+                const char* first = src_segs[si].data();
+                const char* last  = src_segs[t - 1].data() + src_segs[t - 1].size();
+                caps.back().value.assign(first, static_cast<std::size_t>(last - first));
+            }
+            else
+            {
+                caps.back().value = JoinPathSegments(src_segs, si, t);
+            }
 
-            if (MatchCaptureRec(from_pat, src_segs, pi + 1, t, caps, memo_fail))
+            if (MatchCaptureRec(from_pat, pi + 1, t, scratch))
             {
                 return true;
             }
@@ -1389,41 +2328,28 @@ static bool MatchCaptureRec(const Pattern&                        from_pat,
         }
 
         // MEMOIZE FAILURE
-        memo_fail[pi][si] = 0;
+        failed = 1;
         return false;
     }
 
     // NON-DOUBLESTAR: MUST HAVE A SOURCE SEGMENT AVAILABLE
     if (si >= src_segs.size())
     {
-        memo_fail[pi][si] = 0;
-        return false;
-    }
-
-    std::vector<Capture> local;
-
-    // MATCH ONE SEGMENT AND PRODUCE LOCAL CAPTURES
-    if (!MatchSegmentCapture(seg, src_segs[si], local))
-    {
-        memo_fail[pi][si] = 0;
+        failed = 1;
         return false;
     }
 
-    // APPEND CAPTURES, RECURSE, AND ROLLBACK ON FAILURE
     const std::size_t old_size = caps.size();
-    for (auto& c : local)
-    {
-        caps.push_back(std::move(c));
-    }
 
-    if (MatchCaptureRec(from_pat, src_segs, pi + 1, si + 1, caps, memo_fail))
+    // MATCH ONE SEGMENT, RECURSE, AND ROLLBACK ON FAILURE
+    if (MatchSegmentCapture(seg, src_segs[si], scratch.starts, caps) &&
+        MatchCaptureRec(from_pat, pi + 1, si + 1, scratch))
     {
         return true;
     }
 
-    // ROLLBACK AND MEMOIZE FAILURE
     caps.resize(old_size);
-    memo_fail[pi][si] = 0;
+    failed = 1;
     return false;
 }
 
@@ -1432,30 +2358,30 @@ static bool MatchCaptureRec(const Pattern&                        from_pat,
 /**
  * @brief Match a "from" pattern against a generic path and collect captures.
  *
+ * Captures are left in scratch.caps in forward order.
+ *
  * @param from_pat Parsed pattern used for matching.
  * @param src_generic Source path as a generic string ('/' separators).
- * @param caps Output captures in forward order.
+ * @param scratch Reusable buffers.
  * @return true on match, false otherwise.
  */
-static bool MatchCapture(const Pattern&            from_pat,
-                    std::string_view          src_generic,
-                    std::vector<Capture>&     caps) noexcept
+static bool MatchCapture(const Pattern&   from_pat,
+                         std::string_view src_generic,
+                         MapScratch&      scratch) noexcept
 {
     // RESET OUTPUT
-    caps.clear();
+    scratch.caps.clear();
 
     // SPLIT SOURCE INTO SEGMENTS
-    std::vector<std::string_view> src_segs;
-    SplitPathSegments(src_generic, src_segs);
+    SplitPathSegments(src_generic, scratch.src_segs);
+    scratch.contiguous = src_generic.find("//") == std::string_view::npos;
 
-    // INITIALIZE FAILURE MEMO TABLE
-    std::vector<std::vector<std::int8_t>> memo_fail(
-        from_pat.segments.size() + 1,
-        std::vector<std::int8_t>(src_segs.size() + 1, -1)
-    );
+    // INITIALIZE FAILURE MEMO TABLE (REUSES CAPACITY ACROSS CALLS)
+    scratch.stride = scratch.src_segs.size() + 1;
+    scratch.memo_fail.assign((from_pat.segments.size() + 1) * scratch.stride, 0);
 
     // RUN RECURSIVE MATCHER
-    return MatchCaptureRec(from_pat, src_segs, 0, 0, caps, memo_fail);
+    return MatchCaptureRec(from_pat, 0, 0, scratch);
 }
 
 
@@ -1483,20 +2409,35 @@ static bool Consume(const Capture& c, Capture::Kind k) noexcept
  * - QMARK/CHARCLASS consume CHAR captures and inject exactly one character each.
  * - LITERAL atoms are copied verbatim.
  *
+ * Segments are appended straight into @p out_generic; @p mid is scratch space
+ * for splitting PATH captures.
+ *
  * @param to_pat Parsed pattern used for instantiation.
  * @param caps Captures produced during matching.
+ * @param mid Scratch buffer for PATH capture segments.
  * @param out_generic Output instantiated generic path.
  * @return true on success, false if pattern/capture sequence are incompatible.
  */
-static bool Instantiate(const Pattern&              to_pat,
-                    const std::vector<Capture>& caps,
-                    std::string&                out_generic) noexcept
+static bool Instantiate(const Pattern&                 to_pat,
+                        const std::vector<Capture>&    caps,
+                        std::vector<std::string_view>& mid,
+                        std::string&                   out_generic) noexcept
 {
     // RESET OUTPUT
     out_generic.clear();
 
     std::size_t cap_i = 0;
-    std::vector<std::string> out_segs;
+    bool        first = true;
+
+    // OPEN A NEW OUTPUT SEGMENT ('/' BETWEEN SEGMENTS)
+    auto open_segment = [&] () noexcept
+    {
+        if (!first)
+        {
+            out_generic.push_back('/');
+        }
+        first = false;
+    };
 
     // WALK OUTPUT PATTERN SEGMENTS
     for (const auto& seg : to_pat.segments)
@@ -1513,26 +2454,26 @@ static bool Instantiate(const Pattern&              to_pat,
                 return false;
             }
 
-            std::vector<std::string_view> mid;
             SplitPathSegments(caps[cap_i].value, mid);
 
             for (const auto& s : mid)
             {
-                out_segs.emplace_back(std::string(s));
+                open_segment();
+                out_generic.append(s.data(), s.size());
             }
 
             ++cap_i;
             continue;
         }
 
-        std::string built;
+        open_segment();
 
         // BUILD A SINGLE OUTPUT SEGMENT FROM ATOMS
         for (const auto& a : seg.atoms)
         {
             if (a.kind == Atom::Kind::LITERAL)
             {
-                built += a.literal;
+                out_generic += a.literal;
                 continue;
             }
 
@@ -1548,7 +2489,7 @@ static bool Instantiate(const Pattern&              to_pat,
                 {
                     return false;
                 }
-                built += caps[cap_i].value;
+                out_generic += caps[cap_i].value;
                 ++cap_i;
                 continue;
             }
@@ -1564,7 +2505,7 @@ static bool Instantiate(const Pattern&              to_pat,
                 {
                     return false;
                 }
-                built += caps[cap_i].value;
+                out_generic += caps[cap_i].value;
                 ++cap_i;
                 continue;
             }
@@ -1572,27 +2513,10 @@ static bool Instantiate(const Pattern&              to_pat,
             // DOUBLESTAR SHOULD NOT APPEAR HERE (ONLY SEGMENT-ONLY)
             return false;
         }
-
-        out_segs.push_back(std::move(built));
     }
 
     // ALL CAPTURES MUST BE CONSUMED
-    if (cap_i != caps.size())
-    {
-        return false;
-    }
-
-    // JOIN SEGMENTS INTO A GENERIC PATH
-    for (std::size_t i = 0; i < out_segs.size(); ++i)
-    {
-        if (i != 0)
-        {
-            out_generic.push_back('/');
-        }
-        out_generic += out_segs[i];
-    }
-
-    return true;
+    return cap_i == caps.size();
 }
 
 
@@ -1652,6 +2576,9 @@ bool Arcana::Glob::Parse(std::string_view input, Pattern& out, ParseError& err,
 
 
 
+
+
+
 /**
  * @brief Expand a parsed pattern against the filesystem.
  *
@@ -1668,35 +2595,99 @@ bool Arcana::Glob::Parse(std::string_view input, Pattern& out, ParseError& err,
  */
 bool Arcana::Glob::Expand(const Pattern& pattern, const fs::path& base_dir, std::vector<std::string>& out, const ExpandOptions& opt) noexcept
 {
-    std::error_code ec;
+    // RUN A SINGLE-PATTERN WALK
+    if (!ExpandPatterns({ &pattern }, base_dir, [&out] (std::size_t, const std::string& path) { out.push_back(path); }, opt, {}))
+    {
+        return false;
+    }
+
+    // SORT AND DEDUP FOR DETERMINISTIC OUTPUT
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+
+    return true;
+}
+
+
+
+/**
+ * @brief Expand several parsed patterns, reporting matches as they are found.
+ *
+ * Relative patterns share one walk from @p base_dir and absolute patterns share
+ * one walk from the root, so each directory is listed at most once regardless
+ * of how many patterns reach it. Matches reach @p sink in traversal order.
+ *
+ * @param patterns Parsed patterns to expand.
+ * @param base_dir Base directory used for relative patterns.
+ * @param sink Receives (pattern index, generic path) for every match.
+ * @param opt Expansion options.
+ * @param exclude_scopes Per-pattern indexes into opt.exclude (empty: every exclusion applies to every pattern).
+ * @return true if every start path exists, false otherwise.
+ */
+bool Arcana::Glob::ExpandStream(const std::vector<Pattern>& patterns, const fs::path& base_dir,
+                                const Sink& sink, const ExpandOptions& opt,
+                                const std::vector<std::vector<std::size_t>>& exclude_scopes) noexcept
+{
+    std::vector<const Pattern*> refs;
+
+    refs.reserve(patterns.size());
 
-    // SELECT START DIRECTORY
-    fs::path start = base_dir;
-    if (pattern.absolute)
+    for (const auto& pattern : patterns)
     {
-        // RESOLVE ROOT DIRECTORY FOR ABSOLUTE PATTERNS
-        fs::path root = base_dir.root_path();
-        if (root.empty())
-        {
-            root = fs::path("/");
-        }
-        start = root;
+        refs.push_back(&pattern);
     }
 
-    // FAIL IF START DOES NOT EXIST
-    if (!fs::exists(start, ec))
+    // NORMALIZE SCOPES FOR BINARY SEARCH
+    std::vector<std::vector<std::size_t>> scopes = exclude_scopes;
+
+    for (auto& scope : scopes)
     {
-        return false;
+        std::sort(scope.begin(), scope.end());
     }
 
-    // RUN RECURSIVE EXPANSION
-    ExpandRec(pattern, opt, start, 0, out);
+    return ExpandPatterns(refs, base_dir, sink, opt, scopes);
+}
+
+
+
+/**
+ * @brief Expand several parsed patterns with a single filesystem traversal.
+ *
+ * Collects ExpandStream() results per pattern, forwarding each match to
+ * @p on_match first when provided.
+ *
+ * @param patterns Parsed patterns to expand.
+ * @param base_dir Base directory used for relative patterns.
+ * @param outs Output lists (resized to patterns.size()), sorted and deduplicated.
+ * @param opt Expansion options.
+ * @param exclude_scopes Per-pattern indexes into opt.exclude (empty: every exclusion applies to every pattern).
+ * @param on_match Optional observer called as matches are found.
+ * @return true if every start path exists, false otherwise.
+ */
+bool Arcana::Glob::ExpandAll(const std::vector<Pattern>& patterns, const fs::path& base_dir,
+                             std::vector<std::vector<std::string>>& outs, const ExpandOptions& opt,
+                             const std::vector<std::vector<std::size_t>>& exclude_scopes,
+                             const Sink& on_match) noexcept
+{
+    outs.assign(patterns.size(), {});
+
+    bool ok = ExpandStream(patterns, base_dir, [&] (std::size_t p, const std::string& path)
+    {
+        if (on_match)
+        {
+            on_match(p, path);
+        }
+        outs[p].push_back(path);
+    }, opt, exclude_scopes);
 
     // SORT AND DEDUP FOR DETERMINISTIC OUTPUT
-    std::sort(out.begin(), out.end());
-    out.erase(std::unique(out.begin(), out.end()), out.end());
+    for (auto& out : outs)
+    {
+        std::sort(out.begin(), out.end());
+        out.erase(std::unique(out.begin(), out.end()), out.end());
+    }
 
-    return true;
+    return ok;
 }
 
 
@@ -1705,9 +2696,11 @@ bool Arcana::Glob::Expand(const Pattern& pattern, const fs::path& base_dir, std:
  * @brief Map a list of paths from one glob "shape" into another.
  *
  * This function:
- * - Parses the source ("from") and destination ("to") globs.
- * - For each source string, captures wildcard matches using the "from" pattern.
- * - Instantiates the "to" pattern using the produced captures.
+ * - Parses the destination ("to") glob and every source ("from") glob once.
+ * - For each source glob in order, captures wildcard matches on the sources not
+ *   mapped yet and instantiates the "to" pattern using the produced captures.
+ * - Keeps the unmatched sources for the next glob with an in-place partition,
+ *   so every glob is a single linear pass over the pending sources.
  *
  * Errors are reported through:
  * - err_from for parsing issues in from_glob,
@@ -1723,13 +2716,13 @@ bool Arcana::Glob::Expand(const Pattern& pattern, const fs::path& base_dir, std:
  * @param err_map Mapping error (capture/instantiate).
  * @return true on success, false on parse or mapping failure.
  */
-bool Arcana::Glob:: MapGlobToGlob(std::vector<std::string>  from_glob,
-                    std::string_view  to_glob,
-                    std::vector<std::string> src_list,
-                    std::vector<std::string>&       out_list,
-                    ParseError&       err_from,
-                    ParseError&       err_to,
-                    MapError&         err_map) noexcept
+bool Arcana::Glob::MapGlobToGlob(const std::vector<std::string>& from_glob,
+                                 std::string_view                to_glob,
+                                 const std::vector<std::string>& src_list,
+                                 std::vector<std::string>&       out_list,
+                                 ParseError&                     err_from,
+                                 ParseError&                     err_to,
+                                 MapError&                       err_map) noexcept
 {
     // RESET OUTPUT LIST
     out_list.clear();
@@ -1741,44 +2734,56 @@ bool Arcana::Glob:: MapGlobToGlob(std::vector<std::string>  from_glob,
         return false;
     }
 
-    for (uint32_t i = 0; i < from_glob.size(); ++i)
+    // PARSE EVERY SOURCE GLOB ONCE
+    std::vector<Pattern> from_pats(from_glob.size());
+    for (std::size_t i = 0; i < from_glob.size(); ++i)
     {
-        const auto& from = from_glob[i];
-
-        Pattern from_pat;
-    
-        // PARSE SOURCE GLOB
-        if (!Glob::Parse(from, from_pat, err_from))
+        if (!Glob::Parse(from_glob[i], from_pats[i], err_from))
         {
             return false;
         }
-    
-        // MAP EACH SOURCE PATH THROUGH CAPTURE + INSTANTIATE
-        for (auto it = src_list.begin(); it != src_list.end();)
+    }
+
+    // SOURCES NOT MAPPED YET, IN INPUT ORDER
+    std::vector<std::size_t> pending(src_list.size());
+    for (std::size_t s = 0; s < pending.size(); ++s)
+    {
+        pending[s] = s;
+    }
+
+    MapScratch scratch;
+    out_list.reserve(src_list.size());
+
+    for (std::size_t i = 0; i < from_pats.size(); ++i)
+    {
+        const bool  last = (i == from_pats.size() - 1);
+        std::size_t keep = 0;
+
+        // MAP EACH PENDING SOURCE THROUGH CAPTURE + INSTANTIATE
+        for (std::size_t s : pending)
         {
-            std::vector<Arcana::Glob::Capture> caps;
-            if (!MatchCapture(from_pat, *it, caps))
+            if (!MatchCapture(from_pats[i], src_list[s], scratch))
             {
-                if (i == from_glob.size() - 1)
+                if (last)
                 {
                     err_map.code = MapError::Code::CAPTURE;
                     return false;
-                } 
-                ++it;
+                }
+
+                // KEEP FOR THE NEXT SOURCE GLOB
+                pending[keep++] = s;
                 continue;
             }
-    
-            std::string out;
-            if (!Instantiate(to_pat, caps, out))
+
+            out_list.emplace_back();
+            if (!Instantiate(to_pat, scratch.caps, scratch.mid, out_list.back()))
             {
                 err_map.code = MapError::Code::INSTANTIATE;
                 return false;
             }
-            
-            it = src_list.erase(it);
-
-            out_list.emplace_back(std::move(out));
         }
+
+        pending.resize(keep);
     }
 
     return true;
@@ -3,85 +3,71 @@
 #include "Common.h"
 #include "Semantic.h"
 
+#include <set>
+#include <array>
 #include <mutex>
+#include <cstdint>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+#include <condition_variable>
 
 USE_MODULE(Arcana);
 
-using SymbolMap = Support::AbstractKeywordMap<std::string>;
-
 /**
- * @brief Built-in symbol table used for `{arc:__...__}` expansions.
+ * @brief Built-in symbol values used for `{arc:__...__}` expansions, indexed by Core::SymbolType.
  *
  * Values are stored as strings and can be updated at runtime (e.g. profile selection, threads override).
  */
-static SymbolMap builtin_symbols =
+static std::array<std::string, _I(Core::SymbolType::UNDEFINED) + 1> builtin_symbols =
 {
-    { "__main__"       , "None"                                              },
-    { "__root__"       , std::filesystem::current_path().generic_string()    },
-    { "__version__"    , __ARCANA__VERSION__                                 },
-    { "__release__"    , __ARCANA__RELEASE__                                 },
-    { "__profile__"    , "None"                                              },
-    { "__threads__"    , "None"                                              },
-    { "__max_threads__", std::to_string(std::thread::hardware_concurrency()) },
+    "None",                                                 // __main__
+    std::filesystem::current_path().generic_string(),       // __root__
+    __ARCANA__VERSION__,                                    // __version__
+    __ARCANA__RELEASE__,                                    // __release__
+    "None",                                                 // __profile__
+    "None",                                                 // __threads__
+    std::to_string(std::thread::hardware_concurrency()),    // __max_threads__
 
 #if defined(_WIN32)
-    { "__os__"         , "windows"  },
+    "windows",                                              // __os__
 #elif defined(__APPLE__) && defined(__MACH__)
-    { "__os__"         , "macos"    },
+    "macos",
 #elif defined(__linux__)
-    { "__os__"         , "linux"    },
+    "linux",
 #elif defined(__FreeBSD__)
-    { "__os__"         , "freeBSD"  },
+    "freeBSD",
 #elif defined(__unix__)
-    { "__os__"         , "unix"     },
+    "unix",
 #else
-    { "__os__"         , "unknown"  },
+    "unknown",
 #endif
 
 #if defined(__x86_64__) || defined(_M_X64)
-    { "__arch__"       , "x86_64"   },
+    "x86_64",                                               // __arch__
 #elif defined(__i386__) || defined(_M_IX86)
-    { "__arch__"       , "x86"      },
+    "x86",
 #elif defined(__aarch64__) || defined(_M_ARM64)
-    { "__arch__"       , "aarch64"  },
+    "aarch64",
 #elif defined(__arm__) || defined(_M_ARM)
-    { "__arch__"       , "arm"      },
+    "arm",
 #elif defined(__riscv) || defined(__riscv__)
-    { "__arch__"       , "riscv"    },
+    "riscv",
 #elif defined(__powerpc64__) || defined(__ppc64__)
-    { "__arch__"       , "ppc64"    },
+    "ppc64",
 #elif defined(__powerpc__) || defined(__ppc__)
-    { "__arch__"       , "ppc"      },
+    "ppc",
 #else
-    { "__arch__"       , "unknown"  },
+    "unknown",
 #endif
 };
 
 
 
 /**
- * @brief Map from SymbolType to its canonical token string (e.g. MAIN -> "__main__").
+ * @brief Canonical token string -> SymbolType (e.g. "__main__" -> MAIN), compile-time.
  */
-static std::map<Core::SymbolType, std::string> Known_Symbols_By_Token =
-{
-    { Core::SymbolType::MAIN        , "__main__"        },
-    { Core::SymbolType::ROOT        , "__root__"        },
-    { Core::SymbolType::VERSION     , "__version__"     },
-    { Core::SymbolType::RELEASE     , "__release__"     },
-    { Core::SymbolType::PROFILE     , "__profile__"     },
-    { Core::SymbolType::THREADS     , "__threads__"     },
-    { Core::SymbolType::MAX_THREADS , "__max_threads__" },
-    { Core::SymbolType::OS          , "__os__"          },
-    { Core::SymbolType::ARCH        , "__arch__"        },
-};
-
-
-
-/**
- * @brief Map from canonical token string to SymbolType (e.g. "__main__" -> MAIN).
- */
-static std::map<std::string, Core::SymbolType> Known_Symbols_By_String =
-{
+static constexpr auto Known_Symbols_By_String = Support::make_keyword_map<Core::SymbolType, false>({
     { "__main__"        , Core::SymbolType::MAIN        },
     { "__root__"        , Core::SymbolType::ROOT        },
     { "__version__"     , Core::SymbolType::VERSION     },
@@ -91,37 +77,41 @@ static std::map<std::string, Core::SymbolType> Known_Symbols_By_String =
     { "__max_threads__" , Core::SymbolType::MAX_THREADS },
     { "__os__"          , Core::SymbolType::OS          },
     { "__arch__"        , Core::SymbolType::ARCH        },
-};
+});
+
+static_assert(Known_Symbols_By_String.valid(), "Known_Symbols_By_String: colliding keys");
 
 
 
 /**
- * @brief Supported OS names for `@ifos` and internal checks.
+ * @brief Supported OS names for `@ifos` and internal checks (compile-time set).
  */
-static std::vector<std::string> Known_OSs =
-{
-    "windows",
-    "macos",
-    "linux",
-    "freeBSD",
-    "unix",
-};
+static constexpr auto Known_OSs = Support::make_keyword_map<bool, false>({
+    { "windows" , true },
+    { "macos"   , true },
+    { "linux"   , true },
+    { "freeBSD" , true },
+    { "unix"    , true },
+});
+
+static_assert(Known_OSs.valid(), "Known_OSs: colliding keys");
 
 
 
 /**
- * @brief Supported architecture names for internal checks.
+ * @brief Supported architecture names for internal checks (compile-time set).
  */
-static std::vector<std::string> Known_ARCHs =
-{
-    "x86_64",
-    "x86",
-    "aarch64",
-    "arm",
-    "riscv",
-    "ppc64",
-    "ppc",
-};
+static constexpr auto Known_ARCHs = Support::make_keyword_map<bool, false>({
+    { "x86_64"  , true },
+    { "x86"     , true },
+    { "aarch64" , true },
+    { "arm"     , true },
+    { "riscv"   , true },
+    { "ppc64"   , true },
+    { "ppc"     , true },
+});
+
+static_assert(Known_ARCHs.valid(), "Known_ARCHs: colliding keys");
 
 
 
@@ -210,106 +200,142 @@ static Core::InstructionResult run_instruction(const std::string& jobname,
 
 
 /**
- * @brief Execute a job either linearly or by spawning a thread per instruction.
+ * @brief One instruction of a job, scheduled as a node of the action graph.
+ */
+struct Action
+{
+    std::uint32_t              job;        ///< Owning job index.
+    std::uint32_t              instr;      ///< Instruction index within the job.
+    std::uint32_t              pending;    ///< Unfinished dependencies (a barrier counts as one).
+    std::vector<std::uint32_t> successors; ///< Actions released when this one finishes.
+};
+
+
+
+/**
+ * @brief Action graph lowered from the job list.
  *
- * The decision is driven by `job.parallelizable`. In MT mode, results are stored by index.
+ * Action ids follow job order, so the smallest ready id is the one the old
+ * task-by-task execution would have run next.
+ */
+struct ActionGraph
+{
+    std::vector<Action>                     actions;   ///< Actions in job order.
+    std::vector<std::uint32_t>              remaining; ///< Unfinished actions per job.
+    std::vector<std::vector<std::uint32_t>> waiters;   ///< Actions waiting for a job to settle.
+};
+
+
+
+/**
+ * @brief Lower the job list into per-instruction actions.
  *
- * @param job Job to run.
- * @param opt Runtime options (stop-on-error, max parallelism, etc.).
- * @return Core::Result containing per-instruction results and summary status.
+ * Every action of a job depends, by default, on the previous job being settled
+ * (that job and all the ones before it finished), as in task-by-task execution.
+ * An instruction expanded from list element `i` instead depends only on the
+ * instructions of the previous job expanded from the same element (`map` chains
+ * share their root element), plus that job's instructions tied to no element;
+ * when no instruction shares its element it falls back to the barrier.
+ * Instructions of a job without `@multithread` are chained in order.
+ *
+ * @param jobs Jobs in execution order.
+ * @return The action graph.
  */
-static Core::Result run_job(const Jobs::Job& job, const Core::RunOptions& opt) noexcept
+static ActionGraph BuildActionGraph(const std::vector<Jobs::Job>& jobs) noexcept
 {
-    Core::Result result {};
+    using Key = std::pair<std::uintptr_t, std::size_t>;
 
-    // INIT RESULT HEADER
-    result.name        = job.name;
-    result.ok          = true;
-    result.first_error = 0;
+    ActionGraph                                g;
+    std::vector<std::pair<Key, std::uint32_t>> by_element;
+    std::vector<std::uint32_t>                 loose;
 
-    // LINEAR EXECUTION
-    if (!job.parallelizable)
+    auto has_elements = [] (const Jobs::Job& job) noexcept
     {
-        std::size_t idx = 0;
+        return job.expanded && job.elements.size() == job.instructions.size();
+    };
 
-        for (const auto& cmd : job.instructions)
-        {
-            // RUN INSTRUCTION AND STORE RESULT
-            auto r = run_instruction(job.name, idx, job.interpreter, cmd, job.echo);
-            result.results.push_back(r);
-
-            // HANDLE ERROR
-            if (r.exit_code != 0)
-            {
-                result.ok          = false;
-                result.first_error = r.exit_code;
+    auto key_of = [] (const Semantic::Task::Element& e) noexcept -> Key
+    {
+        return { reinterpret_cast<std::uintptr_t>(e.list), e.index };
+    };
 
-                if (opt.stop_on_error)
-                {
-                    break;
-                }
-            }
+    g.remaining.resize(jobs.size());
+    g.waiters.resize(jobs.size());
 
-            ++idx;
-        }
-    }
-    else
+    for (std::size_t j = 0; j < jobs.size(); ++j)
     {
-        // PARALLEL EXECUTION (THREAD PER INSTRUCTION, WITH BATCH JOIN)
-        std::vector<std::thread> threads;
-        std::mutex               mutex;
+        const auto&         job   = jobs[j];
+        const std::uint32_t first = static_cast<std::uint32_t>(g.actions.size());
+        const bool          keyed = has_elements(job);
 
-        result.results.resize(job.instructions.size());
+        g.remaining[j] = static_cast<std::uint32_t>(job.instructions.size());
 
-        // WORKER: RUN ONE INSTRUCTION AND WRITE RESULT SAFELY
-        auto worker = [&] (std::size_t idx)
+        for (std::size_t k = 0; k < job.instructions.size(); ++k)
         {
-            const auto& cmd = job.instructions[idx];
-            auto        r   = run_instruction(job.name, idx, job.interpreter, cmd, job.echo);
+            const std::uint32_t id = first + static_cast<std::uint32_t>(k);
+            g.actions.push_back( Action{ static_cast<std::uint32_t>(j), static_cast<std::uint32_t>(k), 0, {} } );
 
-            std::lock_guard<std::mutex> lock(mutex);
-            result.results[idx] = r;
-        };
+            // SEQUENTIAL JOBS RUN THEIR INSTRUCTIONS IN ORDER
+            if (!job.parallelizable && k > 0)
+            {
+                g.actions[id - 1].successors.push_back(id);
+                ++g.actions[id].pending;
+            }
 
-        // SPAWN THREADS UP TO MAX PARALLELISM
-        for (std::size_t i = 0; i < job.instructions.size(); ++i)
-        {
-            threads.emplace_back(worker, i);
+            if (j == 0)
+            {
+                continue;
+            }
 
-            if (threads.size() >= opt.max_parallelism)
+            // FILE-LEVEL EDGES: SAME ELEMENT IN THE PREVIOUS JOB
+            if (keyed && job.elements[k].list != nullptr && !by_element.empty())
             {
-                // JOIN CURRENT BATCH
-                for (auto& t : threads)
+                const Key  key   = key_of(job.elements[k]);
+                const auto range = std::equal_range(by_element.begin(), by_element.end(), std::make_pair(key, std::uint32_t{0}),
+                                                    [] (const auto& a, const auto& b) { return a.first < b.first; });
+
+                if (range.first != range.second)
                 {
-                    t.join();
+                    for (auto it = range.first; it != range.second; ++it)
+                    {
+                        g.actions[it->second].successors.push_back(id);
+                        ++g.actions[id].pending;
+                    }
+
+                    for (const auto dep : loose)
+                    {
+                        g.actions[dep].successors.push_back(id);
+                        ++g.actions[id].pending;
+                    }
+
+                    continue;
                 }
-
-                threads.clear();
             }
-        }
 
-        // JOIN REMAINING THREADS
-        for (auto& t : threads)
-        {
-            t.join();
+            // BARRIER: WAIT FOR THE PREVIOUS JOB TO SETTLE
+            g.waiters[j - 1].push_back(id);
+            ++g.actions[id].pending;
         }
 
-        // AGGREGATE ERRORS
-        for (const auto& r : result.results)
+        // INDEX THIS JOB FOR THE NEXT ONE
+        by_element.clear();
+        loose.clear();
+
+        if (keyed)
         {
-            if (r.exit_code != 0)
+            for (std::size_t k = 0; k < job.elements.size(); ++k)
             {
-                result.ok = false;
+                const std::uint32_t id = first + static_cast<std::uint32_t>(k);
 
-                if (result.first_error == 0)
-                {
-                    result.first_error = r.exit_code;
-                }
+                if (job.elements[k].list != nullptr) by_element.emplace_back(key_of(job.elements[k]), id);
+                else                                 loose.push_back(id);
             }
+
+            std::sort(by_element.begin(), by_element.end());
         }
     }
 
-    return result;
+    return g;
 }
 
 
@@ -319,9 +345,16 @@ static Core::Result run_job(const Jobs::Job& job, const Core::RunOptions& opt) n
 // ============================================================================
 
 /**
- * @brief Execute the job list in order and return the collected results.
+ * @brief Execute the job list as an action graph and return the collected results.
  *
- * Prints per-task progress and summary unless `opt.silent` is enabled.
+ * Ready actions are run by up to `opt.max_parallelism` workers, lowest id first.
+ * Each action costs its job weight against the thread budget and, for jobs in
+ * a resource pool, against the pool size. An action blocked by its pool is
+ * passed over; one blocked by the thread budget holds the queue so heavy actions
+ * are not starved, and an action heavier than a budget runs once it is empty.
+ * On failure with `opt.stop_on_error` no further action is started and the
+ * running ones are drained. Prints per-task progress and summary unless
+ * `opt.silent` is enabled.
  *
  * @param jobs Job list to execute.
  * @param opt Execution options.
@@ -332,27 +365,181 @@ Arcana_Result Core::run_jobs(const Jobs::List& jobs, const Core::RunOptions& opt
     Arcana_Result result = Arcana_Result::ARCANA_RESULT__OK;
     Stopwatch sw;
 
-    // START TIMER
-    sw.start();
+    const auto& all   = jobs.All();
+    ActionGraph graph = BuildActionGraph(all);
+
+    std::mutex                 mutex;
+    std::condition_variable    cv;
+    std::set<std::uint32_t>    ready;
+    std::vector<bool>          started(all.size(), false);
+    std::vector<bool>          settled(all.size(), false);
+    std::size_t                running = 0;
+    std::size_t                failed  = all.size();
+    bool                       stop    = false;
+
+    // RESOURCE BUDGETS: THREADS, THEN ONE SLOT PER POOL
+    constexpr std::size_t      NO_POOL  = static_cast<std::size_t>(-1);
+    const std::uint32_t        capacity = std::max(1u, opt.max_parallelism);
+    std::uint32_t              used     = 0;
+    std::vector<std::uint32_t> pool_size;
+    std::vector<std::uint32_t> pool_used;
+    std::vector<std::size_t>   job_pool(all.size(), NO_POOL);
+
+    for (std::size_t j = 0; j < all.size(); ++j)
+    {
+        if (auto it = opt.pools.find(all[j].pool); !all[j].pool.empty() && it != opt.pools.end())
+        {
+            job_pool[j] = static_cast<std::size_t>(std::distance(opt.pools.begin(), it));
+        }
+    }
+
+    for (const auto& [_, size] : opt.pools)
+    {
+        pool_size.push_back(size);
+        pool_used.push_back(0);
+    }
+
+    // RELEASE A SUCCESSOR WHOSE LAST DEPENDENCY JUST FINISHED
+    auto release = [&] (std::uint32_t id)
+    {
+        if (--graph.actions[id].pending == 0)
+        {
+            ready.insert(id);
+        }
+    };
+
+    // FIRST READY ACTION THE BUDGETS ADMIT, OR ready.end()
+    auto pick = [&] ()
+    {
+        for (auto it = ready.begin(); it != ready.end(); ++it)
+        {
+            const std::uint32_t job    = graph.actions[*it].job;
+            const std::uint32_t weight = std::max(1u, all[job].weight);
+            const std::size_t   pool   = job_pool[job];
+
+            if (pool != NO_POOL && pool_used[pool] != 0 && pool_used[pool] + weight > pool_size[pool])
+            {
+                continue;
+            }
+
+            if (used != 0 && used + weight > capacity)
+            {
+                break;
+            }
 
-    // RUN EACH JOB
-    for (auto& job : jobs.All())
+            return it;
+        }
+
+        return ready.end();
+    };
+
+    // SETTLE FINISHED JOBS IN ORDER, FREEING THEIR BARRIER WAITERS
+    auto settle = [&] (std::size_t j)
     {
-        if (!opt.silent)
+        for (; j < all.size() && graph.remaining[j] == 0 && (j == 0 || settled[j - 1]); ++j)
         {
-            ARC(ANSI_GRAY << "Running task: " << job.name << ANSI_RESET);
+            settled[j] = true;
+
+            for (const auto id : graph.waiters[j]) release(id);
         }
+    };
 
-        // RUN JOB AND COLLECT RESULT
-        auto r = run_job(job, opt);
+    auto worker = [&] ()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
 
-        // STOP EARLY ON ERROR IF REQUESTED
-        if (!r.ok && opt.stop_on_error)
+        for (;;)
         {
-            result = Arcana_Result::ARCANA_RESULT__NOK;
-            ERR(ANSI_GRAY << "Task failed: " << job.name << ANSI_RESET);
-            break;
+            auto next = ready.end();
+
+            cv.wait(lock, [&] { return stop || (next = pick()) != ready.end() || running == 0; });
+
+            if (stop || next == ready.end())
+            {
+                break;
+            }
+
+            const std::uint32_t id     = *next;
+            const Action&       act    = graph.actions[id];
+            const Jobs::Job&    job    = all[act.job];
+            const std::uint32_t weight = std::max(1u, job.weight);
+            const std::size_t   pool   = job_pool[act.job];
+
+            ready.erase(next);
+            ++running;
+
+            used += weight;
+            if (pool != NO_POOL) pool_used[pool] += weight;
+
+            if (!started[act.job])
+            {
+                started[act.job] = true;
+
+                if (!opt.silent)
+                {
+                    ARC(ANSI_GRAY << "Running task: " << job.name << ANSI_RESET);
+                }
+            }
+
+            // RUN INSTRUCTION OUTSIDE THE LOCK
+            lock.unlock();
+            auto r = run_instruction(job.name, act.instr, job.interpreter, job.instructions[act.instr], job.echo);
+            lock.lock();
+
+            --running;
+
+            used -= weight;
+            if (pool != NO_POOL) pool_used[pool] -= weight;
+
+            if (r.exit_code != 0)
+            {
+                if (failed == all.size()) failed = act.job;
+                if (opt.stop_on_error)    stop   = true;
+            }
+
+            for (const auto succ : act.successors) release(succ);
+
+            --graph.remaining[act.job];
+            settle(act.job);
+
+            cv.notify_all();
         }
+
+        cv.notify_all();
+    };
+
+    // START TIMER
+    sw.start();
+
+    // SEED READY ACTIONS AND SETTLE LEADING EMPTY JOBS
+    for (std::uint32_t id = 0; id < graph.actions.size(); ++id)
+    {
+        if (graph.actions[id].pending == 0) ready.insert(id);
+    }
+
+    settle(0);
+
+    // RUN THE GRAPH: THE CALLING THREAD IS ONE OF THE WORKERS
+    const std::size_t        workers = std::max<std::size_t>(1, std::min<std::size_t>(opt.max_parallelism, graph.actions.size()));
+    std::vector<std::thread> threads;
+
+    for (std::size_t i = 1; i < workers; ++i)
+    {
+        threads.emplace_back(worker);
+    }
+
+    worker();
+
+    for (auto& t : threads)
+    {
+        t.join();
+    }
+
+    // STOP EARLY ON ERROR IF REQUESTED
+    if (failed < all.size() && opt.stop_on_error)
+    {
+        result = Arcana_Result::ARCANA_RESULT__NOK;
+        ERR(ANSI_GRAY << "Task failed: " << all[failed].name << ANSI_RESET);
     }
 
     // STOP TIMER
@@ -377,11 +564,7 @@ Arcana_Result Core::run_jobs(const Jobs::List& jobs, const Core::RunOptions& opt
  */
 std::string& Core::symbol(Core::SymbolType type) noexcept
 {
-    // MAP TYPE TO TOKEN STRING
-    const std::string symbol = Known_Symbols_By_Token[type];
-
-    // RETURN STORED VALUE
-    return builtin_symbols[symbol];
+    return builtin_symbols[_I(type)];
 }
 
 
@@ -391,17 +574,11 @@ std::string& Core::symbol(Core::SymbolType type) noexcept
  * @param symbol Token string (e.g. "__main__").
  * @return SymbolType or UNDEFINED.
  */
-Core::SymbolType Core::is_symbol(const std::string& symbol) noexcept
+Core::SymbolType Core::is_symbol(std::string_view symbol) noexcept
 {
-    Core::SymbolType type = Core::SymbolType::UNDEFINED;
+    const auto* type = Known_Symbols_By_String.find(symbol);
 
-    // LOOKUP TOKEN STRING
-    if (auto it = Known_Symbols_By_String.find(symbol); it != Known_Symbols_By_String.end())
-    {
-        type = it->second;
-    }
-
-    return type;
+    return type ? *type : Core::SymbolType::UNDEFINED;
 }
 
 
@@ -413,11 +590,7 @@ Core::SymbolType Core::is_symbol(const std::string& symbol) noexcept
  */
 void Core::update_symbol(Core::SymbolType type, const std::string& val) noexcept
 {
-    // MAP TYPE TO TOKEN STRING
-    const std::string symbol = Known_Symbols_By_Token[type];
-
-    // UPDATE STORED VALUE
-    builtin_symbols[symbol] = val;
+    builtin_symbols[_I(type)] = val;
 
     return;
 }
@@ -431,10 +604,7 @@ void Core::update_symbol(Core::SymbolType type, const std::string& val) noexcept
  */
 bool Core::is_symbol_set(Core::SymbolType type) noexcept
 {
-    // MAP TYPE TO TOKEN STRING
-    const std::string symbol = Known_Symbols_By_Token[type];
-
-    return (builtin_symbols[symbol] != "None");
+    return (builtin_symbols[_I(type)] != "None");
 }
 
 
@@ -444,10 +614,9 @@ bool Core::is_symbol_set(Core::SymbolType type) noexcept
  * @param param OS name.
  * @return True if supported.
  */
-bool Core::is_os(const std::string& param) noexcept
+bool Core::is_os(std::string_view param) noexcept
 {
-    // LINEAR SEARCH IN KNOWN OS LIST
-    return (std::find(Known_OSs.begin(), Known_OSs.end(), param) != Known_OSs.end());
+    return Known_OSs.find(param) != nullptr;
 }
 
 
@@ -457,8 +626,7 @@ bool Core::is_os(const std::string& param) noexcept
  * @param param Arch name.
  * @return True if supported.
  */
-bool Core::is_arch(const std::string& param) noexcept
+bool Core::is_arch(std::string_view param) noexcept
 {
-    // LINEAR SEARCH IN KNOWN ARCH LIST
-    return (std::find(Known_ARCHs.begin(), Known_ARCHs.end(), param) != Known_ARCHs.end());
+    return Known_ARCHs.find(param) != nullptr;
 }
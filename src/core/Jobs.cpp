@@ -1,9 +1,11 @@
 #include "Jobs.h"
 #include "Cache.h"
-#include "TableHelper.h"
 
+#include <array>
+#include <cstdint>
+#include <charconv>
+#include <algorithm>
 #include <string_view>
-#include <unordered_map>
 
 USE_MODULE(Arcana::Jobs);
 
@@ -47,7 +49,43 @@ struct TopoResult
 };
 
 
-using Graph = std::unordered_map<std::string, std::array<std::vector<std::string>, 2>>;
+/**
+ * @brief Task collected by the traversal, in execution order.
+ */
+struct Visit
+{
+    std::uint32_t id;       ///< Visited task id.
+    bool          prunable; ///< Whether unchanged instructions may be pruned.
+};
+
+
+/**
+ * @brief Task graph over dense ids, adjacency in compressed sparse row form.
+ *
+ * Ids follow FTable (key) order. For edge kind `k` (0: REQUIRES, 1: THEN) the
+ * targets of task `i` are `targets[k][offsets[k][i] .. offsets[k][i + 1])`.
+ * A target missing from the table gets an id past the tasks, naming `unknown`.
+ */
+struct Graph
+{
+    static constexpr std::uint32_t NONE = UINT32_MAX;
+
+    std::vector<Semantic::InstructionTask*>   tasks;   ///< Id -> task.
+    std::vector<std::string_view>             names;   ///< Id -> table key (sorted).
+    std::array<std::vector<std::uint32_t>, 2> offsets; ///< Per kind, row starts (size tasks + 1).
+    std::array<std::vector<std::uint32_t>, 2> targets; ///< Per kind, edge targets.
+    std::vector<std::string_view>             unknown; ///< Names of targets missing from the table.
+
+    /**
+     * @brief Task id of a table key, or NONE.
+     */
+    std::uint32_t Find(std::string_view name) const noexcept
+    {
+        auto it = std::lower_bound(names.begin(), names.end(), name);
+
+        return (it != names.end() && *it == name) ? static_cast<std::uint32_t>(it - names.begin()) : NONE;
+    }
+};
 
 
 
@@ -90,10 +128,14 @@ static void PruneUnchangedInstructions(Jobs::Job& job, const Semantic::Instructi
     bool never_found = true; 
     bool any_changes = false;
 
+    // FILES ARE HANDLED BY ID, THEIR PATH HASH IS COMPUTED ONCE PER PROCESS
+    auto& paths = Cache::PathTable::Instance();
+
     // MAP FILE -> INSTRUCTION DEPENDENCY AND PRUNE IF UNCHANGED
-    auto process_file = [&] (const std::string& file)
+    auto process_file = [&] (const Cache::PathTable::Id id)
     {       
-        const bool changed = Cache::Manager::Instance().HasFileChanged(file);
+        const std::string& file    = paths.Path(id);
+        const bool         changed = Cache::Manager::Instance().HasFileChanged(id);
 
         if (changed) any_changes = true;
         
@@ -123,20 +165,30 @@ static void PruneUnchangedInstructions(Jobs::Job& job, const Semantic::Instructi
     {
         for (auto& file : task.cache.data)
         {
-            process_file(file);
+            process_file(paths.Intern(file));
         }
     }
     else if (task.cache.type == Semantic::InstructionTask::Cache::Type::UNTRACK)
     {
-        Arcana::Cache::Manager::Instance().ClearCache(task.cache.data);
+        std::vector<Cache::PathTable::Id> ids;
+        ids.reserve(task.cache.data.size());
+
+        for (auto& file : task.cache.data)
+        {
+            ids.push_back(paths.Intern(file));
+        }
+
+        Arcana::Cache::Manager::Instance().ClearCache(ids);
     }
     else
     {
         for (auto& file : task.cache.data)
         {
-            process_file(file);
+            const Cache::PathTable::Id id = paths.Intern(file);
+
+            process_file(id);
 
-            Arcana::Cache::Manager::Instance().Store(file);
+            Arcana::Cache::Manager::Instance().Store(id);
         }
     }
     
@@ -144,11 +196,14 @@ static void PruneUnchangedInstructions(Jobs::Job& job, const Semantic::Instructi
     if (never_found && !any_changes && task.cache.type != Semantic::InstructionTask::Cache::Type::UNTRACK)
     {
         job.instructions.clear();
+        job.elements.clear();
     }
     else if (!never_found)
     {
         // REBUILD INSTRUCTION LIST WITH KEPT ITEMS ONLY
-        Semantic::Task::Instrs filtered;
+        const bool               has_elements = (job.elements.size() == job.instructions.size());
+        Semantic::Task::Instrs   filtered;
+        Semantic::Task::Elements filtered_elements;
         filtered.reserve(job.instructions.size());
     
         for (std::size_t i = 0; i < job.instructions.size(); ++i)
@@ -156,11 +211,14 @@ static void PruneUnchangedInstructions(Jobs::Job& job, const Semantic::Instructi
             if (keep[i])
             {
                 filtered.emplace_back(std::move(job.instructions[i]));
+
+                if (has_elements) filtered_elements.push_back(job.elements[i]);
             }
         }
     
         // SWAP FILTERED INSTRUCTIONS BACK
         job.instructions.swap(filtered);
+        job.elements.swap(filtered_elements);
     }
 }
 
@@ -172,11 +230,13 @@ static void PruneUnchangedInstructions(Jobs::Job& job, const Semantic::Instructi
  * This function expands task instructions, prunes unchanged ones based on inputs,
  * and applies per-task execution flags (multithread, echo, flushcache).
  *
- * @param task Semantic task description.
+ * @param task     Semantic task description.
+ * @param prunable Whether unchanged instructions may be pruned.
+ * @param consume  Move the task instructions into the job instead of copying them.
  * @return Pair (ExpansionError, optional Job). If expansion fails, Job is nullopt.
  */
 static std::optional<Job>
-FromInstruction(const Semantic::InstructionTask& task, bool prunable = true) noexcept
+FromInstruction(Semantic::InstructionTask& task, bool prunable = true, bool consume = false) noexcept
 {
     Job new_job {};
 
@@ -206,7 +266,17 @@ FromInstruction(const Semantic::InstructionTask& task, bool prunable = true) noe
 
     if (task.expanded)
     {
-        new_job.instructions = std::move(task.task_instrs);
+        if (consume)
+        {
+            new_job.instructions = std::move(task.task_instrs);
+            new_job.elements     = std::move(task.task_elements);
+        }
+        else
+        {
+            new_job.instructions = task.task_instrs;
+            new_job.elements     = task.task_elements;
+        }
+
         new_job.expanded = true;
     }
     else 
@@ -229,6 +299,19 @@ FromInstruction(const Semantic::InstructionTask& task, bool prunable = true) noe
     // APPLY EXECUTION ATTRIBUTES
     new_job.parallelizable = task.hasAttribute(Semantic::Attr::Type::MULTITHREAD);
     new_job.echo           = task.hasAttribute(Semantic::Attr::Type::ECHO);
+    new_job.weight         = 1;
+
+    // RESOURCE POOL AND WEIGHT (VALIDATED BY THE SEMANTIC ENGINE)
+    if (task.hasAttribute(Semantic::Attr::Type::POOL))
+    {
+        new_job.pool = task.getProperties(Semantic::Attr::Type::POOL).at(0);
+    }
+
+    if (task.hasAttribute(Semantic::Attr::Type::WEIGHT))
+    {
+        const auto& weight = task.getProperties(Semantic::Attr::Type::WEIGHT).at(0);
+        std::from_chars(weight.data(), weight.data() + weight.size(), new_job.weight);
+    }
 
     return new_job;
 }
@@ -236,46 +319,56 @@ FromInstruction(const Semantic::InstructionTask& task, bool prunable = true) noe
 
 
 /**
- * @brief Build a graph representation of task dependencies and successors.
+ * @brief Build the task graph of dependencies and successors.
  *
- * The graph node stores two adjacency lists:
- * - index 0: dependencies (REQUIRES)
- * - index 1: successors   (THEN)
+ * Ids are assigned in table order, then each kind of edge is laid out row by row:
+ * - kind 0: dependencies (REQUIRES)
+ * - kind 1: successors   (THEN)
  *
  * @param table Task table.
- * @return Graph keyed by task name.
+ * @return CSR graph over dense task ids.
  */
-static Graph BuildGraph(const Semantic::FTable& table)
+static Graph BuildGraph(Semantic::FTable& table)
 {
     Graph g;
 
-    // BUILD GRAPH NODES
-    for (const auto& [name, task] : table)
+    // ASSIGN DENSE IDS IN TABLE ORDER
+    g.tasks.reserve(table.size());
+    g.names.reserve(table.size());
+
+    for (auto& [name, task] : table)
     {
-        // INIT BOTH SIDES
-        g[name][0] = {};
-        g[name][1] = {};
+        g.tasks.push_back(&task);
+        g.names.push_back(name);
+    }
 
-        // DEPENDENCIES: dep -> task
-        if (task.hasAttribute(Semantic::Attr::Type::REQUIRES))
-        {
-            auto& deps = task.getProperties(Semantic::Attr::Type::REQUIRES);
+    // LAY OUT ROWS: DEPENDENCIES (dep -> task), THEN SUCCESSORS (task -> succ)
+    const std::array<Semantic::Attr::Type, 2> kinds = { Semantic::Attr::Type::REQUIRES, Semantic::Attr::Type::THEN };
 
-            for (const auto& dep_name : deps)
-            {
-                g[name][0].push_back(dep_name);
-            }
-        }
+    for (std::size_t k = 0; k < kinds.size(); ++k)
+    {
+        auto& offsets = g.offsets[k];
+        auto& targets = g.targets[k];
 
-        // SUCCESSORS: task -> succ
-        if (task.hasAttribute(Semantic::Attr::Type::THEN))
-        {
-            auto& succs = task.getProperties(Semantic::Attr::Type::THEN);
+        offsets.reserve(g.tasks.size() + 1);
+        offsets.push_back(0);
 
-            for (const auto& succ_name : succs)
+        for (const auto* task : g.tasks)
+        {
+            for (const auto& target : task->getProperties(kinds[k]))
             {
-                g[name][1].push_back(succ_name);
+                std::uint32_t id = g.Find(target);
+
+                if (id == Graph::NONE)
+                {
+                    id = static_cast<std::uint32_t>(g.tasks.size() + g.unknown.size());
+                    g.unknown.push_back(target);
+                }
+
+                targets.push_back(id);
             }
+
+            offsets.push_back(static_cast<std::uint32_t>(targets.size()));
         }
     }
 
@@ -285,108 +378,117 @@ static Graph BuildGraph(const Semantic::FTable& table)
 
 
 /**
- * @brief DFS visit used to build an ordered job list starting from a root task.
+ * @brief DFS visit used to build an ordered task list starting from a root task.
  *
  * The visit:
  * - checks task existence,
  * - detects cycles via TEMP/PERM marks,
  * - visits dependencies first, then collects node, then visits successors.
  *
- * @param name Current task name.
- * @param table Task table.
- * @param vtable Variable table used by expansion.
+ * It runs on an explicit stack, so arbitrarily deep chains cannot overflow.
+ *
+ * @param root Root task id (Graph::NONE or an unknown id when the name is missing).
+ * @param name Root task name, for diagnostics.
  * @param graph Dependency/successor graph.
- * @param mark DFS marks.
- * @param out Output ordered jobs.
- * @param err Output expansion error.
+ * @param mark DFS marks, indexed by task id.
+ * @param out Output ordered tasks.
+ * @param err Output error.
+ * @param prunable Whether collected tasks may prune unchanged instructions.
  * @return True on success, false on error.
  */
-static bool dfs_visit(const std::string&                name,
-                      const Semantic::FTable&           table,
-                      const Graph&                      graph,
-                      std::map<std::string, VisitMark>& mark,
-                      std::vector<Job>&                 out,
+static bool dfs_visit(std::uint32_t                root,
+                      std::string_view             name,
+                      const Graph&                 graph,
+                      std::vector<VisitMark>&      mark,
+                      std::vector<Visit>&          out,
                       std::string& err,
                       bool prunable = true) noexcept
 {
-    // COLLECT CURRENT NODE INTO OUT VECTOR
-    auto collect_node = [&] (Arcana::Semantic::FTable::const_iterator& tit, bool pruning) noexcept -> void
+    struct Frame
     {
-        const Semantic::InstructionTask& t = tit->second;
-        const auto& result = FromInstruction(t, pruning);
+        std::uint32_t id;   ///< Task being visited.
+        std::uint32_t kind; ///< Edge kind being walked (0: deps, 1: successors).
+        std::uint32_t next; ///< Next edge slot of that kind.
+    };
 
-        if (result.has_value())
+    std::vector<Frame> stack;
+
+    // ENTER A NODE: FALSE ON ERROR, PUSHES A FRAME WHEN IT STILL NEEDS A VISIT
+    auto enter = [&] (std::uint32_t id, std::string_view id_name) noexcept -> bool
+    {
+        // CHECK TASK EXISTENCE
+        if (id >= graph.tasks.size())
         {
-            out.push_back(result.value());
+            std::stringstream ss;
+            ss << "Unknown task '" << ANSI_BMAGENTA << id_name << ANSI_RESET << "'";
+            err = ss.str();
+            return false;
         }
 
-        return ;
-    };
+        // ALREADY VISITED
+        if (mark[id] == VisitMark::PERM)
+        {
+            return true;
+        }
 
-    std::stringstream ss;
+        // CYCLE DETECTED
+        if (mark[id] == VisitMark::TEMP)
+        {
+            std::stringstream ss;
+            ss << "Cyclic dependency involving task '" << ANSI_BMAGENTA << id_name << ANSI_RESET << "'";
+            err = ss.str();
+            return false;
+        }
 
-    // CHECK TASK EXISTENCE
-    auto tit = table.find(name);
+        // MARK AS IN-PROGRESS
+        mark[id] = VisitMark::TEMP;
+        stack.push_back({ id, 0, graph.offsets[0][id] });
 
-    if (tit == table.end())
-    {
-        ss << "Unknown task '" << ANSI_BMAGENTA << name << ANSI_RESET << "'";
-        err = ss.str();
-        return false;
-    }
-
-    // FETCH MARK
-    VisitMark& m = mark[name];
+        return true;
+    };
 
-    // ALREADY VISITED
-    if (m == VisitMark::PERM)
+    auto target_name = [&] (std::uint32_t id) noexcept -> std::string_view
     {
-        return true;
-    }
+        return id < graph.tasks.size() ? graph.names[id] : graph.unknown[id - graph.tasks.size()];
+    };
 
-    // CYCLE DETECTED
-    if (m == VisitMark::TEMP)
+    if (!enter(root, name))
     {
-        ss << "Cyclic dependency involving task '" << ANSI_BMAGENTA << name << ANSI_RESET << "'";
-        err = ss.str();
         return false;
     }
 
-    // MARK AS IN-PROGRESS
-    m = VisitMark::TEMP;
-
-    // VISIT ADJACENCY LISTS
-    auto git = graph.find(name);
-
-    if (git != graph.end())
+    while (!stack.empty())
     {
-        // VISIT DEPENDENCIES FIRST
-        for (const auto& succ : git->second[0])
+        Frame& f = stack.back();
+
+        // VISIT NEXT ADJACENT NODE OF THE CURRENT KIND
+        if (f.next < graph.offsets[f.kind][f.id + 1])
         {
-            if (!dfs_visit(succ, table, graph, mark, out, err, prunable))
+            const std::uint32_t target = graph.targets[f.kind][f.next++];
+
+            if (!enter(target, target_name(target)))
             {
                 return false;
             }
-        }
 
-        // COLLECT CURRENT NODE
-        collect_node(tit, prunable);
+            continue;
+        }
 
-        // VISIT SUCCESSORS
-        for (const auto& succ : git->second[1])
+        // DEPENDENCIES DONE: COLLECT CURRENT NODE, THEN VISIT SUCCESSORS
+        if (f.kind == 0)
         {
-            if (!dfs_visit(succ, table, graph, mark, out, err, prunable))
-            {
-                return false;
-            }
+            out.push_back({ f.id, prunable });
+
+            f.kind = 1;
+            f.next = graph.offsets[1][f.id];
+            continue;
         }
-    }
 
-    // MARK AS DONE
-    m = VisitMark::PERM;
+        // MARK AS DONE
+        mark[f.id] = VisitMark::PERM;
+        stack.pop_back();
+    }
 
-    // FINAL COLLECT (KEEP ORIGINAL BEHAVIOR)
-    // collect_node(tit, prunable);
     return true;
 }
 
@@ -400,15 +502,15 @@ static bool dfs_visit(const std::string&                name,
  * @brief Insert a job if present and not already in the list.
  * @param j Optional job.
  */
-void List::Insert(const std::optional<Job>& j)
+void List::Insert(std::optional<Job>&& j)
 {
     if (j)
     {
-        auto [it, inserted] = index.insert(j.value().name);
+        auto [it, inserted] = index.insert(j->name);
 
         if (inserted)
         {
-            data.push_back(j.value());
+            data.push_back(std::move(*j));
         }
     }
 }
@@ -421,77 +523,75 @@ void List::Insert(const std::optional<Job>& j)
  * The list is built by:
  * - building a graph from the task table,
  * - DFS visiting starting from the MAIN task (if present),
- * - inserting ALWAYS tasks afterwards.
+ * - inserting ALWAYS tasks afterwards,
+ * - turning the collected tasks into jobs, once per task (its first visit takes the instructions).
  *
  * @param environment Semantic environment containing tables and expansions.
  * @param out Output job list.
+ * @param consume Move task instructions out of the environment into the jobs.
  * @return ARCANA_RESULT__OK on success, otherwise a failure code.
  */
-Arcana_Result List::FromEnv(Semantic::Enviroment& environment, List& out, std::vector<std::string>& recovery) noexcept
+Arcana_Result List::FromEnv(Semantic::Enviroment& environment, List& out, std::vector<std::string>& recovery, bool consume) noexcept
 {
     // BUILD GRAPH FROM FTABLE
-    Graph graph = BuildGraph(environment.ftable);
+    const Graph        graph = BuildGraph(environment.ftable);
+    std::vector<Visit> plan;
 
     for (const auto& task_name : recovery)
     {
-        std::string                      err;
-        std::vector<Job>                 ordered;
-        std::map<std::string, VisitMark> mark;
+        std::string            err;
+        std::vector<VisitMark> mark(graph.tasks.size(), VisitMark::NONE);
 
         // DFS VISIT ROOT
-        if (!dfs_visit(task_name, environment.ftable, graph, mark, ordered, err, false))
+        if (!dfs_visit(graph.Find(task_name), task_name, graph, mark, plan, err, false))
         {
             ERR(err);
             return Arcana_Result::ARCANA_RESULT__NOK;
         }
-
-        // INSERT ORDERED JOBS
-        for (const Job& j : ordered)
-        {
-            out.Insert(j);
-        }
     }
 
     // START FROM MAIN TASK
-    if (auto main_task_opt = Table::GetValue(environment.ftable, Semantic::Attr::Type::MAIN))
+    if (const auto& main_tasks = environment.TasksWith(Semantic::Attr::Type::MAIN); !main_tasks.empty())
     {
-        const auto&       main_task = main_task_opt.value();
-        const std::string main_name = main_task.get().task_name;
+        const std::string main_name = main_tasks.front()->task_name;
 
-        std::string                      err;
-        std::vector<Job>                 ordered;
-        std::map<std::string, VisitMark> mark;
+        std::string            err;
+        std::vector<VisitMark> mark(graph.tasks.size(), VisitMark::NONE);
 
         // DFS VISIT ROOT
-        if (!dfs_visit(main_name, environment.ftable, graph, mark, ordered, err))
+        if (!dfs_visit(graph.Find(main_name), main_name, graph, mark, plan, err))
         {
             ERR(err);
             return Arcana_Result::ARCANA_RESULT__NOK;
         }
 
-        // INSERT ORDERED JOBS
-        for (const Job& j : ordered)
-        {
-            out.Insert(j);
-        }
-
         out.main_job = main_name;
     }
 
     // COLLECT ALWAYS TASKS
-    if (auto always_opt = Table::GetValues(environment.ftable, Semantic::Attr::Type::ALWAYS))
+    for (std::uint32_t id = 0; id < graph.tasks.size(); ++id)
     {
-        for (const auto& task : always_opt.value())
+        if (graph.tasks[id]->hasAttribute(Semantic::Attr::Type::ALWAYS))
         {
-            const auto& result = FromInstruction(task);
+            plan.push_back({ id, true });
+        }
+    }
 
-            if (result.has_value())
-            {
-                out.Insert(result.value());
-            }
+    // A TASK MAY BE VISITED FROM SEVERAL ROOTS: THE LIST KEEPS ITS FIRST VISIT, WHICH TAKES THE INSTRUCTIONS
+    std::vector<bool> planned(graph.tasks.size(), false);
+
+    // INSERT ORDERED JOBS
+    for (const auto& visit : plan)
+    {
+        if (planned[visit.id])
+        {
+            continue;
         }
+
+        planned[visit.id] = true;
+
+        out.Insert(FromInstruction(*graph.tasks[visit.id], visit.prunable, consume));
     }
 
     return Arcana_Result::ARCANA_RESULT__OK;
 }
- 
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "Cache.h"
+#include "Core.h"
 
 #include <cstdint>
 #include <cstring>
@@ -6,7 +7,9 @@
 #include <sstream>
 #include <iomanip>
 #include <fstream>
+#include <algorithm>
 #include <functional>
+#include <unordered_map>
 
 USE_MODULE(Arcana::Cache);
 
@@ -147,6 +150,24 @@ inline bool remove_file(const fs::path& p) noexcept
     return fs::remove(p, ec);
 }
 
+/**
+ * @brief Remove the regular files of a directory (non-recursive) whose name is not kept.
+ * @param dir  Directory to scan.
+ * @param keep File names to keep.
+ */
+inline void remove_files_except(const fs::path& dir, const std::unordered_set<std::string>& keep) noexcept
+{
+    std::error_code ec;
+
+    for (const auto& entry : fs::directory_iterator(dir, ec))
+    {
+        if (entry.is_regular_file(ec) && !keep.count(entry.path().filename().string()))
+        {
+            fs::remove(entry.path(), ec);
+        }
+    }
+}
+
 /**
  * @brief Remove a directory recursively.
  * @param p Directory path.
@@ -559,6 +580,125 @@ std::string Cache::MD5_bin(const std::string& data) noexcept
 }
 
 
+namespace
+{
+    /// Snapshot file signature.
+    constexpr std::string_view SNAPSHOT_MAGIC   = "ARCENV";
+
+    /// Snapshot layout version, bump on any change of the encoded structures.
+    constexpr std::uint32_t    SNAPSHOT_VERSION = 2;
+
+    /**
+     * @brief Append-only little helper used to encode snapshots.
+     *
+     * Integers are stored in host byte order: snapshots never leave the
+     * machine (and OS) that produced them.
+     */
+    struct SnapshotWriter
+    {
+        std::string& out;
+
+        void u8 (std::uint8_t  v) { out.push_back(static_cast<char>(v)); }
+        void u32(std::uint32_t v) { out.append(reinterpret_cast<const char*>(&v), sizeof(v)); }
+        void u64(std::uint64_t v) { out.append(reinterpret_cast<const char*>(&v), sizeof(v)); }
+
+        void str(std::string_view v)
+        {
+            u32(static_cast<std::uint32_t>(v.size()));
+            out.append(v.data(), v.size());
+        }
+
+        void strs(const std::vector<std::string>& v)
+        {
+            u32(static_cast<std::uint32_t>(v.size()));
+            for (const auto& s : v) str(s);
+        }
+    };
+
+    /**
+     * @brief Bounds-checked cursor used to decode snapshots.
+     *
+     * Any read past the end clears `ok` and yields zero values, so decoding
+     * code can run straight through and check `ok` once at the end.
+     */
+    struct SnapshotReader
+    {
+        std::string_view in;
+        bool             ok = true;
+
+        bool take(void* dst, std::size_t size)
+        {
+            if (!ok || in.size() < size) { ok = false; return false; }
+
+            std::memcpy(dst, in.data(), size);
+            in.remove_prefix(size);
+            return true;
+        }
+
+        std::uint8_t  u8 () { std::uint8_t  v = 0; take(&v, sizeof(v)); return v; }
+        std::uint32_t u32() { std::uint32_t v = 0; take(&v, sizeof(v)); return v; }
+        std::uint64_t u64() { std::uint64_t v = 0; take(&v, sizeof(v)); return v; }
+
+        std::string str()
+        {
+            const std::uint32_t size = u32();
+
+            if (!ok || in.size() < size) { ok = false; return {}; }
+
+            std::string v(in.data(), size);
+            in.remove_prefix(size);
+            return v;
+        }
+
+        std::vector<std::string> strs()
+        {
+            std::vector<std::string> v(ok ? std::min<std::size_t>(u32(), in.size()) : 0);
+            for (auto& s : v) s = str();
+            return v;
+        }
+    };
+
+    /**
+     * @brief Encode an attribute list.
+     */
+    void put_attributes(SnapshotWriter& w, const Semantic::Attr::List& attributes)
+    {
+        w.u32(static_cast<std::uint32_t>(attributes.size()));
+
+        for (const auto& attr : attributes)
+        {
+            w.str (attr.name);
+            w.u32 (static_cast<std::uint32_t>(attr.type));
+            w.strs(attr.props);
+        }
+    }
+
+    /**
+     * @brief Decode an attribute list.
+     */
+    Semantic::Attr::List get_attributes(SnapshotReader& r)
+    {
+        Semantic::Attr::List attributes(std::min<std::size_t>(r.u32(), r.in.size()));
+
+        for (auto& attr : attributes)
+        {
+            attr.name  = r.str();
+            attr.type  = static_cast<Semantic::Attr::Type>(r.u32());
+            attr.props = r.strs();
+
+            // REJECT TYPES OUTSIDE THE ATTRIBUTE BITSET
+            if (_I(attr.type) >= _I(Semantic::Attr::Type::ATTRIBUTE__COUNT))
+            {
+                r.ok      = false;
+                attr.type = Semantic::Attr::Type::ATTRIBUTE__UNKNOWN;
+            }
+        }
+
+        return attributes;
+    }
+}
+
+
 
 //     ██████╗ █████╗  ██████╗██╗  ██╗███████╗
 //    ██╔════╝██╔══██╗██╔════╝██║  ██║██╔════╝
@@ -568,6 +708,59 @@ std::string Cache::MD5_bin(const std::string& data) noexcept
 //     ╚═════╝╚═╝  ╚═╝ ╚═════╝╚═╝  ╚═╝╚══════╝
 //                                            
 
+/**
+ * @brief Intern a path, hashing it on first use.
+ * @param path File path.
+ * @return Dense id of the path.
+ */
+PathTable::Id PathTable::Intern(std::string_view path) noexcept
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (auto it = _ids.find(path); it != _ids.end())
+    {
+        return it->second;
+    }
+
+    const Id    id    = static_cast<Id>(_entries.size());
+    std::string owned (path);
+    std::string key   = MD5_bin(owned);
+
+    // DEQUE KEEPS THE STRING ADDRESS STABLE FOR THE VIEW KEY
+    _entries.push_back({ std::move(owned), std::move(key) });
+    _ids.emplace(_entries.back().path, id);
+
+    return id;
+}
+
+
+
+/**
+ * @brief Get the path interned under an id.
+ * @param id Path id.
+ * @return Interned path.
+ */
+const std::string& PathTable::Path(Id id) const noexcept
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _entries[id].path;
+}
+
+
+
+/**
+ * @brief Get the binary MD5 of the path interned under an id.
+ * @param id Path id.
+ * @return 16 raw bytes inside a std::string.
+ */
+const std::string& PathTable::Key(Id id) const noexcept
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _entries[id].key;
+}
+
+
+
 /**
  * @brief Construct cache manager with default cache paths.
  */
@@ -576,15 +769,55 @@ Manager::Manager()
     _cache_folder(".arcana"),
     _script_path(_P(_cache_folder) / _P("script")),
     _binary(_P(_cache_folder)),
+    _glob_path(_P(_cache_folder) / _P("glob")),
+    _rsp_path(_P(_cache_folder) / _P("rsp")),
+    _env_path(_P(_cache_folder) / _P("env")),
     _store_idx(0),
-    _cached_profile("")
+    _cached_profile(""),
+    _hash_stop(false)
 {
+    // THE PATH TABLE MUST OUTLIVE THE HASH WORKERS: CONSTRUCTED FIRST, DESTROYED LAST
+    PathTable::Instance();
+
     if (!dir_exists(_cache_folder))
     {
         create_dir(_cache_folder);
     }
 }
 
+/**
+ * @brief Stop prefetch workers on shutdown.
+ */
+Manager::~Manager()
+{
+    StopHashers();
+}
+
+
+
+/**
+ * @brief Stop prefetch workers, dropping paths nobody asked for yet.
+ *
+ * Digest() keeps working afterwards, hashing on the calling thread.
+ */
+void Manager::StopHashers() noexcept
+{
+    {
+        std::lock_guard<std::mutex> lock(_hash_mutex);
+        _hash_stop = true;
+        _hash_queue.clear();
+    }
+
+    _hash_cv.notify_all();
+
+    for (auto& t : _hashers)
+    {
+        t.join();
+    }
+
+    _hashers.clear();
+}
+
 void Manager::Freeze() noexcept
 {
     uint64_t pos = CacheType::CT__PROFILE;
@@ -606,7 +839,7 @@ void Manager::Freeze() noexcept
 }
 
 
-void Manager::Store(const std::string& key) noexcept
+void Manager::Store(PathTable::Id file) noexcept
 {
     if (_store_idx == 0)
     {
@@ -615,7 +848,7 @@ void Manager::Store(const std::string& key) noexcept
         _store_idx += 16;
     }
 
-    const std::string md5_file = MD5_bin(key);
+    const std::string& md5_file = PathTable::Instance().Key(file);
 
     _mnt_binary.write_exact(_store_idx, md5_file.data() , 16);
     _store_idx += 16;
@@ -646,12 +879,12 @@ void Manager::EraseCache() noexcept
  *
  * Then it reloads the cache state from disk.
  */
-void Manager::ClearCache(const std::vector<std::string>& keys) noexcept
+void Manager::ClearCache(const std::vector<PathTable::Id>& files) noexcept
 {
-    for (const auto& key : keys)
+    for (const auto file : files)
     {
-        const std::string md5_file = MD5_bin(key);
-        const auto it              = _cached_files.find(md5_file);
+        const std::string& md5_file = PathTable::Instance().Key(file);
+        const auto         it       = _cached_files.find(md5_file);
 
         if (it != _cached_files.end())
         {
@@ -708,16 +941,16 @@ void Manager::LoadCache(const std::string& profile) noexcept
 /**
  * @brief Check if a file changed since last cache snapshot.
  *
- * The file path string is hashed to form the key filename inside input cache.
+ * The interned path hash is the key inside the input cache.
  * The file content MD5 is stored as cache value for that key.
  *
- * @param path File path (string).
+ * @param file Interned file path.
  * @return True if the file is new or changed, false otherwise.
  */
-bool Manager::HasFileChanged(const std::string& path) noexcept
+bool Manager::HasFileChanged(PathTable::Id file) noexcept
 {
-    const std::string md5_file    = MD5_bin(path);
-    const std::string md5_content = MD5_file_bin(path);
+    const std::string& md5_file    = PathTable::Instance().Key(file);
+    const std::string  md5_content = Digest(file);
 
     // IF NEW OR DIFFERENT, UPDATE CACHE
     return _cached_files.upsert(md5_file, md5_content, true); 
@@ -725,6 +958,106 @@ bool Manager::HasFileChanged(const std::string& path) noexcept
 
 
 
+/**
+ * @brief Queue a file for hashing on the background workers.
+ *
+ * Workers are started on the first call. Paths already queued or hashed are ignored.
+ *
+ * @param file Interned file path.
+ */
+void Manager::Prefetch(PathTable::Id file) noexcept
+{
+    {
+        std::lock_guard<std::mutex> lock(_hash_mutex);
+
+        if (_hash_stop || _hashed.count(file) || !_hash_pending.insert(file).second)
+        {
+            return;
+        }
+
+        _hash_queue.push_back(file);
+
+        // START WORKERS LAZILY
+        if (_hashers.empty())
+        {
+            const unsigned hw = std::thread::hardware_concurrency();
+            const unsigned n  = (hw == 0) ? 1 : std::min(hw, HASH_WORKERS);
+
+            for (unsigned i = 0; i < n; ++i)
+            {
+                _hashers.emplace_back(&Manager::HashWorker, this);
+            }
+        }
+    }
+
+    _hash_cv.notify_one();
+}
+
+
+
+/**
+ * @brief Hash queued files until shutdown.
+ */
+void Manager::HashWorker() noexcept
+{
+    std::unique_lock<std::mutex> lock(_hash_mutex);
+
+    for (;;)
+    {
+        _hash_cv.wait(lock, [this] { return _hash_stop || !_hash_queue.empty(); });
+
+        if (_hash_queue.empty())
+        {
+            return;
+        }
+
+        const PathTable::Id file = _hash_queue.front();
+        _hash_queue.pop_front();
+
+        // HASH OUTSIDE THE LOCK
+        lock.unlock();
+        std::string digest = MD5_file_bin(PathTable::Instance().Path(file));
+        lock.lock();
+
+        _hash_pending.erase(file);
+        _hashed[file] = std::move(digest);
+        _hash_cv.notify_all();
+    }
+}
+
+
+
+/**
+ * @brief Get the content digest of a file.
+ *
+ * A path still being hashed is waited for; a path not hashed yet is hashed on
+ * the calling thread. Digests are kept for the whole run, so a file checked by
+ * several tasks (e.g. track and store) is read only once.
+ *
+ * @param file Interned file path.
+ * @return Binary MD5 of the file content.
+ */
+std::string Manager::Digest(PathTable::Id file) noexcept
+{
+    std::unique_lock<std::mutex> lock(_hash_mutex);
+
+    _hash_cv.wait(lock, [&] { return _hash_stop || !_hash_pending.count(file); });
+
+    if (auto it = _hashed.find(file); it != _hashed.end())
+    {
+        return it->second;
+    }
+
+    lock.unlock();
+    std::string digest = MD5_file_bin(PathTable::Instance().Path(file));
+    lock.lock();
+
+    // MEMOIZE FOR THE REST OF THE RUN
+    return _hashed.emplace(file, std::move(digest)).first->second;
+}
+
+
+
 /**
  * @brief Write a script file for an instruction, using a stable name derived from job name and index.
  *
@@ -772,3 +1105,338 @@ fs::path Manager::WriteScript(const std::string& jobname,
 
     return script_path;
 }
+
+/**
+ * @brief Write a response file named after its content digest.
+ *
+ * Expansion runs on several threads, so writes are serialized; an existing
+ * file of the right size already holds the same content and is kept.
+ * The name is recorded so PruneResponseFiles() keeps it.
+ */
+fs::path Manager::WriteResponseFile(const std::string& content) noexcept
+{
+    const std::string rsp_name = MD5(content) + ".rsp";
+    const fs::path    rsp_path = _rsp_path / rsp_name;
+
+    std::error_code             ec;
+    std::lock_guard<std::mutex> lock(_rsp_mutex);
+
+    _rsp_used.insert(rsp_name);
+
+    // REWRITE ONLY MISSING OR TRUNCATED FILES
+    if (!file_exists(rsp_path) || fs::file_size(rsp_path, ec) != content.size())
+    {
+        create_file(rsp_path, content);
+    }
+
+    return rsp_path;
+}
+
+
+
+/**
+ * @brief Delete the response files this run did not write or reuse.
+ */
+void Manager::PruneResponseFiles() noexcept
+{
+    std::lock_guard<std::mutex> lock(_rsp_mutex);
+
+    remove_files_except(_rsp_path, _rsp_used);
+}
+
+
+
+/**
+ * @brief Restore an aligned environment from the snapshot of this selector.
+ *
+ * Layout: magic, version, selector, source list (path + content digest),
+ * recorded symbols, environment payload. Any mismatch, changed source or
+ * malformed payload makes the caller parse from scratch.
+ */
+bool Manager::LoadEnvironment(const std::string& selector, Semantic::Enviroment& env) noexcept
+{
+    const fs::path path = _env_path / MD5(selector);
+
+    if (!file_exists(path))
+    {
+        return false;
+    }
+
+    const std::string data = read_file(path);
+    SnapshotReader    r { data };
+
+    // HEADER
+    if (r.str() != SNAPSHOT_MAGIC || r.u32() != SNAPSHOT_VERSION || r.str() != selector || !r.ok)
+    {
+        return false;
+    }
+
+    // EVERY SOURCE SCRIPT MUST BE UNCHANGED
+    for (std::uint32_t i = 0, n = r.u32(); r.ok && i < n; ++i)
+    {
+        const std::string source = r.str();
+        const std::string digest = r.str();
+
+        if (!r.ok || !file_exists(source) || MD5_file_bin(source) != digest)
+        {
+            return false;
+        }
+    }
+
+    // SYMBOLS SET WHILE PARSING AND CHECKING ARGUMENTS
+    const std::string main    = r.str();
+    const std::string profile = r.str();
+    const std::string threads = r.str();
+
+    Semantic::Enviroment restored;
+
+    if (!r.ok || !DecodeEnvironment(r.in, restored))
+    {
+        return false;
+    }
+
+    env = std::move(restored);
+
+    Core::update_symbol(Core::SymbolType::MAIN,    main);
+    Core::update_symbol(Core::SymbolType::PROFILE, profile);
+    Core::update_symbol(Core::SymbolType::THREADS, threads);
+
+    return true;
+}
+
+
+
+/**
+ * @brief Write the snapshot of an aligned environment for this selector.
+ *
+ * The file is written next to its final name and renamed into place, so a
+ * concurrent run never reads a partial snapshot. Only the snapshot of the
+ * latest selector is kept; older ones are deleted.
+ */
+void Manager::StoreEnvironment(const std::string& selector,
+                               const std::vector<std::string>& sources,
+                               const Semantic::Enviroment& env) noexcept
+{
+    std::string    data;
+    SnapshotWriter w { data };
+
+    w.str(SNAPSHOT_MAGIC);
+    w.u32(SNAPSHOT_VERSION);
+    w.str(selector);
+
+    w.u32(static_cast<std::uint32_t>(sources.size()));
+
+    for (const auto& source : sources)
+    {
+        w.str(source);
+        w.str(MD5_file_bin(source));
+    }
+
+    w.str(Core::symbol(Core::SymbolType::MAIN));
+    w.str(Core::symbol(Core::SymbolType::PROFILE));
+    w.str(Core::symbol(Core::SymbolType::THREADS));
+
+    EncodeEnvironment(env, data);
+
+    const std::string name = MD5(selector);
+    const fs::path    path = _env_path / name;
+    const fs::path    temp = fs::path(path).concat(".tmp");
+    std::error_code   ec;
+
+    if (create_file(temp, data))
+    {
+        fs::rename(temp, path, ec);
+    }
+
+    // KEEP ONLY THE CURRENT SNAPSHOT
+    remove_files_except(_env_path, { name });
+}
+
+
+
+/**
+ * @brief Encode the environment payload of a snapshot.
+ *
+ * Task links (dependencies/thens) are stored as FTable keys and rebound on load.
+ */
+void Manager::EncodeEnvironment(const Semantic::Enviroment& env, std::string& out) noexcept
+{
+    SnapshotWriter w { out };
+
+    std::unordered_map<const Semantic::InstructionTask*, const std::string*> keys;
+
+    for (const auto& [key, task] : env.ftable)
+    {
+        keys.emplace(&task, &key);
+    }
+
+    auto put_links = [&] (const Semantic::FListCRef& links)
+    {
+        w.u32(static_cast<std::uint32_t>(links.size()));
+        for (const auto& link : links) w.str(*keys.at(&link.get()));
+    };
+
+    // ENVIRONMENT SETTINGS
+    w.strs(env.profile.profiles);
+    w.str (env.profile.selected);
+    w.str (env.default_interpreter);
+    w.u32 (env.max_threads);
+    w.strs(env.ignore_files);
+
+    w.u32(static_cast<std::uint32_t>(env.pools.size()));
+
+    for (const auto& [name, size] : env.pools)
+    {
+        w.str(name);
+        w.u32(size);
+    }
+
+    // VARIABLES
+    w.u32(static_cast<std::uint32_t>(env.vtable.size()));
+
+    for (const auto& [key, var] : env.vtable)
+    {
+        w.str (key);
+        w.str (var.var_name);
+        w.strs(var.var_value);
+        put_attributes(w, var.attributes);
+        w.strs(var.glob_expansion);
+    }
+
+    // TASKS
+    w.u32(static_cast<std::uint32_t>(env.ftable.size()));
+
+    for (const auto& [key, task] : env.ftable)
+    {
+        w.str (key);
+        w.str (task.task_name);
+        w.strs(task.task_instrs);
+        put_links(task.dependencies);
+        put_links(task.thens);
+        put_attributes(w, task.attributes);
+        w.str (task.interpreter);
+        w.u8  (static_cast<std::uint8_t>(task.cache.type));
+        w.u8  (task.cache.enabled ? 1 : 0);
+        w.strs(task.cache.data);
+    }
+
+    // ASSERTS
+    w.u32(static_cast<std::uint32_t>(env.atable.size()));
+
+    for (const auto& assert : env.atable)
+    {
+        w.u64 (assert.line);
+        w.str (assert.stmt);
+        w.str (assert.lvalue);
+        w.str (assert.rvalue);
+        w.u8  (static_cast<std::uint8_t>(assert.check));
+        w.str (assert.reason);
+        w.strs(assert.actions);
+        w.u8  (static_cast<std::uint8_t>(assert.type));
+        w.str (assert.search_path.string());
+    }
+}
+
+
+
+/**
+ * @brief Decode the environment payload of a snapshot.
+ */
+bool Manager::DecodeEnvironment(std::string_view in, Semantic::Enviroment& env) noexcept
+{
+    SnapshotReader r { in };
+
+    using Links = std::vector<std::string>;
+
+    std::vector<std::pair<Semantic::InstructionTask*, std::pair<Links, Links>>> links;
+
+    // ENVIRONMENT SETTINGS
+    env.profile.profiles    = r.strs();
+    env.profile.selected    = r.str();
+    env.default_interpreter = r.str();
+    env.max_threads         = r.u32();
+    env.ignore_files        = r.strs();
+
+    for (std::uint32_t i = 0, n = r.u32(); r.ok && i < n; ++i)
+    {
+        auto name = r.str();
+        env.pools[std::move(name)] = r.u32();
+    }
+
+    // VARIABLES
+    for (std::uint32_t i = 0, n = r.u32(); r.ok && i < n; ++i)
+    {
+        auto  key = r.str();
+        auto& var = env.vtable.emplace_hint(env.vtable.end(), std::move(key), Semantic::InstructionAssign{})->second;
+
+        var.var_name       = r.str();
+        var.var_value      = r.strs();
+        var.setAttributes(get_attributes(r));
+        var.glob_expansion = r.strs();
+    }
+
+    // TASKS
+    for (std::uint32_t i = 0, n = r.u32(); r.ok && i < n; ++i)
+    {
+        auto  key  = r.str();
+        auto& task = env.ftable.emplace_hint(env.ftable.end(), std::move(key), Semantic::InstructionTask{})->second;
+
+        task.task_name     = r.str();
+        task.task_instrs   = r.strs();
+
+        Links deps         = r.strs();
+        Links thens        = r.strs();
+
+        task.setAttributes(get_attributes(r));
+        task.interpreter   = r.str();
+        task.cache.type    = static_cast<Semantic::InstructionTask::Cache::Type>(r.u8());
+        task.cache.enabled = r.u8() != 0;
+        task.cache.data    = r.strs();
+
+        links.push_back({ &task, { std::move(deps), std::move(thens) } });
+    }
+
+    // ASSERTS
+    for (std::uint32_t i = 0, n = r.u32(); r.ok && i < n; ++i)
+    {
+        auto& assert = env.atable.emplace_back();
+
+        assert.line        = static_cast<std::size_t>(r.u64());
+        assert.stmt        = r.str();
+        assert.lvalue      = r.str();
+        assert.rvalue      = r.str();
+        assert.check       = static_cast<Semantic::AssertCheck::CheckType>(r.u8());
+        assert.reason      = r.str();
+        assert.actions     = r.strs();
+        assert.type        = static_cast<Semantic::AssertCheck::Type>(r.u8());
+        assert.search_path = r.str();
+    }
+
+    if (!r.ok || !r.in.empty())
+    {
+        return false;
+    }
+
+    // REBIND TASK LINKS NOW THAT THE FTABLE IS COMPLETE
+    for (auto& [task, names] : links)
+    {
+        for (const auto& name : names.first)
+        {
+            auto it = env.ftable.find(name);
+            if (it == env.ftable.end()) return false;
+            task->dependencies.push_back(std::cref(it->second));
+        }
+
+        for (const auto& name : names.second)
+        {
+            auto it = env.ftable.find(name);
+            if (it == env.ftable.end()) return false;
+            task->thens.push_back(std::cref(it->second));
+        }
+    }
+
+    // THE RESTORED TABLE IS FINAL: INDEX IT
+    env.IndexTasks();
+
+    return true;
+}
@@ -1,5 +1,4 @@
 #include "Grammar.h"
-#include <algorithm>
 
 USE_MODULE(Arcana);
 USE_MODULE(Arcana::Grammar);
@@ -336,37 +335,61 @@ static Rules rule_ASSERT_ACT =
 
 
 /**
- * @brief Construct grammar engine and initialize production rules and index buffers.
+ * @brief Construct grammar engine and compile production rules into the transition table.
  *
- * The engine pre-builds:
- * - `_rules` map: Rule -> NonTerminal
- * - `_index` map: Rule -> vector of Index entries (one per terminal node)
+ * The engine pre-builds, for every rule:
+ * - `_rules` entry: the source NonTerminal (kept for diagnostics)
+ * - `_table` entry: one compiled Node per terminal position
+ * - `_index` entry: one Index per terminal position
  */
 Engine::Engine()
 {
-    // REGISTER PRODUCTIONS
-    _rules[Rule::VARIABLE_ASSIGN  ] = rule_VARIABLE_ASSIGNMENT.buffer;
-    _rules[Rule::VARIABLE_JOIN    ] = rule_VARIABLE_JOIN.buffer;
-    _rules[Rule::EMPTY_LINE       ] = rule_EMPTY_LINE.buffer;
-    _rules[Rule::ATTRIBUTE        ] = rule_ATTRIBUTE.buffer;
-    _rules[Rule::TASK_DECL        ] = rule_TASK_DECL.buffer;
-    _rules[Rule::IMPORT           ] = rule_IMPORT.buffer;
-    _rules[Rule::USING            ] = rule_USING.buffer;
-    _rules[Rule::MAPPING          ] = rule_MAP.buffer;
-    _rules[Rule::ASSERT_MSG       ] = rule_ASSERT_MSG.buffer;
-    _rules[Rule::ASSERT_ACT       ] = rule_ASSERT_ACT.buffer;
-
-    // ALLOCATE INDEX BUFFERS (ONE PER RULE POSITION)
-    _index[Rule::VARIABLE_ASSIGN  ] = std::vector<Index>(rule_VARIABLE_ASSIGNMENT.buffer.size());
-    _index[Rule::VARIABLE_JOIN    ] = std::vector<Index>(rule_VARIABLE_JOIN.buffer.size());
-    _index[Rule::EMPTY_LINE       ] = std::vector<Index>(rule_EMPTY_LINE.buffer.size());
-    _index[Rule::ATTRIBUTE        ] = std::vector<Index>(rule_ATTRIBUTE.buffer.size());
-    _index[Rule::TASK_DECL        ] = std::vector<Index>(rule_TASK_DECL.buffer.size());
-    _index[Rule::IMPORT           ] = std::vector<Index>(rule_IMPORT.buffer.size());
-    _index[Rule::USING            ] = std::vector<Index>(rule_USING.buffer.size());
-    _index[Rule::MAPPING          ] = std::vector<Index>(rule_MAP.buffer.size());
-    _index[Rule::ASSERT_MSG       ] = std::vector<Index>(rule_ASSERT_MSG.buffer.size());
-    _index[Rule::ASSERT_ACT       ] = std::vector<Index>(rule_ASSERT_ACT.buffer.size());
+    // REGISTER AND COMPILE PRODUCTIONS
+    _compile(Rule::VARIABLE_ASSIGN  , rule_VARIABLE_ASSIGNMENT.buffer);
+    _compile(Rule::VARIABLE_JOIN    , rule_VARIABLE_JOIN.buffer);
+    _compile(Rule::EMPTY_LINE       , rule_EMPTY_LINE.buffer);
+    _compile(Rule::ATTRIBUTE        , rule_ATTRIBUTE.buffer);
+    _compile(Rule::TASK_DECL        , rule_TASK_DECL.buffer);
+    _compile(Rule::IMPORT           , rule_IMPORT.buffer);
+    _compile(Rule::USING            , rule_USING.buffer);
+    _compile(Rule::MAPPING          , rule_MAP.buffer);
+    _compile(Rule::ASSERT_MSG       , rule_ASSERT_MSG.buffer);
+    _compile(Rule::ASSERT_ACT       , rule_ASSERT_ACT.buffer);
+}
+
+
+
+/**
+ * @brief Compile a production into transition nodes and allocate its index buffer.
+ *
+ * Each terminal becomes a Node whose `accept` mask has one bit per TokenType
+ * listed in the terminal, so matching a token against a state is a bit test.
+ *
+ * @param rule       Rule identifier.
+ * @param production Rule production built with the Rules helper.
+ */
+void Engine::_compile(const Rule rule, const NonTerminal& production)
+{
+    auto& nodes = _table[_I(rule)];
+
+    nodes.reserve(production.size());
+
+    for (const auto& terminal : production)
+    {
+        Node node { 0, false, false };
+
+        for (const auto type : terminal)
+        {
+            node.accept |= (uint64_t(1) << _I(type));
+            node.any    |= (type == Scan::TokenType::ANY);
+            node.opt    |= (type == Scan::TokenType::OPT_NEWLINE);
+        }
+
+        nodes.push_back(node);
+    }
+
+    _rules[_I(rule)] = production;
+    _index[_I(rule)] = std::vector<Index>(production.size());
 }
 
 
@@ -374,78 +397,75 @@ Engine::Engine()
 /**
  * @brief Feed one token into the grammar engine and update match state.
  *
- * This function implements a rule-stream matching procedure with caching:
- * - keeps a set of candidate rules (`_cache.keys`)
+ * This function walks the compiled transition table:
+ * - keeps a bitmask of candidate rules (`_cache.keys`)
  * - advances per-rule cursor (`_cache.data[Rule]`)
  * - tracks matched spans (`_index[Rule][pos]`)
  * - produces a complete match when a rule reaches its end
  *
+ * Visited states are recorded in a fixed trail so that expected terminals and
+ * candidate rules are only built when every candidate has failed.
+ *
  * @param token Incoming lexer token.
  * @param match Output match structure updated in-place.
  */
 void Engine::match(const Scan::Token& token, Match& match)
 {
-    bool                         error       = false;
-    bool                         cached      = false;
-    bool                         matched     = false;
-    bool                         remove      = false;
-    uint32_t                     position    = 0;
-    Scan::TokenType              ttype       = token.type;
-    Rule                         stype       = Rule::UNDEFINED;
-    UniqueNonTerminal            estream;
-    UniqueRule                   semtypes;
-    std::set<Rule>               new_key_cache;
-    Terminal::const_iterator     found;
-    Terminal::const_iterator     wildcard;
-    Terminal::const_iterator     opttoken;
-
-    // INITIALIZE THE CACHE ON FIRST RUN
-    if (_cache.data.size() == 0)
+    bool                             error       = false;
+    bool                             cached      = _cache.active;
+    bool                             matched     = false;
+    bool                             remove      = false;
+    uint32_t                         position    = 0;
+    uint32_t                         new_keys    = 0;
+    std::size_t                      steps       = 0;
+    Scan::TokenType                  ttype       = token.type;
+    uint64_t                         tbit        = uint64_t(1) << _I(ttype);
+    Rule                             stype       = Rule::UNDEFINED;
+    std::array<Step, RULES * 2>      trail;
+
+    // INITIALIZE THE CANDIDATES ON FIRST RUN
+    if (!cached)
     {
-        for (const auto& pair : _rules)
-        {
-            _cache.keys.insert(pair.first);
-        }
-    }
-    else
-    {
-        cached = true;
+        _cache.keys = uint32_t((uint64_t(1) << RULES) - 1) & ~uint32_t(1);
     }
 
     // GET THE WORKING KEY SET
-    UniqueRule& keys = _cache.keys;
+    uint32_t& keys = _cache.keys;
 
-    // TRY MATCHING ALL CANDIDATE RULES
-    for (auto it = keys.begin(); it != keys.end() && !matched; )
+    // TRY MATCHING ALL CANDIDATE RULES IN RULE ORDER
+    for (std::size_t r = 1; r < RULES && !matched; )
     {
+        const uint32_t bit = uint32_t(1) << r;
+
+        if ((keys & bit) == 0)
+        {
+            ++r;
+            continue;
+        }
+
         // LOAD CURRENT RULE STATE
-        const auto  key   = *it;
-        const auto& value = _rules[key];
-        position          = cached ? _cache.data[key] : 0;
+        const Rule  key   = static_cast<Rule>(r);
+        const auto& value = _table[r];
+        position          = _cache.data[r];
         remove            = false;
 
         // CHECK RULE CURSOR BOUNDS
         if (position < value.size())
         {
-            // READ CURRENT NODE AND SEARCH TOKEN
-            auto& node     = value[position];
-                  found    = std::find(node.begin(), node.end(), ttype);
-                  wildcard = std::find(node.begin(), node.end(), Scan::TokenType::ANY);
-                  opttoken = std::find(node.begin(), node.end(), Scan::TokenType::OPT_NEWLINE);
-
-            // ACCUMULATE ERROR STREAM CONTEXT
-            estream.insert(node);
-            semtypes.insert(key);
+            // READ CURRENT NODE AND RECORD IT FOR ERROR CONTEXT
+            const Node& node = value[position];
+            trail[steps++]   = { key, position };
 
             // REGULAR TOKEN MATCH
-            if (found != node.end())
+            if (node.accept & tbit)
             {
                 // COLLECT TOKEN SPAN
-                _collect_input(token, *found, key, position);
+                _collect_input(token, ttype, key, position);
 
                 // ADVANCE CURSOR AND CHECK COMPLETION
-                _cache.data[key] = ++position;
-                matched          = (position == value.size());
+                _cache.data[r] = ++position;
+                _cache.active  = true;
+                matched        = (position == value.size());
 
                 // RECORD MATCH TYPE ON COMPLETION
                 if (matched)
@@ -467,16 +487,14 @@ void Engine::match(const Scan::Token& token, Match& match)
                 }
 
                 // KEEP RULE IN NEXT ITERATION SET
-                new_key_cache.insert(key);
+                new_keys |= bit;
             }
 
             // WILDCARD NODE (ANY)
-            else if (wildcard != node.end())
+            else if (node.any)
             {
                 // LOOKAHEAD TO DECIDE WHETHER TO CONSUME AS ANY OR ADVANCE
-                position++;
-                auto& lookahead = value[position];
-                found           = std::find(lookahead.begin(), lookahead.end(), ttype);
+                const bool ahead = (value[position + 1].accept & tbit) != 0;
 
                 // UPDATE CURLY BRACES COUNTER FOR TASK BODY
                 if (key == Rule::TASK_DECL)
@@ -492,37 +510,21 @@ void Engine::match(const Scan::Token& token, Match& match)
                 }
 
                 // IF LOOKAHEAD DOES NOT MATCH, CONSUME TOKEN AS ANY
-                if (found == lookahead.end())
+                // SPECIAL HANDLING FOR TASK BODY TERMINATION
+                if (!ahead || (key == Rule::TASK_DECL && _cache.opened_curly_braces != 0))
                 {
-                    position -= 1;
-                    _collect_input(token, *wildcard, key, position);
+                    _collect_input(token, Scan::TokenType::ANY, key, position);
                 }
                 else
                 {
-                    // SPECIAL HANDLING FOR TASK BODY TERMINATION
-                    if (key == Rule::TASK_DECL)
-                    {
-                        if (_cache.opened_curly_braces == 0)
-                        {
-                            position += 1;
-                            _collect_input(token, *found, key, position - 1);
-                        }
-                        else
-                        {
-                            position -= 1;
-                            _collect_input(token, *wildcard, key, position);
-                        }
-                    }
-                    else
-                    {
-                        position += 1;
-                        _collect_input(token, *found, key, position - 1);
-                    }
+                    _collect_input(token, ttype, key, position + 1);
+                    position += 2;
                 }
 
                 // CACHE CURSOR AND CHECK COMPLETION
-                _cache.data[key] = position;
-                matched          = (position == value.size());
+                _cache.data[r] = position;
+                _cache.active  = true;
+                matched        = (position == value.size());
 
                 // RECORD MATCH TYPE ON COMPLETION
                 if (matched)
@@ -532,12 +534,13 @@ void Engine::match(const Scan::Token& token, Match& match)
             }
 
             // OPTIONAL NEWLINE NODE
-            else if (opttoken != node.end())
+            else if (node.opt)
             {
                 // ADVANCE RULE CURSOR OVER OPTIONAL SLOT
-                _cache.data[key] = ++position;
+                _cache.data[r] = ++position;
+                _cache.active  = true;
 
-                // CONSUME TOKEN ONLY IF IT IS A NEWLINE
+                // CONSUME TOKEN ONLY IF IT IS A NEWLINE, OTHERWISE RETRY THE NEXT NODE
                 if (ttype == Scan::TokenType::NEWLINE)
                 {
                     _collect_input(token, ttype, key, position);
@@ -557,10 +560,10 @@ void Engine::match(const Scan::Token& token, Match& match)
             // REMOVE RULE FROM CANDIDATES
             if (remove)
             {
-                it = keys.erase(it);
+                keys &= ~bit;
 
                 // IF NO RULES LEFT, EMIT ERROR AND RESET CACHE IF NEEDED
-                if (keys.empty())
+                if (keys == 0)
                 {
                     error = true;
 
@@ -572,28 +575,46 @@ void Engine::match(const Scan::Token& token, Match& match)
                     break;
                 }
             }
-            else
-            {
-                ++it;
-            }
         }
+
+        ++r;
     }
 
     // UPDATE CANDIDATE SET FOR NEXT TOKEN
-    if (new_key_cache.size())
+    if (new_keys)
     {
-        _cache.keys = new_key_cache;
+        _cache.keys = new_keys;
     }
 
     // POPULATE OUTPUT MATCH STRUCT
     match.valid          = matched;
     match.type           = stype;
-    match.indexes        = _index[stype];
     match.Error.token    = token;
-    match.Error.estream  = estream;
-    match.Error.semtypes = semtypes;
     match.Error.presence = error;
 
+    if (matched)
+    {
+        const auto& index = _index[_I(stype)];
+        match.indexes.assign(index.begin(), index.end());
+    }
+    else
+    {
+        match.indexes.clear();
+    }
+
+    // BUILD ERROR CONTEXT ONLY ON FAILURE
+    match.Error.estream.clear();
+    match.Error.semtypes.clear();
+
+    if (error)
+    {
+        for (std::size_t i = 0; i < steps; ++i)
+        {
+            match.Error.estream.insert(_rules[_I(trail[i].rule)][trail[i].position]);
+            match.Error.semtypes.insert(trail[i].rule);
+        }
+    }
+
     // RESET STATE AFTER A COMPLETE MATCH
     if (matched)
     {
@@ -619,7 +640,7 @@ void Engine::match(const Scan::Token& token, Match& match)
 void Engine::_collect_input(const Scan::Token& token, const Scan::TokenType tt, const Rule st, const uint32_t pos)
 {
     // GET INDEX SLOT FOR THIS RULE POSITION
-    auto& index = _index[st][pos];
+    auto& index = _index[_I(st)][pos];
 
     // STORE TOKEN AND END OFFSET
     index.token = token;
@@ -662,9 +683,9 @@ void Engine::_reset()
     _cache.reset();
 
     // RESET ALL INDEX SLOTS
-    for (auto& pair : _index)
+    for (auto& slots : _index)
     {
-        for (auto& idx : pair.second)
+        for (auto& idx : slots)
         {
             idx.reset();
         }
@@ -1,21 +1,32 @@
 #include "Lexer.h"
+#include "Support.h"
 
 #include <cctype>
+#include <cstring>
 #include <fstream>
+#include <iterator>
 #include <algorithm>
 
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 USE_MODULE(Arcana::Scan);
 
 /**
  * @file Lexer.cpp
  * @brief Arcana DSL lexer implementation.
  *
- * The lexer converts the input script stream into a flat token stream.
- * It also keeps an in-memory copy of all source lines to support diagnostics.
+ * The lexer converts the input script into a flat token stream. The script is
+ * read once into a single buffer (memory-mapped on POSIX); token lexemes and
+ * diagnostic lines are views into it.
  *
  * Design notes:
  * - Newline tokens are preserved (parser/grammar relies on them).
- * - Comments starting with '#' are skipped until newline.
+ * - Comments starting with '#' are skipped until newline with memchr.
  * - CR characters are ignored to normalize CRLF inputs.
  *
  * Known limitations:
@@ -37,11 +48,29 @@ USE_MODULE(Arcana::Scan);
 //                                                                              
 
 
+/**
+ * @brief Reserved keywords -> token type (compile-time, case-insensitive).
+ */
+static constexpr auto Known_Keywords = Arcana::Support::make_keyword_map<TokenType>({
+    { "task"   , TokenType::TASK    },
+    { "import" , TokenType::IMPORT  },
+    { "using"  , TokenType::USING   },
+    { "map"    , TokenType::MAPPING },
+    { "assert" , TokenType::ASSERT  },
+    { "ne"     , TokenType::NE      },
+    { "eq"     , TokenType::EQ      },
+    { "in"     , TokenType::IN      },
+});
+
+static_assert(Known_Keywords.valid(), "Known_Keywords: colliding keys");
+
+
+
 /**
  * @brief Construct a lexer bound to an Arcana script file path.
  *
- * The constructor opens the file, caches all lines for later diagnostics,
- * then primes the lexer by reading the first character.
+ * The constructor maps (or reads) the file into a single buffer, then primes
+ * the lexer by reading the first character.
  *
  * @param arcscript Path to the source script file.
  */
@@ -51,12 +80,17 @@ Lexer::Lexer(const std::string& arcscript)
     line_(1),
     col_(0),
     nlcol_(0),
-    file_(arcscript),
-    in_(file_),
-    arcscript_(arcscript)
+    data_(nullptr),
+    size_(0),
+    pos_(0),
+    eof_(false),
+    map_(nullptr),
+    arcscript_(arcscript),
+    line_starts_{0},
+    lines_done_(false)
 {
-    // CACHE SOURCE LINES FOR DIAGNOSTICS
-    load_file_lines(in_);
+    // LOAD THE WHOLE SOURCE ONCE
+    load_source();
 
     // PRIME CURRENT_ WITH FIRST CHAR
     advance();
@@ -65,11 +99,26 @@ Lexer::Lexer(const std::string& arcscript)
 
 
 /**
- * @brief Produce the next token from the input stream.
+ * @brief Release the source mapping, if any.
+ */
+Lexer::~Lexer()
+{
+#if !defined(_WIN32)
+    if (map_ != nullptr)
+    {
+        ::munmap(map_, size_);
+    }
+#endif
+}
+
+
+
+/**
+ * @brief Produce the next token from the source buffer.
  *
  * The lexer:
  * 1) skips whitespace (but preserves '\n')
- * 2) returns ENDOFFILE if stream is invalid
+ * 2) returns ENDOFFILE once the buffer is exhausted
  * 3) lexes identifiers/keywords, numbers, or single-char tokens
  *
  * @return Next scanned Token.
@@ -79,10 +128,10 @@ Token Lexer::next()
     // SKIP WHITESPACE BUT PRESERVE NEWLINE
     skipWhitespace();
 
-    // IF STREAM IS INVALID RETURN EOF TOKEN
-    if (!in_)
+    // IF THE BUFFER IS EXHAUSTED RETURN EOF TOKEN
+    if (eof_)
     {
-        return makeToken(TokenType::ENDOFFILE, "", line_, col_, col_);
+        return makeToken(TokenType::ENDOFFILE, {}, line_, col_, col_);
     }
 
     // IDENTIFIER / KEYWORD
@@ -124,31 +173,98 @@ Token Lexer::next()
 
 
 /**
- * @brief Load the entire input stream into a vector of lines.
+ * @brief Return a source line, indexing line starts only as far as needed.
  *
- * This is used for error reporting (line preview) and is independent from tokenization.
+ * Lines follow std::getline semantics: they exclude the '\n' terminator and a
+ * trailing newline does not open an extra empty line.
  *
- * @param in Input stream (must be seekable).
+ * @param pos 0-based line index.
+ * @return View of the line, empty if pos is past the last line.
  */
-void Lexer::load_file_lines(std::istream& in)
+std::string_view Lexer::operator[] (const size_t pos)
 {
-    // READ ALL LINES INTO MEMORY
-    std::string line;
+    // EXTEND THE LINE INDEX UP TO THE REQUESTED LINE
+    while (!lines_done_ && line_starts_.size() <= pos)
+    {
+        const std::size_t from = line_starts_.back();
+        const void*       nl   = (from < size_) ? std::memchr(data_ + from, '\n', size_ - from) : nullptr;
+        const std::size_t next = (nl != nullptr) ? static_cast<std::size_t>(static_cast<const char*>(nl) - data_) + 1 : size_;
 
-    while (std::getline(in, line))
+        if (next >= size_)
+        {
+            lines_done_ = true;
+            break;
+        }
+
+        line_starts_.push_back(next);
+    }
+
+    if (pos >= line_starts_.size() || line_starts_[pos] >= size_)
     {
-        lines.push_back(line);
+        return {};
     }
 
-    // RESET STREAM FOR LEXING
-    in.clear();
-    in.seekg(0);
+    // SLICE UP TO THE NEXT NEWLINE
+    const std::size_t begin = line_starts_[pos];
+    const void*       nl    = std::memchr(data_ + begin, '\n', size_ - begin);
+    const std::size_t end   = (nl != nullptr) ? static_cast<std::size_t>(static_cast<const char*>(nl) - data_) : size_;
+
+    return std::string_view(data_ + begin, end - begin);
 }
 
 
 
 /**
- * @brief Advance the underlying stream by one logical character.
+ * @brief Load the whole script into the source buffer.
+ *
+ * Regular files are memory-mapped read-only on POSIX; anything else (Windows,
+ * empty files, pipes, mapping failures) is read into an owned string.
+ */
+void Lexer::load_source()
+{
+#if !defined(_WIN32)
+    const int fd = ::open(arcscript_.c_str(), O_RDONLY);
+
+    if (fd >= 0)
+    {
+        struct stat st;
+
+        if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0)
+        {
+            void* mapping = ::mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+
+            if (mapping != MAP_FAILED)
+            {
+                ::madvise(mapping, static_cast<std::size_t>(st.st_size), MADV_SEQUENTIAL);
+
+                map_  = mapping;
+                data_ = static_cast<const char*>(mapping);
+                size_ = static_cast<std::size_t>(st.st_size);
+            }
+        }
+
+        ::close(fd);
+
+        if (map_ != nullptr)
+        {
+            return;
+        }
+    }
+#endif
+
+    // FALLBACK: READ THE WHOLE STREAM INTO AN OWNED BUFFER
+    std::ifstream file(arcscript_, std::ios::binary);
+
+    owned_.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+    data_ = owned_.data();
+    size_ = owned_.size();
+}
+
+
+
+/**
+ * @brief Advance the buffer by one logical character.
  *
  * This updates:
  * - current_  : current character
@@ -157,26 +273,26 @@ void Lexer::load_file_lines(std::istream& in)
  * - nlcol_    : "running column" used to compute NEWLINE token position
  *
  * Behavior:
- * - EOF sets eofbit, current_ = '\0'
+ * - reading past the end sets eof_, current_ = '\0'
  * - '\r' is ignored (CRLF normalization)
- * - '#' starts a comment, which is skipped until '\n' or EOF
+ * - '#' starts a comment, which is skipped until '\n' or end of buffer
  */
 void Lexer::advance()
 {
     // LOOP UNTIL WE PRODUCE A STABLE current_
     for (;;)
     {
-        // READ NEXT CHAR
-        int c = in_.get();
-
-        // HANDLE EOF
-        if (c == EOF)
+        // HANDLE END OF BUFFER
+        if (pos_ >= size_)
         {
-            in_.setstate(std::ios::eofbit);
+            eof_     = true;
             current_ = '\0';
             return;
         }
 
+        // READ NEXT CHAR
+        char c = data_[pos_++];
+
         // NORMALIZE CRLF BY DROPPING '\r'
         if (c == '\r')
         {
@@ -186,18 +302,32 @@ void Lexer::advance()
         // SKIP COMMENTS STARTING WITH '#'
         if (c == '#')
         {
-            // CONSUME UNTIL NEWLINE OR EOF
-            do
+            // JUMP TO THE NEWLINE; EVERY CONSUMED CHAR STILL COUNTS AS A COLUMN
+            const void* nl = std::memchr(data_ + pos_, '\n', size_ - pos_);
+
+            if (nl == nullptr)
             {
-                c = in_.get();
-                ++nlcol_;
-                ++col_;
+                // COMMENT RUNS TO END OF BUFFER (THE EOF READ AND ITS COMMIT ALSO COUNT)
+                const std::size_t skipped = size_ - pos_ + 2;
+
+                nlcol_  += skipped;
+                col_    += skipped;
+                pos_     = size_;
+                eof_     = true;
+                current_ = '\0';
+                return;
             }
-            while (c != '\n' && c != EOF);
+
+            const std::size_t skipped = static_cast<std::size_t>(static_cast<const char*>(nl) - (data_ + pos_)) + 1;
+
+            nlcol_ += skipped;
+            col_   += skipped;
+            pos_   += skipped;
+            c       = '\n';
         }
 
         // COMMIT CURRENT CHAR
-        current_ = static_cast<char>(c);
+        current_ = c;
 
         // UPDATE POSITIONS
         if (current_ == '\n')
@@ -231,7 +361,7 @@ void Lexer::advance()
 void Lexer::skipWhitespace()
 {
     // ADVANCE WHILE WHITESPACE BUT NOT NEWLINE
-    while (in_ && current_ != '\n' && ::isspace(static_cast<unsigned char>(current_)))
+    while (!eof_ && current_ != '\n' && ::isspace(static_cast<unsigned char>(current_)))
     {
         advance();
     }
@@ -251,8 +381,8 @@ void Lexer::skipWhitespace()
  */
 Token Lexer::simpleToken(TokenType type)
 {
-    // CAPTURE CURRENT CHAR BEFORE ADVANCING
-    char c = current_;
+    // THE CURRENT CHAR IS THE LAST ONE READ FROM THE BUFFER
+    std::string_view lexeme(data_ + pos_ - 1, 1);
 
     // COMPUTE TOKEN POSITION (SPECIAL-CASE NEWLINE)
     auto tokLine = (type == TokenType::NEWLINE) ? line_  - 1 : line_;
@@ -262,7 +392,7 @@ Token Lexer::simpleToken(TokenType type)
     advance();
 
     // BUILD TOKEN (END PARAM IS USED AS "LENGTH" HERE)
-    return makeToken(type, std::string(1, c), tokLine, tokCol, 1);
+    return makeToken(type, lexeme, tokLine, tokCol, 1);
 }
 
 
@@ -274,67 +404,38 @@ Token Lexer::simpleToken(TokenType type)
  * - starts with alpha or '_'
  * - continues with alnum or '_'
  *
- * Keywords are detected case-insensitively by lowercasing the scanned lexeme.
+ * Keywords are detected case-insensitively, without copying the lexeme.
  *
  * @return IDENTIFIER or a keyword TokenType.
  */
 Token Lexer::identifier()
 {
     // CAPTURE START POSITION
-    std::string lexeme;
+    const std::size_t begin = pos_ - 1;
+    std::size_t       end   = begin;
+
     auto tokLine = line_;
     auto tokCol  = col_ - 1;
 
     TokenType tt = TokenType::IDENTIFIER;
 
     // CONSUME IDENT CHARS
-    while (in_ && (std::isalnum(static_cast<unsigned char>(current_)) || current_ == '_'))
+    while (!eof_ && (std::isalnum(static_cast<unsigned char>(current_)) || current_ == '_'))
     {
-        lexeme.push_back(current_);
+        end = pos_;
         advance();
     }
 
-    // LOWERCASE COPY FOR KEYWORD CHECK
-    std::string lower = lexeme;
-    std::transform(lower.begin(), lower.end(), lower.begin(),
-        [] (unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    const std::string_view lexeme(data_ + begin, end - begin);
 
     // MATCH RESERVED KEYWORDS
-    if (lower.compare("task") == 0)
-    {
-        tt = TokenType::TASK;
-    }
-    else if (lower.compare("import") == 0)
-    {
-        tt = TokenType::IMPORT;
-    }
-    else if (lower.compare("using") == 0)
-    {
-        tt = TokenType::USING;
-    }
-    else if (lower.compare("map") == 0)
-    {
-        tt = TokenType::MAPPING;
-    }
-    else if (lower.compare("assert") == 0)
-    {
-        tt = TokenType::ASSERT;
-    }
-    else if (lower.compare("ne") == 0)
-    {
-        tt = TokenType::NE;
-    }
-    else if (lower.compare("eq") == 0)
+    if (const auto* keyword = Known_Keywords.find(lexeme))
     {
-        tt = TokenType::EQ;
-    }
-    else if (lower.compare("in") == 0)
-    {
-        tt = TokenType::IN;
+        tt = *keyword;
     }
 
     // EMIT TOKEN (END PARAM USED AS LENGTH)
-    return makeToken(tt, std::move(lexeme), tokLine, tokCol, lexeme.size());
+    return makeToken(tt, lexeme, tokLine, tokCol, lexeme.size());
 }
 
 
@@ -350,19 +451,23 @@ Token Lexer::identifier()
 Token Lexer::number()
 {
     // CAPTURE START POSITION
-    std::string lexeme;
+    const std::size_t begin = pos_ - 1;
+    std::size_t       end   = begin;
+
     auto tokLine = line_;
     auto tokCol  = col_ - 1;
 
     // CONSUME DIGITS
-    while (in_ && std::isdigit(static_cast<unsigned char>(current_)))
+    while (!eof_ && std::isdigit(static_cast<unsigned char>(current_)))
     {
-        lexeme.push_back(current_);
+        end = pos_;
         advance();
     }
 
+    const std::string_view lexeme(data_ + begin, end - begin);
+
     // EMIT TOKEN
-    return makeToken(TokenType::NUMBER, std::move(lexeme), tokLine, tokCol, lexeme.size());
+    return makeToken(TokenType::NUMBER, lexeme, tokLine, tokCol, lexeme.size());
 }
 
 
@@ -371,15 +476,15 @@ Token Lexer::number()
  * @brief Build a Token object.
  *
  * @param type   Token type.
- * @param lexeme Token lexeme payload.
+ * @param lexeme Token lexeme (view into the source buffer).
  * @param line   1-based line index.
  * @param start  Start column (as tracked by lexer).
  * @param end    End column OR length.
  * @return Token value.
  */
-Token Lexer::makeToken(TokenType type, std::string lexeme,
+Token Lexer::makeToken(TokenType type, std::string_view lexeme,
                        std::size_t line, std::size_t start, std::size_t end)
 {
     // BUILD TOKEN STRUCT
-    return Token{ type, std::move(lexeme), line, start, end };
+    return Token{ type, lexeme, line, start, end };
 }
@@ -1,7 +1,11 @@
 #include "Parser.h"
 #include "Support.h"
+#include "Cache.h"
 
+#include <atomic>
+#include <thread>
 #include <variant>
+#include <filesystem>
 
 USE_MODULE(Arcana::Parsing);
 
@@ -31,7 +35,9 @@ USE_MODULE(Arcana::Parsing);
 Parser::Parser(Scan::Lexer& l, Grammar::Engine& e)
     :
     lexer(l),
-    engine(e)
+    engine(e),
+    imports(nullptr),
+    imports_only(false)
 {}
 
 
@@ -111,7 +117,7 @@ Arcana_Result Parser::Parse(Semantic::Enviroment& env)
     while (token.type != Scan::TokenType::ENDOFFILE);
 
     // EXPORT THE COLLECTED ENVIRONMENT
-    env = instr_engine.GetEnvironment();
+    env = std::move(instr_engine).GetEnvironment();
 
     return ARCANA_RESULT__OK;
 }
@@ -136,8 +142,8 @@ Arcana::Support::SemanticOutput Parser::Handle_VarAssign(Grammar::Match& match)
 
     // SLICE RAW INPUT LINE
     Input  input = lexer[p1->token];
-    Lexeme var   = input.substr(p1->start, p1->end - p1->start);
-    Lexeme value = input.substr(p2->start, p2->end - p2->start);
+    Lexeme var   (input.substr(p1->start, p1->end - p1->start));
+    Lexeme value (input.substr(p2->start, p2->end - p2->start));
 
     // COLLECT INTO SEMANTIC ENGINE
     return instr_engine.Collect_Assignment(var, value);
@@ -154,8 +160,8 @@ Arcana::Support::SemanticOutput Parser::Handle_VarJoin(Grammar::Match& match)
 
     // SLICE RAW INPUT LINE
     Input  input = lexer[p1->token];
-    Lexeme var   = input.substr(p1->start, p1->end - p1->start);
-    Lexeme value = input.substr(p2->start, p2->end - p2->start);
+    Lexeme var   (input.substr(p1->start, p1->end - p1->start));
+    Lexeme value (input.substr(p2->start, p2->end - p2->start));
 
     // COLLECT INTO SEMANTIC ENGINE
     return instr_engine.Collect_Assignment(var, value, true);
@@ -181,8 +187,8 @@ Arcana::Support::SemanticOutput Parser::Handle_Attribute(Grammar::Match& match)
 
     // SLICE RAW INPUT LINE
     Input  input   = lexer[p1->token];
-    Lexeme attr    = input.substr(p1->start, p1->end - p1->start);
-    Lexeme attropt = input.substr(p2->start, p2->end - p2->start);
+    Lexeme attr    (input.substr(p1->start, p1->end - p1->start));
+    Lexeme attropt (input.substr(p2->start, p2->end - p2->start));
 
     // COLLECT INTO SEMANTIC ENGINE
     return instr_engine.Collect_Attribute(attr, attropt);
@@ -217,13 +223,15 @@ Arcana::Support::SemanticOutput Parser::Handle_TaskDecl(Grammar::Match& match)
 
     // SLICE HEADER LINE
     Input  header_line = lexer[p1->token];
-    Lexeme task        = header_line.substr(p1->start, p1->end - p1->start);
+    Lexeme task        (header_line.substr(p1->start, p1->end - p1->start));
 
     // COMPUTE BODY LINE RANGE
     const std::size_t line_begin = bbody->token.line;
     const std::size_t line_end   = ebody->token.line;
 
-    std::string instr;
+    Input instr;
+
+    body.reserve(line_end - line_begin + 1);
 
     // HANDLE SINGLE-LINE BODY
     if (line_begin == line_end)
@@ -239,9 +247,9 @@ Arcana::Support::SemanticOutput Parser::Handle_TaskDecl(Grammar::Match& match)
             instr = line.substr(start, end - start);
 
             // SKIP EMPTY/WHITESPACE-ONLY INSTRUCTIONS
-            if (!Support::ltrim(instr).empty())
+            if (!Support::is_blank(instr))
             {
-                body.push_back(instr);
+                body.emplace_back(instr);
             }
         }
     }
@@ -257,9 +265,9 @@ Arcana::Support::SemanticOutput Parser::Handle_TaskDecl(Grammar::Match& match)
                 instr = line.substr(start);
 
                 // SKIP EMPTY/WHITESPACE-ONLY INSTRUCTIONS
-                if (!instr.empty() && !Support::ltrim(instr).empty())
+                if (!Support::is_blank(instr))
                 {
-                    body.push_back(instr);
+                    body.emplace_back(instr);
                 }
             }
         }
@@ -272,7 +280,7 @@ Arcana::Support::SemanticOutput Parser::Handle_TaskDecl(Grammar::Match& match)
 
             if (!instr.empty())
             {
-                body.push_back(instr);
+                body.emplace_back(instr);
             }
         }
    
@@ -286,16 +294,16 @@ Arcana::Support::SemanticOutput Parser::Handle_TaskDecl(Grammar::Match& match)
                 instr = line.substr(0, end);
 
                 // SKIP EMPTY/WHITESPACE-ONLY INSTRUCTIONS
-                if (!instr.empty() && !Support::ltrim(instr).empty())
+                if (!Support::is_blank(instr))
                 {
-                    body.push_back(instr);
+                    body.emplace_back(instr);
                 }
             }
         }
     }
 
     // COLLECT INTO SEMANTIC ENGINE
-    return instr_engine.Collect_Task(task, body);
+    return instr_engine.Collect_Task(task, std::move(body));
 }
 
 
@@ -316,12 +324,11 @@ Arcana_Result Parser::Handle_Import(Grammar::Match& match, Semantic::Enviroment&
     Point  p1     = match[_I(Grammar::IMPORT::SCRIPT)];
 
     Input  input  = lexer[p1->token];
-    Lexeme script = input.substr(p1->start, p1->end - p1->start);
+    Lexeme script (input.substr(p1->start, p1->end - p1->start));
 
-    // VALIDATE IMPORT PATH
-    if (script.empty() || !Support::file_exists(script))
+    // REPORT AN ERROR ON THE IMPORT STATEMENT (SAME STYLE AS OTHER DIAGNOSTICS)
+    auto report = [&] (const std::string& err)
     {
-        // BUILD ERROR MESSAGE (SAME STYLE AS OTHER DIAGNOSTICS)
         std::stringstream ss;
 
         ss << "[" << ANSI_BRED << "SEMANTIC ERROR" << ANSI_RESET << "] In file "
@@ -329,11 +336,48 @@ Arcana_Result Parser::Handle_Import(Grammar::Match& match, Semantic::Enviroment&
            << ", line " << ANSI_BOLD << match[0]->token.line << ": "
            << lexer[match[0]->token] << ANSI_RESET << std::endl;
 
-        ss << "                 " << "Invalid import file" << std::endl;
+        ss << "                 " << err << std::endl;
 
         std::cerr << ss.str();
 
         return Arcana_Result::ARCANA_RESULT__NOK;
+    };
+
+    // PREFETCH WORKERS ONLY USE ALREADY PARSED IMPORTS, FAILING SILENTLY OTHERWISE
+    if (imports_only)
+    {
+        const Semantic::Enviroment* cached = imports ? imports->Find(script, instr_engine) : nullptr;
+
+        if (!cached)
+        {
+            return Arcana_Result::ARCANA_RESULT__NOK;
+        }
+
+        new_env = *cached;
+
+        if (Semantic::EnvMerge(instr_engine.EnvRef(), std::move(new_env)).has_value())
+        {
+            return Arcana_Result::ARCANA_RESULT__NOK;
+        }
+
+        return Arcana_Result::ARCANA_RESULT__OK;
+    }
+
+    // VALIDATE IMPORT PATH
+    if (script.empty() || !Support::file_exists(script))
+    {
+        return report("Invalid import file");
+    }
+
+    // REUSE THE PRE-PARSED ENVIRONMENT WHEN AVAILABLE
+    if (imports && imports->Take(script, new_env, instr_engine))
+    {
+        if (auto err = Semantic::EnvMerge(instr_engine.EnvRef(), std::move(new_env)); err.has_value())
+        {
+            return report(err.value());
+        }
+
+        return Arcana_Result::ARCANA_RESULT__OK;
     }
 
     // SPAWN IMPORT PARSER
@@ -346,15 +390,23 @@ Arcana_Result Parser::Handle_Import(Grammar::Match& match, Semantic::Enviroment&
     parser.Set_ParsingError_Handler    (Support::ParserError   {lexer});
     parser.Set_AnalisysError_Handler   (Support::SemanticError {lexer});
     parser.Set_PostProcessError_Handler(Support::PostProcError {lexer});
+    parser.Set_ImportCache             (imports);
 
     // PARSE IMPORT AND MERGE INTO CURRENT ENV ON SUCCESS
     result = parser.Parse(new_env);
 
     if (result == Arcana_Result::ARCANA_RESULT__OK)
     {
-        Semantic::EnvMerge(instr_engine.EnvRef(), new_env);
+        if (auto err = Semantic::EnvMerge(instr_engine.EnvRef(), std::move(new_env)); err.has_value())
+        {
+            result = report(err.value());
+        }
     }
 
+    // TRACK THE SCRIPTS THIS ENVIRONMENT WAS BUILT FROM
+    sources.push_back(script);
+    sources.insert(sources.end(), parser.Sources().begin(), parser.Sources().end());
+
     return result;
 }
 
@@ -378,8 +430,8 @@ Arcana::Support::SemanticOutput Parser::Handle_Using(Grammar::Match& match)
 
     // SLICE RAW INPUT LINE
     Input  input = lexer[p1->token];
-    Lexeme what  = input.substr(p1->start, p1->end - p1->start);
-    Lexeme opt   = input.substr(p2->start, p2->end - p2->start);
+    Lexeme what  (input.substr(p1->start, p1->end - p1->start));
+    Lexeme opt   (input.substr(p2->start, p2->end - p2->start));
 
     // COLLECT INTO SEMANTIC ENGINE
     return instr_engine.Collect_Using(what, opt);
@@ -405,8 +457,8 @@ Arcana::Support::SemanticOutput Parser::Handle_Mapping(Grammar::Match& match)
 
     // SLICE RAW INPUT LINE
     Input  input = lexer[p1->token];
-    Lexeme item1 = input.substr(p1->start, p1->end - p1->start);
-    Lexeme item2 = input.substr(p2->start, p2->end - p2->start);
+    Lexeme item1 (input.substr(p1->start, p1->end - p1->start));
+    Lexeme item2 (input.substr(p2->start, p2->end - p2->start));
 
     // COLLECT INTO SEMANTIC ENGINE
     return instr_engine.Collect_Mapping(item1, item2);
@@ -438,12 +490,384 @@ Arcana::Support::SemanticOutput Parser::Handle_Assert(Grammar::Match& match, boo
     Input  input  = lexer[p1->token];
 
     // EXTRACT SUBSTRINGS
-    Lexeme stmt   = input.substr(pStart->start, pStop->end - pStart->start);
-    Lexeme lvalue = input.substr(p1->start, p1->end - p1->start);
-    Lexeme op     = input.substr(p2->start, p2->end - p2->start);
-    Lexeme rvalue = input.substr(p3->start, p3->end - p3->start);
-    Lexeme reason = input.substr(p4->start, p4->end - p4->start);
+    Lexeme stmt   (input.substr(pStart->start, pStop->end - pStart->start));
+    Lexeme lvalue (input.substr(p1->start, p1->end - p1->start));
+    Lexeme op     (input.substr(p2->start, p2->end - p2->start));
+    Lexeme rvalue (input.substr(p3->start, p3->end - p3->start));
+    Lexeme reason (input.substr(p4->start, p4->end - p4->start));
 
     // COLLECT INTO SEMANTIC ENGINE
     return instr_engine.Collect_Assert(p1->token.line, stmt, lvalue, op, rvalue, reason, actions);
 }
+
+
+
+/**
+ * @brief Collect the script paths of top-level import statements.
+ *
+ * This is a token-level pre-scan, not a full parse: an import is recognized
+ * when the keyword starts a statement outside task bodies, and its script is
+ * the source span up to the statement terminator (the same span the grammar
+ * captures). A mismatch only costs a cache miss, never a wrong result.
+ *
+ * @param lexer Lexer over the script to scan.
+ * @return Import paths in source order.
+ */
+static std::vector<std::string> ScanImports(Arcana::Scan::Lexer& lexer)
+{
+    std::vector<std::string> scripts;
+    Arcana::Scan::Token              token;
+    std::size_t              depth = 0;
+    bool                     start = true;
+
+    auto terminator = [] (const Arcana::Scan::Token& t)
+    {
+        return t.type == Arcana::Scan::TokenType::NEWLINE || t.type == Arcana::Scan::TokenType::SEMICOLON || t.type == Arcana::Scan::TokenType::ENDOFFILE;
+    };
+
+    do
+    {
+        token = lexer.next();
+
+        if (start && depth == 0 && token.type == Arcana::Scan::TokenType::IMPORT)
+        {
+            Arcana::Scan::Token first = lexer.next();
+            Arcana::Scan::Token last  = first;
+
+            // READ THE SCRIPT SPAN UP TO THE TERMINATOR
+            for (token = first; !terminator(token); token = lexer.next())
+            {
+                last = token;
+            }
+
+            if (!terminator(first))
+            {
+                const std::string_view line = lexer[last];
+                const std::size_t      end  = last.start + last.lexeme.size();
+
+                if (first.start <= end && end <= line.size())
+                {
+                    scripts.emplace_back(line.substr(first.start, end - first.start));
+                }
+            }
+        }
+
+        // TRACK TASK BODIES AND STATEMENT BOUNDARIES
+        if (token.type == Arcana::Scan::TokenType::CURLYLP)
+        {
+            ++depth;
+        }
+        else if (token.type == Arcana::Scan::TokenType::CURLYRP && depth > 0)
+        {
+            --depth;
+        }
+
+        start = (token.type == Arcana::Scan::TokenType::NEWLINE || token.type == Arcana::Scan::TokenType::SEMICOLON);
+    }
+    while (token.type != Arcana::Scan::TokenType::ENDOFFILE);
+
+    return scripts;
+}
+
+
+
+/**
+ * @brief Pre-scan the import graph of a script and parse every imported file.
+ *
+ * Steps:
+ * - discover imported files breadth-first, deduplicating them by canonical
+ *   path and then by content hash (identical copies are parsed once)
+ * - order them in levels so that a file is parsed after everything it imports
+ * - parse each level concurrently; nested imports resolve through this cache
+ *
+ * Files in an import cycle never reach a level and stay uncached.
+ *
+ * @param root    Root script path.
+ * @param threads Maximum number of parsing threads.
+ */
+void ImportCache::Prefetch(const std::string& root, std::size_t threads) noexcept
+{
+    std::unordered_map<std::string, std::size_t> digests;
+    std::vector<std::vector<std::string>>        scanned;
+    std::vector<std::string>                     roots;
+
+    // REGISTER ONE SCRIPT, RETURNING ITS ENTRY INDEX (NPOS WHEN UNUSABLE)
+    auto discover = [&] (const std::string& script) -> std::size_t
+    {
+        std::error_code ec;
+
+        if (script.empty() || !Support::file_exists(script))
+        {
+            return npos;
+        }
+
+        const std::string canonical = std::filesystem::weakly_canonical(script, ec).string();
+
+        if (ec)
+        {
+            return npos;
+        }
+
+        if (auto it = _paths.find(canonical); it != _paths.end())
+        {
+            return it->second;
+        }
+
+        Scan::Lexer       lexer(script);
+        const std::string digest = Cache::MD5(std::string(lexer.buffer()));
+
+        // SAME CONTENT UNDER ANOTHER PATH SHARES THE ENTRY
+        if (auto it = digests.find(digest); it != digests.end())
+        {
+            _paths.emplace(canonical, it->second);
+            return it->second;
+        }
+
+        const std::size_t index = _entries.size();
+
+        _entries.emplace_back();
+        _entries.back().script = script;
+        scanned.push_back(ScanImports(lexer));
+
+        _paths.emplace(canonical, index);
+        digests.emplace(digest, index);
+
+        return index;
+    };
+
+    // SEED WITH THE ROOT IMPORTS
+    {
+        Scan::Lexer lexer(root);
+        roots = ScanImports(lexer);
+    }
+
+    for (const auto& script : roots)
+    {
+        if (const std::size_t index = discover(script); index != npos)
+        {
+            _entries[index].takes++;
+        }
+    }
+
+    // WALK THE GRAPH BREADTH-FIRST (ENTRIES GROW WHILE ITERATING)
+    for (std::size_t i = 0; i < _entries.size(); ++i)
+    {
+        for (const auto& script : scanned[i])
+        {
+            const std::size_t child = discover(script);
+
+            if (child != npos)
+            {
+                _entries[i].imports.push_back(child);
+            }
+        }
+    }
+
+    if (_entries.empty())
+    {
+        return;
+    }
+
+    // LEVEL THE GRAPH: A FILE IS READY ONCE ALL ITS IMPORTS ARE
+    std::vector<std::size_t>              waiting(_entries.size());
+    std::vector<std::vector<std::size_t>> dependents(_entries.size());
+    std::vector<std::size_t>              level;
+
+    for (std::size_t i = 0; i < _entries.size(); ++i)
+    {
+        waiting[i] = _entries[i].imports.size();
+
+        for (const auto child : _entries[i].imports)
+        {
+            dependents[child].push_back(i);
+        }
+
+        if (waiting[i] == 0)
+        {
+            level.push_back(i);
+        }
+    }
+
+    while (!level.empty())
+    {
+        std::atomic<std::size_t> next{0};
+
+        // PARSE ONE FILE OF THE CURRENT LEVEL, SILENTLY
+        auto worker = [&] ()
+        {
+            for (std::size_t k = next++; k < level.size(); k = next++)
+            {
+                Entry&          entry = _entries[level[k]];
+                Scan::Lexer     lexer(entry.script);
+                Grammar::Engine engine;
+                Parser          parser(lexer, engine);
+
+                parser.Set_ParsingError_Handler    ([] (const std::string&, const Grammar::Match&)                                  { return Arcana_Result::ARCANA_RESULT__NOK; });
+                parser.Set_AnalisysError_Handler   ([] (const std::string&, const Support::SemanticOutput&, const Grammar::Match&) { return Arcana_Result::ARCANA_RESULT__NOK; });
+                parser.Set_PostProcessError_Handler([] (const std::string&, const std::string&)                                     { return Arcana_Result::ARCANA_RESULT__NOK; });
+                parser.Set_ImportCache             (this, true);
+
+                entry.result  = parser.Parse(entry.env);
+                entry.symbols = parser.Deferred();
+            }
+        };
+
+        const std::size_t        count = std::min(std::max<std::size_t>(threads, 1), level.size());
+        std::vector<std::thread> pool;
+
+        pool.reserve(count - 1);
+
+        for (std::size_t t = 1; t < count; ++t)
+        {
+            pool.emplace_back(worker);
+        }
+
+        worker();
+
+        for (auto& t : pool)
+        {
+            t.join();
+        }
+
+        // NEXT LEVEL: DEPENDENTS WHOSE IMPORTS ARE ALL PARSED
+        std::vector<std::size_t> ready;
+
+        for (const auto i : level)
+        {
+            for (const auto parent : dependents[i])
+            {
+                if (--waiting[parent] == 0)
+                {
+                    ready.push_back(parent);
+                }
+            }
+        }
+
+        level.swap(ready);
+    }
+}
+
+
+
+/**
+ * @brief Resolve an import path to a successfully parsed entry.
+ *
+ * @param script Import path as written in the script.
+ * @return Entry index, or npos if missing or failed.
+ */
+std::size_t ImportCache::Lookup(const std::string& script) const noexcept
+{
+    std::error_code ec;
+
+    if (_paths.empty() || script.empty())
+    {
+        return npos;
+    }
+
+    const std::string canonical = std::filesystem::weakly_canonical(script, ec).string();
+
+    if (ec)
+    {
+        return npos;
+    }
+
+    const auto it = _paths.find(canonical);
+
+    if (it == _paths.end() || _entries[it->second].result != Arcana_Result::ARCANA_RESULT__OK)
+    {
+        return npos;
+    }
+
+    return it->second;
+}
+
+
+
+/**
+ * @brief Look up the parsed environment of an imported script.
+ *
+ * @param script Import path as written in the script.
+ * @param engine Engine receiving the recorded symbol updates.
+ * @return Pointer to the cached environment, nullptr if missing, failed or clashing.
+ */
+const Arcana::Semantic::Enviroment* ImportCache::Find(const std::string& script, Semantic::Engine& engine) const noexcept
+{
+    const std::size_t index = Lookup(script);
+
+    if (index == npos || !engine.ApplySymbols(_entries[index].symbols))
+    {
+        return nullptr;
+    }
+
+    return &_entries[index].env;
+}
+
+
+
+/**
+ * @brief Hand out the parsed environment of a script imported by the root.
+ *
+ * A recorded main task clashing with the one already set makes the caller
+ * parse the script in place, so the diagnostic keeps its original position.
+ *
+ * @param script Import path as written in the script.
+ * @param env    Output environment (copied, or moved on the last expected use).
+ * @param engine Engine receiving the recorded symbol updates.
+ * @return True if the environment was available.
+ */
+bool ImportCache::Take(const std::string& script, Semantic::Enviroment& env, Semantic::Engine& engine) noexcept
+{
+    const std::size_t index = Lookup(script);
+
+    // APPLY THE SYMBOL UPDATES OF THE SCRIPT AT ITS IMPORT POSITION
+    if (index == npos || !engine.ApplySymbols(_entries[index].symbols))
+    {
+        return false;
+    }
+
+    Entry& entry = _entries[index];
+
+    // LAST EXPECTED USE: MOVE OUT AND DROP THE ENTRY FROM THE CACHE
+    if (entry.takes == 1)
+    {
+        entry.takes  = 0;
+        entry.result = Arcana_Result::ARCANA_RESULT__NOK;
+        env          = std::move(entry.env);
+    }
+    else
+    {
+        if (entry.takes > 1)
+        {
+            entry.takes--;
+        }
+
+        env = entry.env;
+    }
+
+    return true;
+}
+
+
+
+/**
+ * @brief Canonical paths of every script discovered by Prefetch().
+ *
+ * Paths sharing an entry through identical content are all listed.
+ *
+ * @return Discovered script paths, sorted.
+ */
+std::vector<std::string> ImportCache::Files() const noexcept
+{
+    std::vector<std::string> files;
+
+    files.reserve(_paths.size());
+
+    for (const auto& [path, _] : _paths)
+    {
+        files.push_back(path);
+    }
+
+    std::sort(files.begin(), files.end());
+
+    return files;
+}
@@ -7,34 +7,29 @@
 #include "TableHelper.h"
 #include "Profiler.h"
 
-#include <regex>
+#include <atomic>
 #include <memory>
 #include <thread>
 #include <charconv>
 #include <algorithm>
 #include <filesystem>
 #include <unordered_map>
+#include <unordered_set>
 
 USE_MODULE(Arcana::Semantic);
 
 namespace fs = std::filesystem;
 
 
-using AttributeMap = Arcana::Support::AbstractKeywordMap<Attr::Type>;
-using UsingMap     = Arcana::Support::AbstractKeywordMap<Using::Rule>;
-
-
-
 // ------------------------------
 // STATIC TABLES
 // ------------------------------
 
 
 /**
- * @brief Map of attribute name -> normalized Attr::Type.
+ * @brief Attribute name -> normalized Attr::Type (compile-time, case-insensitive).
  */
-static const AttributeMap Known_Attributes =
-{
+static constexpr auto Known_Attributes = Arcana::Support::make_keyword_map<Attr::Type>({
     { "profile"     , Attr::Type::PROFILE     },
     { "pub"         , Attr::Type::PUBLIC      },
     { "always"      , Attr::Type::ALWAYS      },
@@ -49,19 +44,41 @@ static const AttributeMap Known_Attributes =
     { "exclude"     , Attr::Type::EXCLUDE     },
     { "glob"        , Attr::Type::GLOB        },
     { "ifos"        , Attr::Type::IFOS        },
-};
+    { "pool"        , Attr::Type::POOL        },
+    { "weight"      , Attr::Type::WEIGHT      },
+});
+
+static_assert(Known_Attributes.valid(), "Known_Attributes: colliding keys");
+
+
+
+/**
+ * @brief Using keyword -> using kind (compile-time, case-insensitive).
+ */
+static constexpr auto Known_Usings = Arcana::Support::make_keyword_map<Using::Type>({
+    { "profiles", Using::Type::PROFILES    },
+    { "default" , Using::Type::INTERPRETER },
+    { "threads" , Using::Type::THREADS     },
+    { "ignore"  , Using::Type::IGNORE      },
+    { "pool"    , Using::Type::POOL        },
+});
+
+static_assert(Known_Usings.valid(), "Known_Usings: colliding keys");
 
 
 
 /**
- * @brief Map of using keyword -> semantic using rule.
+ * @brief Semantic rule of a using kind (only `using default` takes a sub-keyword).
  */
-static const UsingMap Known_Usings =
+static Using::Rule Using_Rule(const Using::Type type)
 {
-    { "profiles", { {               }, Using::Type::PROFILES    } },
-    { "default" , { { "interpreter" }, Using::Type::INTERPRETER } },
-    { "threads" , { {               }, Using::Type::THREADS     } },
-};
+    if (type == Using::Type::INTERPRETER)
+    {
+        return { { "interpreter" }, type };
+    }
+
+    return { {}, type };
+}
 
 
 
@@ -84,6 +101,8 @@ static const std::vector<std::string> _attributes =
     "exclude",
     "glob",
     "ifos",
+    "pool",
+    "weight",
 };
 
 
@@ -96,6 +115,8 @@ static const std::vector<std::string> _usings =
     "profiles",
     "default",
     "threads",
+    "ignore",
+    "pool",
 };
 
 
@@ -122,6 +143,59 @@ static const std::vector<std::string> _cache =
 
 
 
+// ------------------------------
+// PARALLEL HELPERS
+// ------------------------------
+
+/**
+ * @brief Run fn(state, i) for every i in [0, count) on up to `threads` workers.
+ *
+ * Each worker builds its own state with make_state(), so per-worker caches are
+ * never shared. Work is handed out with an atomic counter; callers write into
+ * per-index slots to keep results independent of scheduling.
+ */
+template <typename MakeState, typename Fn>
+static void ParallelFor(std::size_t count, std::size_t threads, MakeState make_state, Fn fn) noexcept
+{
+    std::atomic<std::size_t> next{0};
+
+    auto worker = [&] ()
+    {
+        auto state = make_state();
+
+        for (std::size_t i = next++; i < count; i = next++)
+        {
+            fn(state, i);
+        }
+    };
+
+    threads = std::min(threads, count);
+
+    // SMALL BATCHES RUN ON THE CALLING THREAD
+    if (threads <= 1)
+    {
+        worker();
+        return;
+    }
+
+    std::vector<std::thread> pool;
+    pool.reserve(threads - 1);
+
+    for (std::size_t t = 1; t < threads; ++t)
+    {
+        pool.emplace_back(worker);
+    }
+
+    worker();
+
+    for (auto& t : pool)
+    {
+        t.join();
+    }
+}
+
+
+
 
 
 
@@ -156,6 +230,8 @@ Engine::Engine()
     _attr_rules[_I(Attr::Type::CACHE       )] = { Attr::Qualificator::REQUIRED_PROPERTY, Attr::Count::UNLIMITED, { Attr::Target::TASK,                        } };
     _attr_rules[_I(Attr::Type::ECHO        )] = { Attr::Qualificator::NO_PROPERY       , Attr::Count::ZERO     , { Attr::Target::TASK,                        } };
     _attr_rules[_I(Attr::Type::IFOS        )] = { Attr::Qualificator::REQUIRED_PROPERTY, Attr::Count::ONE      , {                     Attr::Target::VARIABLE } };
+    _attr_rules[_I(Attr::Type::POOL        )] = { Attr::Qualificator::REQUIRED_PROPERTY, Attr::Count::ONE      , { Attr::Target::TASK,                        } };
+    _attr_rules[_I(Attr::Type::WEIGHT      )] = { Attr::Qualificator::REQUIRED_PROPERTY, Attr::Count::ONE      , { Attr::Target::TASK,                        } };
 }
 
 
@@ -174,9 +250,9 @@ SemanticOutput Engine::Collect_Attribute(const std::string& name, const std::str
     Attr::Properties property = Arcana::Support::split(prop);
 
     // RESOLVE ATTRIBUTE NAME TO TYPE
-    if (auto it = Known_Attributes.find(name); it != Known_Attributes.end())
+    if (const auto* type = Known_Attributes.find(name))
     {
-        attr = it->second;
+        attr = *type;
     }
 
     // HANDLE UNKNOWN ATTRIBUTE
@@ -230,12 +306,10 @@ SemanticOutput Engine::Collect_Attribute(const std::string& name, const std::str
     else if (attr == Attr::Type::MAP || attr == Attr::Type::EXCLUDE)
     {
         // VALIDATE REFERENCED VARIABLE EXISTS
-        auto keys = Table::Keys(_env.vtable);
-
-        if (std::find(keys.begin(), keys.end(), property[0]) == keys.end())
+        if (_env.vtable.find(property[0]) == _env.vtable.end())
         {
             ss << "Invalid " << name << " " << TOKEN_MAGENTA(property[0]) << ": undeclared variable";
-            return SEM_NOK_HINT(ss.str(), Support::FindClosest(keys, property[0]));
+            return SEM_NOK_HINT(ss.str(), Support::FindClosest(Table::Keys(_env.vtable), property[0]));
         }
     }
     else if (attr == Attr::Type::IFOS)
@@ -296,7 +370,7 @@ SemanticOutput Engine::Collect_Assignment(const std::string& name, const std::st
     InstructionAssign  assign { name, val };
 
     // ATTACH PENDING ATTRIBUTES AND CLEAR PENDING QUEUE
-    assign.attributes = _attr_pending;
+    assign.setAttributes(std::move(_attr_pending));
     _attr_pending.clear();
 
     // VALIDATE ATTRIBUTES TARGET VARIABLES
@@ -317,19 +391,17 @@ SemanticOutput Engine::Collect_Assignment(const std::string& name, const std::st
 
     if (attr_profile != assign.attributes.end())
     {
-        _env.vtable[Support::generate_mangling(name, (*attr_profile).props[0])] = assign;
+        _env.vtable[Support::generate_mangling(name, (*attr_profile).props[0])] = std::move(assign);
     }
     else if (attr_if != assign.attributes.end())
     {
-        _env.vtable[Support::generate_mangling(name, (*attr_if).props[0])] = assign;
+        _env.vtable[Support::generate_mangling(name, (*attr_if).props[0])] = std::move(assign);
     }
     else
     {
         if (join) 
         {
-            const auto& keys = Table::Keys(_env.vtable);
-
-            if (std::find(keys.begin(), keys.end(), name) == keys.end())
+            if (_env.vtable.find(name) == _env.vtable.end())
             {
                 #warning handle error
             } 
@@ -339,7 +411,7 @@ SemanticOutput Engine::Collect_Assignment(const std::string& name, const std::st
         }
         else
         {
-            _env.vtable[name] = assign;
+            _env.vtable[name] = std::move(assign);
         }
     }
 
@@ -352,19 +424,19 @@ SemanticOutput Engine::Collect_Assignment(const std::string& name, const std::st
  * @brief Collect a task declaration into the environment FTable.
  * @param name   Task name.
  * @param inputs Raw inputs string (split into tokens).
- * @param instrs Instruction lines.
+ * @param instrs Instruction lines (moved into the task).
  * @return SemanticOutput with status.
  */
-SemanticOutput Engine::Collect_Task(const std::string& name, const Task::Instrs& instrs)
+SemanticOutput Engine::Collect_Task(const std::string& name, Task::Instrs&& instrs)
 {
     std::stringstream ss;
 
     // BUILD TASK INSTRUCTION
-    InstructionTask task { name, instrs };
+    InstructionTask task { name, std::move(instrs) };
     FTable&         ftable = _env.ftable;
 
     // ATTACH PENDING ATTRIBUTES AND CLEAR PENDING QUEUE
-    task.attributes = _attr_pending;
+    task.setAttributes(std::move(_attr_pending));
     _attr_pending.clear();
 
     // VALIDATE ATTRIBUTES TARGET TASKS
@@ -383,18 +455,19 @@ SemanticOutput Engine::Collect_Task(const std::string& name, const Task::Instrs&
     if (task.hasAttribute(Attr::Type::PROFILE))
     {
         const auto profile = task.getProperties(Attr::Type::PROFILE);
+        const bool is_main = task.hasAttribute(Attr::Type::MAIN);
 
-        ftable[Support::generate_mangling(name, profile[0])] = task;
+        ftable[Support::generate_mangling(name, profile[0])] = std::move(task);
 
-        if (task.hasAttribute(Attr::Type::MAIN))
+        if (is_main)
         {
-            if (!Core::is_symbol_set(Core::SymbolType::MAIN))
+            if (!IsMainSet())
             {
-                Core::update_symbol(Core::SymbolType::MAIN, name);
+                SetMain(name);
             }
             else
             {
-                if (Core::symbol(Core::SymbolType::MAIN) != name)
+                if ((_defer_symbols ? _deferred.main : Core::symbol(Core::SymbolType::MAIN)) != name)
                 {
                     ss << "Cannot tag multiple tasks with attribute " << TOKEN_MAGENTA("main");
                     return SEM_NOK(ss.str());
@@ -404,13 +477,15 @@ SemanticOutput Engine::Collect_Task(const std::string& name, const Task::Instrs&
     }
     else
     {
-        ftable[name] = task;
+        const bool is_main = task.hasAttribute(Attr::Type::MAIN);
 
-        if (task.hasAttribute(Attr::Type::MAIN))
+        ftable[name] = std::move(task);
+
+        if (is_main)
         {
-            if (!Core::is_symbol_set(Core::SymbolType::MAIN))
+            if (!IsMainSet())
             {
-                Core::update_symbol(Core::SymbolType::MAIN, name);
+                SetMain(name);
             }
             else
             {
@@ -425,6 +500,80 @@ SemanticOutput Engine::Collect_Task(const std::string& name, const Task::Instrs&
 
 
 
+/**
+ * @brief Apply symbol updates recorded by a deferred engine, in import order.
+ * @param symbols Recorded updates.
+ * @return false (nothing applied) if the recorded main task clashes.
+ */
+bool Engine::ApplySymbols(const DeferredSymbols& symbols) noexcept
+{
+    // A SECOND MAIN TASK IS REPORTED BY COLLECTING THE SCRIPT AGAIN
+    if (!symbols.main.empty() && IsMainSet())
+    {
+        return false;
+    }
+
+    if (!symbols.main.empty())
+    {
+        SetMain(symbols.main);
+    }
+
+    if (!symbols.threads.empty())
+    {
+        SetThreads(symbols.threads);
+    }
+
+    return true;
+}
+
+
+
+/**
+ * @brief True if a main task was already tagged.
+ */
+bool Engine::IsMainSet() const noexcept
+{
+    return _defer_symbols ? !_deferred.main.empty() : Core::is_symbol_set(Core::SymbolType::MAIN);
+}
+
+
+
+/**
+ * @brief Set the main task symbol.
+ * @param name Main task name.
+ */
+void Engine::SetMain(const std::string& name) noexcept
+{
+    if (_defer_symbols)
+    {
+        _deferred.main = name;
+    }
+    else
+    {
+        Core::update_symbol(Core::SymbolType::MAIN, name);
+    }
+}
+
+
+
+/**
+ * @brief Set the threads symbol.
+ * @param threads Thread count.
+ */
+void Engine::SetThreads(const std::string& threads) noexcept
+{
+    if (_defer_symbols)
+    {
+        _deferred.threads = threads;
+    }
+    else
+    {
+        Core::update_symbol(Core::SymbolType::THREADS, threads);
+    }
+}
+
+
+
 /**
  * @brief Collect a `using` directive and update environment configuration.
  * @param what Directive keyword (e.g. profiles/default/threads).
@@ -438,9 +587,9 @@ SemanticOutput Engine::Collect_Using(const std::string& what, const std::string&
     Using::Rule       rule;
 
     // RESOLVE USING RULE
-    if (auto it = Known_Usings.find(what); it != Known_Usings.end())
+    if (const auto* type = Known_Usings.find(what))
     {
-        rule = it->second;
+        rule = Using_Rule(*type);
     }
     else
     {
@@ -547,7 +696,59 @@ SemanticOutput Engine::Collect_Using(const std::string& what, const std::string&
 
         // STORE THREADS CONFIG
         _env.max_threads = max_threads;
-        Core::update_symbol(Core::SymbolType::THREADS, std::to_string(max_threads));
+        SetThreads(std::to_string(max_threads));
+    }
+    else if (rule.using_type == Using::Type::IGNORE)
+    {
+        // DEFAULT TO GIT AND ARCANA IGNORE FILES
+        if (options.size() == 0)
+        {
+            options = { ".gitignore", ".arcignore" };
+        }
+
+        // COLLECT UNIQUE IGNORE FILE NAMES
+        for (const auto& file : options)
+        {
+            if (file.find('/') != std::string::npos)
+            {
+                ss << "Ignore file " << TOKEN_MAGENTA(file) << " must be a file name, not a path";
+                return SEM_NOK(ss.str());
+            }
+
+            if (std::find(_env.ignore_files.begin(), _env.ignore_files.end(), file) == _env.ignore_files.end())
+            {
+                _env.ignore_files.push_back(file);
+            }
+        }
+    }
+    else if (rule.using_type == Using::Type::POOL)
+    {
+        // VALIDATE POOL NAME AND SIZE
+        if (options.size() != 2)
+        {
+            ss << "Statement " << TOKEN_MAGENTA("using pool") << " must be followed by pool name and size";
+            return SEM_NOK(ss.str());
+        }
+
+        // PARSE INT VALUE
+        int         size  = 0;
+        const char* begin = options[1].data();
+        const char* end   = options[1].data() + options[1].size();
+
+        auto [ptr, ec] = std::from_chars(begin, end, size);
+
+        if (ec != std::errc{} || ptr != end || size <= 0)
+        {
+            ss << "Invalid size for pool " << TOKEN_MAGENTA(options[0]) << ": " << TOKEN_MAGENTA(options[1]) << ". Expected a positive integer.";
+            return SEM_NOK(ss.str());
+        }
+
+        // STORE UNIQUE POOL
+        if (!_env.pools.emplace(options[0], static_cast<uint32_t>(size)).second)
+        {
+            ss << "Duplicate item in statement " << TOKEN_MAGENTA("using pool") << ": " << TOKEN_MAGENTA(options[0]) << ANSI_RESET;
+            return SEM_NOK(ss.str());
+        }
     }
 
     return SEM_OK();
@@ -584,7 +785,7 @@ SemanticOutput Engine::Collect_Mapping(const std::string& item_1, const std::str
     }
 
     // ATTACH @map ATTRIBUTE TO DESTINATION VARIABLE
-    it_item2->second.attributes.push_back({
+    it_item2->second.addAttribute({
         "map",
         Attr::Type::MAP,
         { item_1 }
@@ -745,7 +946,7 @@ Arcana_Result Enviroment::CheckArgs(const Arcana::Support::Arguments& args) noex
             old_main_task.value().get().removeAttribute(Attr::Type::MAIN);
         }
 
-        task.value().get().attributes.push_back({
+        task.value().get().addAttribute({
             "main",
             Attr::Type::MAIN,
             {}
@@ -770,6 +971,93 @@ Arcana_Result Enviroment::CheckArgs(const Arcana::Support::Arguments& args) noex
 
 
 
+/**
+ * @brief Rebuild the attribute index in a single pass over the task table.
+ */
+void Enviroment::IndexTasks() noexcept
+{
+    for (auto& slot : task_index.by_attr) slot.clear();
+
+    for (auto& [name, task] : ftable)
+    {
+        for (std::size_t t = 0; t < task_index.by_attr.size(); ++t)
+        {
+            if (task.attr_mask & (Attr::Mask(1) << t)) task_index.by_attr[t].push_back(&task);
+        }
+    }
+
+    task_index.built = true;
+}
+
+
+
+/**
+ * @brief Tasks carrying an attribute, in table order.
+ * @param attr Attribute type.
+ * @return Indexed task list (possibly empty).
+ */
+const std::vector<InstructionTask*>& Enviroment::TasksWith(const Attr::Type attr) noexcept
+{
+    if (!task_index.built)
+    {
+        IndexTasks();
+    }
+
+    return task_index.by_attr[_I(attr)];
+}
+
+
+
+/**
+ * @brief Validate task pools and weights against the declared resource pools.
+ *
+ * Runs after AlignEnviroment(), on the tasks of the selected profile.
+ *
+ * @return ARCANA_RESULT__OK or ARCANA_RESULT__NOK.
+ */
+Arcana_Result Enviroment::CheckPools() noexcept
+{
+    for (auto* entry : TasksWith(Attr::Type::POOL))
+    {
+        const auto& pool = entry->getProperties(Attr::Type::POOL).at(0);
+
+        if (pools.find(pool) == pools.end())
+        {
+            ERR("Undefined pool " << TOKEN_MAGENTA(pool) << " for task " << TOKEN_MAGENTA(entry->task_name));
+
+            std::vector<std::string> names;
+            for (const auto& [name, _] : pools) names.push_back(name);
+
+            auto closest = Support::FindClosest(names, pool);
+
+            if (closest)
+            {
+                HINT("Did you mean " << ANSI_BCYAN << closest.value() << ANSI_RESET << "?");
+            }
+
+            return Arcana_Result::ARCANA_RESULT__NOK;
+        }
+    }
+
+    for (auto* entry : TasksWith(Attr::Type::WEIGHT))
+    {
+        const auto& weight = entry->getProperties(Attr::Type::WEIGHT).at(0);
+        int         value  = 0;
+
+        auto [ptr, ec] = std::from_chars(weight.data(), weight.data() + weight.size(), value);
+
+        if (ec != std::errc{} || ptr != weight.data() + weight.size() || value <= 0)
+        {
+            ERR("Invalid weight " << TOKEN_MAGENTA(weight) << " for task " << TOKEN_MAGENTA(entry->task_name) << ". Expected a positive integer.");
+            return Arcana_Result::ARCANA_RESULT__NOK;
+        }
+    }
+
+    return Arcana_Result::ARCANA_RESULT__OK;
+}
+
+
+
 /**
  * @brief Resolve dependencies/then links and finalize interpreter defaults.
  * @return Empty optional on success, error string on failure.
@@ -778,17 +1066,18 @@ const std::optional<std::string> Enviroment::AlignEnviroment() noexcept
 {
     std::stringstream ss;
 
+    // PROFILE/OS ALIGNMENT IS DONE: THE TASK TABLE IS FINAL, INDEX IT
+    IndexTasks();
+
     // RESOLVE REQUIRES/THEN LINKS
     const std::array<Attr::Type, 2> attributes = { Attr::Type::REQUIRES, Attr::Type::THEN };
 
     for (const auto attr : attributes)
     {
-        auto tasks = Table::GetValues(ftable, profile.profiles, attr);
-
-        for (auto& ref : tasks)
+        for (auto* entry : TasksWith(attr))
         {
-            auto& task  = ref.get();
-            auto  props = task.getProperties(attr);
+            auto& task  = *entry;
+            auto& props = task.getProperties(attr);
 
             // VALIDATE AND LINK REFERENCED TASKS
             for (auto& p : props)
@@ -846,234 +1135,502 @@ const std::optional<std::string> Enviroment::AlignEnviroment() noexcept
 
 
 /**
- * @brief Expand variables/internals, compute glob expansions, expand tasks and asserts.
- * @return Empty optional on success, error string on failure.
+ * @brief Collect the tasks and variables a run can actually touch.
+ * @param ex Expander used to scan references.
+ * @param wanted Extra task or variable root (may be empty).
+ * @param tasks Output set of reachable tasks.
+ * @param vars Output set of referenced variable keys.
  */
-const std::optional<std::string> Enviroment::Expand() noexcept
+void Enviroment::CollectReachable(Expander& ex, const std::string& wanted,
+                                  std::unordered_set<const InstructionTask*>& tasks,
+                                  std::unordered_set<std::string>& vars) noexcept
 {
-    Expander ex(*this);
+    std::vector<const InstructionTask*> stack;
+    std::vector<std::string>            refs;
 
-    // COMPUTE MAX THREADS DEFAULT
-    auto machine_max_threads = std::thread::hardware_concurrency();
+    auto visit = [&] (const InstructionTask& task)
+    {
+        if (tasks.insert(&task).second) stack.push_back(&task);
+    };
 
-    if (max_threads == 0 || max_threads > machine_max_threads)
+    auto visit_name = [&] (const std::string& name)
     {
-        max_threads = machine_max_threads;
+        if (auto it = ftable.find(name); it != ftable.end()) visit(it->second);
+    };
+
+    // TASK ROOTS: MAIN, ALWAYS, ASSERT CALLBACKS AND THE REQUESTED ITEM
+    if (const auto& main_task = TasksWith(Attr::Type::MAIN); !main_task.empty())
+    {
+        visit(*main_task.front());
     }
 
-    // COLLECT VARIABLE KEYS FOR INPUT VALIDATION
-    auto var_keys = Table::Keys(vtable);
+    for (const auto* task : TasksWith(Attr::Type::ALWAYS)) visit(*task);
 
-    if (var_keys.empty())
+    for (const auto& assert : atable)
     {
-        return std::nullopt;
+        for (const auto& action : assert.actions) visit_name(action);
     }
 
-    // SORT BY LENGTH (LONGEST FIRST)
-    std::sort(var_keys.begin(), var_keys.end(), [] (const std::string& a, const std::string& b) {
-        return a.size() > b.size();
-    });
-    
-    // EXPAND VTABLE AND COMPUTE GLOB EXPANSIONS
-    Glob::ExpandOptions opt;
+    visit_name(wanted);
 
-    for (auto& [name, var] : vtable)
+    // FOLLOW TASK LINKS AND COLLECT THEIR VARIABLE REFERENCES
+    while (!stack.empty())
     {
-        // EXPAND GLOB TO LIST
-        var.glob_expansion.clear();
-
-        for (auto& value : var.var_value)
-        {
-            // EXPAND TEXT TOKENS
-            if (auto err = ex.ExpandText(value, {}); err.has_value())
-            {
-                return err;
-            }
+        const InstructionTask* task = stack.back();
+        stack.pop_back();
 
-            if (!var.hasAttribute(Attr::Type::GLOB)) continue;
-    
-            // PARSE GLOB PATTERN
-            Glob::Pattern    pattern;
-            Glob::ParseError error;
+        for (const auto& dep  : task->dependencies) visit(dep.get());
+        for (const auto& then : task->thens)        visit(then.get());
 
-            if (!Glob::Parse(value, pattern, error))
-            {
-                std::stringstream ss;
-                ss << "While expanding " << TOKEN_MAGENTA(name)
-                   << " an invalid glob was detected " << TOKEN_MAGENTA(pattern.normalized)
-                   << ": " << ParseErrorRepr(error);
-    
-                return ss.str();
-            }
+        for (const auto& instr : task->task_instrs)
+        {
+            ex.ExtractVarRefs(instr, refs);
+        }
 
-            Arcana::Glob::Expand(pattern, ".", var.glob_expansion, opt);
+        for (const auto& attr : task->attributes)
+        {
+            for (const auto& prop : attr.props) ex.ExtractVarRefs(prop, refs);
         }
     }
 
-    
-    // HANDLE MAPPED VARS EXPANSION
-    auto map_required = Table::GetValues(vtable, Semantic::Attr::Type::MAP);
+    // ASSERTS ARE ALWAYS EVALUATED
+    for (const auto& assert : atable)
+    {
+        ex.ExtractVarRefs(assert.lvalue, refs);
+        ex.ExtractVarRefs(assert.rvalue, refs);
+        ex.ExtractVarRefs(assert.reason, refs);
+    }
 
-    if (!map_required.has_value()) return std::nullopt;
+    refs.push_back(wanted);
 
-    for (auto& stmt : map_required.value())
+    // CLOSE OVER VALUE REFERENCES, EXCLUDE LISTS AND MAP SOURCES
+    while (!refs.empty())
     {
-        Glob::ParseError e1, e2;
-        Glob::MapError   m1;
+        const std::string name = std::move(refs.back());
+        refs.pop_back();
 
-        auto& map_to   = stmt.get();
-        auto& map_from = vtable[map_to.getProperties(Semantic::Attr::Type::MAP).at(0)];
+        auto it = vtable.find(name);
 
-        if (!Arcana::Glob::MapGlobToGlob(map_from.var_value, map_to.var_value[0],
-                                            map_from.glob_expansion, map_to.glob_expansion, e1, e2, m1))
+        if (it == vtable.end() || !vars.insert(name).second) continue;
+
+        const auto& var = it->second;
+
+        for (const auto& value : var.var_value)
         {
-            std::stringstream ss;
-            ss << "While mapping " << TOKEN_MAGENTA(map_from.var_name)
-                << " to " << TOKEN_MAGENTA(map_to.var_name)
-                << ": incompatible globs";
+            ex.ExtractVarRefs(value, refs);
+        }
 
-            return ss.str();
+        for (const auto attr : { Attr::Type::EXCLUDE, Attr::Type::MAP })
+        {
+            if (!var.hasAttribute(attr)) continue;
+
+            const auto& properties = var.getProperties(attr);
+
+            if (!properties.empty()) refs.push_back(properties[0]);
         }
     }
+}
 
-    // EXPAND ASSERTS
-    auto keys = Table::Keys(ftable);
 
-    for (auto& assert : atable)
-    {
-        for (const auto& action : assert.actions)
+
+/**
+ * @brief Order variables into levels of the `{arc:NAME}` dependency graph.
+ * @param ex Expander used to scan references.
+ * @param vars Variable keys to order.
+ * @param levels Output levels, in expansion order.
+ * @return Empty optional on success, error string on circular references.
+ */
+std::optional<std::string> Enviroment::LevelVariables(Expander& ex, const std::unordered_set<std::string>& vars,
+                                                      std::vector<std::vector<InstructionAssign*>>& levels) noexcept
+{
+    std::vector<InstructionAssign*>              nodes;
+    std::vector<const std::string*>              names;
+    std::unordered_map<std::string, std::size_t> index;
+
+    for (auto& [name, var] : vtable)
+    {
+        if (!vars.count(name)) continue;
+
+        index.emplace(name, nodes.size());
+        nodes.push_back(&var);
+        names.push_back(&name);
+    }
+
+    // EDGES GO FROM A VARIABLE TO THE VARIABLES THAT REFERENCE IT
+    std::vector<std::vector<std::size_t>> users(nodes.size());
+    std::vector<std::size_t>              pending(nodes.size(), 0);
+    std::vector<std::string>              refs;
+
+    for (std::size_t i = 0; i < nodes.size(); ++i)
+    {
+        refs.clear();
+
+        for (const auto& value : nodes[i]->var_value)
         {
-            if (std::find(keys.begin(), keys.end(), action) == keys.end())
+            ex.ExtractVarRefs(value, refs);
+        }
+
+        std::sort(refs.begin(), refs.end());
+        refs.erase(std::unique(refs.begin(), refs.end()), refs.end());
+
+        // UNKNOWN NAMES ARE REPORTED BY THE EXPANSION ITSELF
+        for (const auto& ref : refs)
+        {
+            if (auto it = index.find(ref); it != index.end())
             {
-                std::stringstream ss;
-                ss << "Callback " << TOKEN_MAGENTA(action) << " is undefined in statement " << TOKEN_CYAN("assert");
-                
-                if (auto closest = Support::FindClosest(keys, action); closest.has_value() )
-                {
-                    ss << std::endl << "[" << TOKEN_GREEN("HINT") << "] Did you mean " << TOKEN_CYAN(closest.value()) << "?";
-                }
+                users[it->second].push_back(i);
+                ++pending[i];
+            }
+        }
+    }
 
-                return ss.str();
+    // KAHN TRAVERSAL, ONE FRONTIER PER LEVEL
+    std::vector<std::size_t> frontier;
+    std::vector<std::size_t> next;
+    std::size_t              done = 0;
+
+    for (std::size_t i = 0; i < nodes.size(); ++i)
+    {
+        if (pending[i] == 0) frontier.push_back(i);
+    }
+
+    while (!frontier.empty())
+    {
+        auto& level = levels.emplace_back();
+
+        next.clear();
+
+        for (const auto i : frontier)
+        {
+            level.push_back(nodes[i]);
+            ++done;
+
+            for (const auto u : users[i])
+            {
+                if (--pending[u] == 0) next.push_back(u);
             }
         }
 
-        if (auto err = ex.ExpandAssertSide(assert.lvalue, assert); err.has_value())
+        frontier.swap(next);
+    }
+
+    if (done != nodes.size())
+    {
+        std::stringstream ss;
+        ss << "Circular reference between variables";
+
+        for (std::size_t i = 0; i < nodes.size(); ++i)
         {
-            return err;
+            if (pending[i] != 0) ss << " " << TOKEN_MAGENTA(*names[i]);
         }
 
-        if (auto err = ex.ExpandAssertSide(assert.rvalue, assert); err.has_value())
+        return ss.str();
+    }
+
+    return std::nullopt;
+}
+
+
+
+/**
+ * @brief Expand variables/internals, compute glob expansions, expand tasks and asserts.
+ * @param wanted Item requested with `--value`, expanded as an extra root.
+ * @return Empty optional on success, error string on failure.
+ */
+const std::optional<std::string> Enviroment::Expand(const std::string& wanted) noexcept
+{
+    Expander ex(*this);
+
+    // COMPUTE MAX THREADS DEFAULT
+    auto machine_max_threads = std::thread::hardware_concurrency();
+
+    if (max_threads == 0 || max_threads > machine_max_threads)
+    {
+        max_threads = machine_max_threads;
+    }
+
+    // COLLECT VARIABLE KEYS FOR INPUT VALIDATION
+    auto var_keys = Table::Keys(vtable);
+
+    if (var_keys.empty())
+    {
+        return std::nullopt;
+    }
+
+    // SORT BY LENGTH (LONGEST FIRST)
+    std::sort(var_keys.begin(), var_keys.end(), [] (const std::string& a, const std::string& b) {
+        return a.size() > b.size();
+    });
+    
+    // EXPAND VTABLE AND COLLECT GLOB PATTERNS
+    Glob::ExpandOptions                    opt;
+    std::vector<Glob::Pattern>             patterns;
+    std::vector<InstructionAssign*>        owners;
+    std::vector<std::vector<std::string>>  expansions;
+
+    // REUSE DIRECTORY LISTINGS FROM PREVIOUS RUNS
+    opt.listing_cache = Cache::Manager::Instance().GlobListingPath();
+
+    // HONOUR IGNORE FILES REQUESTED BY `using ignore`
+    opt.ignore_files  = ignore_files;
+
+    // ONLY WHAT THE RUN CAN REACH IS EXPANDED AND GLOBBED
+    std::unordered_set<const InstructionTask*> reachable;
+    std::unordered_set<std::string>            referenced;
+
+    CollectReachable(ex, wanted, reachable, referenced);
+
+    // ONLY A PASS REACHING EVERY @glob VARIABLE KNOWS WHICH LISTINGS WENT UNUSED
+    opt.prune_listing_cache = std::all_of(vtable.begin(), vtable.end(), [&] (const auto& kv)
+    {
+        return !kv.second.hasAttribute(Attr::Type::GLOB) || referenced.count(kv.first) != 0;
+    });
+
+    // VARIABLES WHOSE FILES ARE CHECKED BY @cache TASKS
+    std::vector<std::string> cache_refs;
+
+    for (auto& [name, task] : ftable)
+    {
+        if (!reachable.count(&task) || !task.hasAttribute(Attr::Type::CACHE)) continue;
+
+        const auto& properties = task.getProperties(Attr::Type::CACHE);
+
+        if (properties[0] == "untrack") continue;
+
+        for (std::size_t i = 1; i < properties.size(); ++i)
         {
-            return err;
+            ex.ExtractVarRefs(properties[i], cache_refs);
         }
+    }
 
-        if (auto err = ex.ExpandText(assert.reason, {}); err.has_value())
+    // EXPAND VARIABLES LEVEL BY LEVEL, EACH LEVEL IN PARALLEL
+    std::vector<std::vector<InstructionAssign*>> levels;
+
+    if (auto err = LevelVariables(ex, referenced, levels); err.has_value())
+    {
+        return err;
+    }
+
+    for (const auto& level : levels)
+    {
+        std::vector<std::optional<std::string>> errors(level.size());
+
+        ParallelFor(level.size(), max_threads, [this] { return Expander(*this); }, [&] (Expander& local, std::size_t i)
         {
-            return err;
+            errors[i] = local.ExpandVariable(*level[i]);
+        });
+
+        for (auto& err : errors)
+        {
+            if (err.has_value()) return err;
         }
     }
 
-    // EXPAND FTABLE
-    for (auto& [name, task] : ftable)
+    std::vector<std::uint8_t> prefetch;
+
+    for (auto& [name, var] : vtable)
     {
-        if (task.cache.enabled = task.hasAttribute(Attr::Type::CACHE); task.cache.enabled)
+        if (!referenced.count(name)) continue;
+
+        var.glob_expansion.clear();
+
+        for (auto& value : var.var_value)
         {
-            auto properties = task.getProperties(Attr::Type::CACHE);
+            if (!var.hasAttribute(Attr::Type::GLOB)) continue;
+    
+            // PARSE GLOB PATTERN
+            Glob::Pattern    pattern;
+            Glob::ParseError error;
 
-            if (properties[0] == "track")
+            if (!Glob::Parse(value, pattern, error))
             {
-                task.cache.type = InstructionTask::Cache::Type::TRACK;
+                std::stringstream ss;
+                ss << "While expanding " << TOKEN_MAGENTA(name)
+                   << " an invalid glob was detected " << TOKEN_MAGENTA(pattern.normalized)
+                   << ": " << ParseErrorRepr(error);
+    
+                return ss.str();
             }
-            else if (properties[0] == "untrack")
+
+            patterns.push_back(std::move(pattern));
+            owners.push_back(&var);
+            prefetch.push_back(std::find(cache_refs.begin(), cache_refs.end(), name) != cache_refs.end());
+        }
+    }
+
+    // COMPILE @exclude VARIABLES ONCE, SCOPED TO THE GLOBS THAT REFERENCE THEM
+    std::map<std::string, std::vector<std::size_t>> excludes;
+    std::vector<std::vector<std::size_t>>           scopes(patterns.size());
+
+    for (std::size_t p = 0; p < patterns.size(); ++p)
+    {
+        if (!owners[p]->hasAttribute(Attr::Type::EXCLUDE)) continue;
+
+        const std::string excl_name = owners[p]->getProperties(Attr::Type::EXCLUDE).at(0);
+        auto              inserted  = excludes.try_emplace(excl_name);
+
+        if (inserted.second)
+        {
+            auto it = vtable.find(excl_name);
+
+            if (it == vtable.end())
             {
-                task.cache.type = InstructionTask::Cache::Type::UNTRACK;
+                std::stringstream ss;
+                ss << "While expanding " << TOKEN_MAGENTA(owners[p]->var_name)
+                   << ": undeclared exclude variable " << TOKEN_MAGENTA(excl_name);
+
+                return ss.str();
             }
-            else
-            {
-                task.cache.type = InstructionTask::Cache::Type::STORE;
 
+            // EACH VALUE MAY LIST SEVERAL SPACE-SEPARATED GLOBS
+            std::vector<std::string> values;
+
+            for (const auto& value : it->second.var_value)
+            {
+                auto parts = Support::split(value);
+                values.insert(values.end(), parts.begin(), parts.end());
             }
 
-            for (uint32_t i = 1; i < properties.size(); ++i)
+            for (const auto& value : values)
             {
-                std::size_t old_size = task.cache.data.size();
+                Glob::Pattern    pattern;
+                Glob::ParseError error;
 
-                if (auto err = ex.ExpandText(properties[i], {Expander::Algorithm::LIST}, &task.cache.data); err.has_value())
+                if (!Glob::Parse(value, pattern, error))
                 {
-                    return err;
-                }
+                    std::stringstream ss;
+                    ss << "While expanding " << TOKEN_MAGENTA(excl_name)
+                       << " an invalid exclude glob was detected " << TOKEN_MAGENTA(pattern.normalized)
+                       << ": " << ParseErrorRepr(error);
 
-#warning SF: handle multi value vars
-#if 0
-                if (!task.cache.data.size())
-                {
-                    auto values = Support::split(task., ' ');
-                    task.cache.data.insert(task.cache.data.end(), values.begin(), values.end());
+                    return ss.str();
                 }
-#endif
-                for (std::size_t j = old_size; j < task.cache.data.size(); ++j)
-                {
-                    const auto& file = task.cache.data[j];
 
-                    if (!Support::file_exists(file))
-                    {
-                        std::stringstream ss;
-                        ss << "Cannot " << properties[0] << " " << TOKEN_CYAN(file) << " from instruction " << TOKEN_CYAN(properties[i]);
-                        return ss.str();
-                    }
-                }
+                inserted.first->second.push_back(opt.exclude.size());
+                opt.exclude.push_back(std::move(pattern));
             }
         }
 
-        // EXPAND TASK INTERPRETER OVERRIDE
-        if (task.hasAttribute(Attr::Type::INTERPRETER))
-        {
-            std::stringstream ss;
-            auto properties = task.getProperties(Attr::Type::INTERPRETER);
+        scopes[p] = inserted.first->second;
+    }
 
-            if (auto err = ex.ExpandText(properties[0], {}); err.has_value())
+    // START HASHING @cache INPUTS WHILE THE TRAVERSAL IS STILL RUNNING
+    Glob::Sink on_match;
+
+    if (std::find(prefetch.begin(), prefetch.end(), 1) != prefetch.end())
+    {
+        on_match = [&prefetch] (std::size_t p, const std::string& path)
+        {
+            if (prefetch[p])
             {
-                return err;
+                Cache::Manager::Instance().Prefetch(Cache::PathTable::Instance().Intern(path));
             }
-            
-            task.interpreter = properties[0];
+        };
+    }
+
+    // ONE TRAVERSAL SERVES EVERY GLOB
+    Arcana::Glob::ExpandAll(patterns, ".", expansions, opt, scopes, on_match);
+
+    for (std::size_t p = 0; p < patterns.size(); ++p)
+    {
+        auto& dst = owners[p]->glob_expansion;
+        dst.insert(dst.end(), expansions[p].begin(), expansions[p].end());
+    }
+
+    // SORT AND DEDUP VARIABLES CARRYING SEVERAL GLOBS
+    for (std::size_t p = 0; p < owners.size(); ++p)
+    {
+        if (p > 0 && owners[p] == owners[p - 1])
+        {
+            auto& dst = owners[p]->glob_expansion;
+            std::sort(dst.begin(), dst.end());
+            dst.erase(std::unique(dst.begin(), dst.end()), dst.end());
+        }
+    }
+
+    
+    // HANDLE MAPPED VARS EXPANSION
+    for (auto& [name, map_to] : vtable)
+    {
+        if (!referenced.count(name) || !map_to.hasAttribute(Semantic::Attr::Type::MAP)) continue;
+
+        Glob::ParseError e1, e2;
+        Glob::MapError   m1;
+
+        auto& map_from = vtable[map_to.getProperties(Semantic::Attr::Type::MAP).at(0)];
+
+        if (!Arcana::Glob::MapGlobToGlob(map_from.var_value, map_to.var_value[0],
+                                            map_from.glob_expansion, map_to.glob_expansion, e1, e2, m1))
+        {
+            std::stringstream ss;
+            ss << "While mapping " << TOKEN_MAGENTA(map_from.var_name)
+                << " to " << TOKEN_MAGENTA(map_to.var_name)
+                << ": incompatible globs";
+
+            return ss.str();
+        }
+    }
 
-            if (!Support::file_exists(task.interpreter))
+    // GLOB EXPANSIONS ARE FINAL FROM HERE ON
+    ex.Invalidate();
+
+    // EXPAND ASSERTS
+    auto keys = Table::Keys(ftable);
+
+    for (auto& assert : atable)
+    {
+        for (const auto& action : assert.actions)
+        {
+            if (std::find(keys.begin(), keys.end(), action) == keys.end())
             {
-                ss << "Interpreter " << TOKEN_MAGENTA(task.interpreter) << " is missing or unknown";
+                std::stringstream ss;
+                ss << "Callback " << TOKEN_MAGENTA(action) << " is undefined in statement " << TOKEN_CYAN("assert");
+                
+                if (auto closest = Support::FindClosest(keys, action); closest.has_value() )
+                {
+                    ss << std::endl << "[" << TOKEN_GREEN("HINT") << "] Did you mean " << TOKEN_CYAN(closest.value()) << "?";
+                }
+
                 return ss.str();
             }
         }
 
+        if (auto err = ex.ExpandAssertSide(assert.lvalue, assert); err.has_value())
+        {
+            return err;
+        }
 
-        std::vector<std::string> expanded_instrs;
-        task.expanded = false;
-        // EXPAND INSTRUCTION LINES
-        for (auto& instr : task.task_instrs)
+        if (auto err = ex.ExpandAssertSide(assert.rvalue, assert); err.has_value())
         {
-            size_t old_val = expanded_instrs.size();
+            return err;
+        }
 
-            if (auto err = ex.ExpandText(instr, {
-                Expander::Algorithm::INLINE, 
-                Expander::Algorithm::LIST
-            }, &expanded_instrs); err.has_value())
-            {
-                return err;
-            }
-            
-            if (expanded_instrs.size() - old_val > 1)
-            {
-                task.expanded = true;
-            }
-            else if (expanded_instrs.size() == old_val)
-            {
-                expanded_instrs.push_back(instr);
-            }
+        if (auto err = ex.ExpandText(assert.reason, {}); err.has_value())
+        {
+            return err;
         }
+    }
 
-        task.task_instrs = expanded_instrs;
+    // EXPAND REACHABLE TASKS IN PARALLEL, FIRST ERROR IN TABLE ORDER WINS
+    std::vector<InstructionTask*> tasks;
+
+    for (auto& [name, task] : ftable)
+    {
+        if (reachable.count(&task)) tasks.push_back(&task);
     }
-    
+
+    std::vector<std::optional<std::string>> errors(tasks.size());
+
+    ParallelFor(tasks.size(), max_threads, [this] { return Expander(*this); }, [&] (Expander& local, std::size_t i)
+    {
+        errors[i] = local.ExpandTask(*tasks[i]);
+    });
+
+    for (auto& err : errors)
+    {
+        if (err.has_value()) return err;
+    }
+
     return std::nullopt;
 }
 
@@ -1158,84 +1715,228 @@ const std::optional<std::string> Enviroment::ExecuteAsserts(std::vector<std::str
 //                                                                      
 
 
+/**
+ * @brief `{arc:NAME}` or `{arc:<mode>:<var>}` reference located by NextArcRef().
+ */
+struct ArcRef
+{
+    std::size_t      start  = 0;   ///< Offset of the opening '{'.
+    std::size_t      length = 0;   ///< Length up to and including the closing '}'.
+    std::string_view mode;         ///< Expansion mode, empty for `{arc:NAME}`.
+    std::string_view name;         ///< Referenced variable or internal symbol.
+};
+
+
+
+/** @brief ASCII letter test (locale independent). */
+static inline bool IsAlpha(char c) noexcept
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+/** @brief ASCII letter or digit test (locale independent). */
+static inline bool IsAlnum(char c) noexcept
+{
+    return IsAlpha(c) || (c >= '0' && c <= '9');
+}
+
+
+
+/**
+ * @brief Find the next `{arc:...}` reference at or after @p pos.
+ *
+ * Accepted forms:
+ * - `{arc:<mode>:<var>}` with mode `[a-z]+` and var `[A-Za-z][A-Za-z0-9]*`
+ * - `{arc:NAME}` with NAME `[A-Za-z_][A-Za-z0-9_]+` (internal symbols included)
+ *
+ * Candidates failing both forms are skipped, so the scan is a single pass.
+ *
+ * @param s Text to scan.
+ * @param pos Start offset.
+ * @param out Located reference.
+ * @return true if a reference was found.
+ */
+static bool NextArcRef(std::string_view s, std::size_t pos, ArcRef& out) noexcept
+{
+    static constexpr std::string_view OPEN = "{arc:";
+
+    for (std::size_t at = s.find(OPEN, pos); at != std::string_view::npos; at = s.find(OPEN, at + 1))
+    {
+        const std::size_t body = at + OPEN.size();
+        std::size_t       i    = body;
+
+        // MODE FORM
+        while (i < s.size() && s[i] >= 'a' && s[i] <= 'z')
+        {
+            ++i;
+        }
+
+        if (i > body && i < s.size() && s[i] == ':')
+        {
+            const std::size_t name = i + 1;
+            std::size_t       j    = name;
+
+            if (j < s.size() && IsAlpha(s[j]))
+            {
+                while (++j < s.size() && IsAlnum(s[j]));
+
+                if (j < s.size() && s[j] == '}')
+                {
+                    out = ArcRef{ at, j + 1 - at, s.substr(body, i - body), s.substr(name, j - name) };
+                    return true;
+                }
+            }
+
+            // PLAIN NAMES CANNOT HOLD ':'
+            continue;
+        }
+
+        // PLAIN FORM
+        i = body;
+
+        if (i < s.size() && (IsAlpha(s[i]) || s[i] == '_'))
+        {
+            while (++i < s.size() && (IsAlnum(s[i]) || s[i] == '_'));
+
+            if (i - body >= 2 && i < s.size() && s[i] == '}')
+            {
+                out = ArcRef{ at, i + 1 - at, {}, s.substr(body, i - body) };
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+
+
 /**
  * @brief Expand internal symbols `{arc:__...__}`.
+ *
+ * The text is scanned once and rebuilt into a single output buffer; references
+ * that are not internal symbols are copied through for ExpandArcAll().
+ *
  * @param s String to expand in-place.
  * @return Empty optional on success, error string on failure.
  */
 std::optional<std::string> Enviroment::Expander::ExpandInternals(std::string& s) noexcept
 {
-    for (int depth = 0; depth < 256; ++depth)
+    std::string out;
+    std::size_t last     = 0;
+    bool        replaced = false;
+    ArcRef      ref;
+
+    for (std::size_t pos = 0; NextArcRef(s, pos, ref); pos = ref.start + ref.length)
     {
-        // SEARCH NEXT INTERNAL TOKEN
-        std::smatch m;
-        if (!std::regex_search(s, m, re_intern))
+        // INTERNAL SYMBOLS ARE PLAIN REFERENCES SHAPED LIKE __NAME__
+        if (!ref.mode.empty() || ref.name.size() < 5 || ref.name.substr(0, 2) != "__")
         {
-            return std::nullopt;
+            continue;
         }
 
-        const std::string sym = m[1].str();
-
         // RESOLVE SYMBOL AND REPLACE
-        if (auto st = Core::is_symbol(sym); st != Core::SymbolType::UNDEFINED)
-        {
-            const std::string rep = Core::symbol(st);
-            s.replace(static_cast<std::size_t>(m.position(0)), static_cast<std::size_t>(m.length(0)), rep);
-        }
-        else
+        if (auto st = Core::is_symbol(ref.name); st != Core::SymbolType::UNDEFINED)
         {
-            return "Internal symbol expansion failed for {arc:" + sym + "}";
+            out.append(s, last, ref.start - last);
+            out += Core::symbol(st);
+
+            last     = ref.start + ref.length;
+            replaced = true;
         }
     }
 
-    return "Too deep internal symbol expansion (depth limit reached)";
+    if (replaced)
+    {
+        out.append(s, last, std::string::npos);
+        s.swap(out);
+    }
+
+    return std::nullopt;
 }
 
 
 
 /**
  * @brief Expand variable references `{arc:NAME}` using env.vtable.
+ *
+ * The text is compiled once into a Template of literal spans and variable
+ * slots; inline values come pre-joined from the cache. Every output (the
+ * in-place text and, for `list` references, one line per element) is then
+ * instantiated with an exact-size reservation.
+ *
  * @param s String to expand in-place.
  * @return Empty optional on success, error string on failure.
  */
 std::optional<std::string> Enviroment::Expander::ExpandArcAll(std::string& s, const std::vector<Algorithm>& allowed_algorithms,
-                                                              std::vector<std::string>* list_exp) noexcept
+                                                              std::vector<std::string>* list_exp,
+                                                              Task::Elements* list_elems) noexcept
 {
     std::size_t expected;
+    std::size_t last = 0;
 
-    List expanded;
-    expanded.source  = s;
+    Template tmpl;
+    ArcRef   ref;
 
-    std::vector<Arcana::Semantic::InstructionAssign*> list_expansions;
+    std::vector<const std::vector<std::string>*> list_expansions;
+    const std::vector<std::string>*              list_root = nullptr;
+    bool                                         keyed     = true;
 
-    std::sregex_iterator rx_it1(expanded.source.begin(), expanded.source.end(), re_arc_mode);
-    std::sregex_iterator end;
+    // GLOB-DERIVED VARIABLES CARRY FILE LISTS
+    auto from_glob = [] (const Arcana::Semantic::InstructionAssign& var)
+    {
+        return !var.glob_expansion.empty() || var.hasAttribute(Attr::Type::GLOB) || var.hasAttribute(Attr::Type::MAP);
+    };
 
-    auto expand = [&] (std::string& src, uint32_t pos = 0) -> void
+    // FOLLOW THE MAP CHAIN BACK TO THE GLOB THE ELEMENTS COME FROM
+    auto map_root = [&] (const Arcana::Semantic::InstructionAssign& var)
     {
-        ssize_t span = 0;
-        for (const auto& match : expanded.matches)
+        const Arcana::Semantic::InstructionAssign* root = &var;
+
+        for (std::size_t hops = 0; hops < env.vtable.size() && root->hasAttribute(Attr::Type::MAP); ++hops)
         {
-            std::string content{};
-            
-            switch (match.algo)
-            {
-                case Algorithm::NORMAL: content = match.datasource->GetListValue();      break;
-                case Algorithm::LIST:   content = match.datasource->glob_expansion[pos]; break;
-                case Algorithm::INLINE: content = match.datasource->GetListGlob();       break;
-            }   
+            const auto& props = root->getProperties(Attr::Type::MAP);
+            auto        from  = props.empty() ? env.vtable.end() : env.vtable.find(props[0]);
 
-            src.replace(match.start + span, match.count, content);
-    
-            span += content.length() - match.pattern_len;
+            if (from == env.vtable.end()) break;
+
+            root = &from->second;
+        }
+
+        return &root->glob_expansion;
+    };
+
+    // INSTANTIATE THE TEMPLATE (LIST SLOTS TAKE ELEMENT pos)
+    auto render = [&] (std::size_t pos) -> std::string
+    {
+        std::string out;
+        std::size_t len = tmpl.fixed_len;
+
+        for (const auto* list : list_expansions) len += (*list)[pos].size();
+
+        out.reserve(len);
+
+        for (const auto& piece : tmpl.pieces)
+        {
+            if (piece.list) out += (*piece.list)[pos];
+            else            out += piece.text;
         }
+
+        return out;
+    };
+
+    // APPEND A FIXED PIECE
+    auto fixed = [&] (std::string_view text)
+    {
+        if (text.empty()) return;
+
+        tmpl.pieces.push_back( Template::Piece {text, nullptr} );
+        tmpl.fixed_len += text.size();
     };
 
-    for (; rx_it1 != end; ++rx_it1)
+    for (std::size_t pos = 0; NextArcRef(s, pos, ref); pos = ref.start + ref.length)
     {
-        const std::smatch& m         = *rx_it1;
-        const std::string  algorithm = m[1].str();
-        const std::string  name      = m[2].str();
+        const std::string name(ref.name);
 
         // LOOKUP VARIABLE VALUE
         auto it = env.vtable.find(name);
@@ -1246,60 +1947,55 @@ std::optional<std::string> Enviroment::Expander::ExpandArcAll(std::string& s, co
             return err.str();
         }
 
-        Algorithm algo;
+        fixed(std::string_view(s).substr(last, ref.start - last));
+        last = ref.start + ref.length;
 
-        if (auto eit = Expansion_Map.find(algorithm); eit != Expansion_Map.end())
+        // PLAIN REFERENCE
+        if (ref.mode.empty())
         {
-            algo = eit->second;
+            keyed = keyed && !from_glob(it->second);
+            fixed(Joined(it->second, Algorithm::NORMAL));
+            continue;
         }
 
-        if (std::find(allowed_algorithms.begin(), allowed_algorithms.end(), algo) != allowed_algorithms.end())
-        {
-            if (it->second.glob_expansion.size() == 0)
-            {
-                std::stringstream err;
-                err << "Invalid expand algorithm " << TOKEN_MAGENTA(algorithm) << " for variable " << TOKEN_CYAN(name) << " in statement " << TOKEN_CYAN(s);
-                return err.str();
-            }
-
-            if (algo == Algorithm::LIST) list_expansions.push_back(&it->second);
+        const std::string_view algorithm = ref.mode;
+        const auto*            eit       = Expansion_Map.find(algorithm);
 
-            expanded.matches.push_back( List::Match {algo, (size_t) m.position(0), (size_t) m.length(0), m[0].str().length(), &it->second} );
-        }
-        else
+        if (eit == nullptr ||
+            std::find(allowed_algorithms.begin(), allowed_algorithms.end(), *eit) == allowed_algorithms.end() ||
+            it->second.glob_expansion.size() == 0)
         {
             std::stringstream err;
             err << "Invalid expand algorithm " << TOKEN_MAGENTA(algorithm) << " for variable " << TOKEN_CYAN(name) << " in statement " << TOKEN_CYAN(s);
             return err.str();
         }
-    }
 
-    std::sregex_iterator rx_it2(expanded.source.begin(), expanded.source.end(), re_arc);
+        if (*eit == Algorithm::LIST)
+        {
+            // EVERY LIST SLOT MUST NAME THE SAME ELEMENT
+            const auto* root = map_root(it->second);
 
-    for (; rx_it2 != end; ++rx_it2)
-    {
-        const std::smatch& m     = *rx_it2;
-        std::size_t        start = m.position(0);
-        std::size_t        len   = m.length(0);
-        const std::string  name  = m[1].str();
+            keyed     = keyed && (list_root == nullptr || list_root == root);
+            list_root = root;
 
-        // LOOKUP VARIABLE VALUE
-        auto it = env.vtable.find(name);
-        if (it == env.vtable.end())
+            list_expansions.push_back(&it->second.glob_expansion);
+            tmpl.pieces.push_back( Template::Piece {{}, &it->second.glob_expansion} );
+        }
+        else
         {
-            std::stringstream err;
-            err << "Undefined variable " << TOKEN_MAGENTA(name) << " in statement " << TOKEN_CYAN(s);
-
-            return err.str();
+            // A WHOLE FILE LIST ON THE LINE: IT DEPENDS ON EVERY ELEMENT
+            keyed = false;
+            fixed(Joined(it->second, *eit));
         }
-
-        expanded.matches.push_back( List::Match {Algorithm::NORMAL, start, len, m[0].str().length(), &it->second});
     }
 
-    std::sort(expanded.matches.begin(), expanded.matches.end(), [] (const List::Match& a, const List::Match& b)
+    // NOTHING TO REPLACE
+    if (last == 0)
     {
-        return a.start < b.start;
-    });
+        return std::nullopt;
+    }
+
+    fixed(std::string_view(s).substr(last));
 
     if (list_expansions.size() > 0)
     {
@@ -1310,11 +2006,11 @@ std::optional<std::string> Enviroment::Expander::ExpandArcAll(std::string& s, co
             return err.str();
         }
 
-        expected = list_expansions[0]->glob_expansion.size();
+        expected = list_expansions[0]->size();
 
         const bool same_len = std::all_of(list_expansions.begin(), list_expansions.end(), [&] (const auto* list)
         {
-            return list->glob_expansion.size() == expected;
+            return list->size() == expected;
         });
 
         if (!same_len)
@@ -1324,20 +2020,130 @@ std::optional<std::string> Enviroment::Expander::ExpandArcAll(std::string& s, co
             return err.str();
         }
 
-        for (uint32_t i = 0; i < expected; ++i)
+        list_exp->reserve(list_exp->size() + expected);
+
+        for (std::size_t i = 0; i < expected; ++i)
+        {
+            list_exp->push_back(render(i));
+        }
+
+        if (list_elems != nullptr)
         {
-            std::string src = s;
-            expand(src, i);
-            list_exp->push_back(src);
+            list_elems->reserve(list_elems->size() + expected);
+
+            // UNKEYED LINES GET NULL ELEMENTS (FULL BARRIER)
+            for (std::size_t i = 0; i < expected; ++i)
+            {
+                list_elems->push_back( Task::Element{ keyed ? list_root : nullptr, i } );
+            }
         }
     } 
     
-    expand(s);
+    // THE IN-PLACE TEXT KEEPS THE FIRST ELEMENT OF EVERY LIST SLOT
+    std::string out = render(0);
+    s.swap(out);
 
     return std::nullopt;
 }
 
 
+
+/**
+ * @brief Joined values of a variable, computed once and cached.
+ * @param var Variable to join.
+ * @param algo `NORMAL` for var_value, `INLINE` for glob_expansion.
+ * @return Reference to the cached joined string.
+ */
+const std::string& Enviroment::Expander::Joined(const Arcana::Semantic::InstructionAssign& var, Algorithm algo) noexcept
+{
+    // A SINGLE VALUE IS ITS OWN JOIN
+    if (algo == Algorithm::NORMAL && var.var_value.size() == 1)
+    {
+        return var.var_value[0];
+    }
+
+    // RESPONSE FILE: ONE QUOTED ARGUMENT PER LINE, REFERENCED AS @path
+    if (algo == Algorithm::RSP)
+    {
+        auto inserted = joined_rsps.try_emplace(&var);
+
+        if (inserted.second)
+        {
+            std::string content;
+
+            for (const auto& v : var.glob_expansion)
+            {
+                if (v.find_first_of(" \t\\\"'") == std::string::npos)
+                {
+                    content += v;
+                }
+                else
+                {
+                    content += '"';
+
+                    for (const char c : v)
+                    {
+                        if (c == '"' || c == '\\') content += '\\';
+                        content += c;
+                    }
+
+                    content += '"';
+                }
+
+                content += '\n';
+            }
+
+            inserted.first->second = "@" + Cache::Manager::Instance().WriteResponseFile(content).generic_string();
+        }
+
+        return inserted.first->second;
+    }
+
+    auto& cache    = (algo == Algorithm::NORMAL) ? joined_values : joined_globs;
+    auto  inserted = cache.try_emplace(&var);
+
+    if (inserted.second)
+    {
+        const auto& values = (algo == Algorithm::NORMAL) ? var.var_value : var.glob_expansion;
+        std::string& out   = inserted.first->second;
+        std::size_t  len   = 0;
+
+        for (const auto& v : values) len += v.size() + 1;
+
+        out.reserve(len);
+
+        for (const auto& v : values)
+        {
+            out += v;
+            out += ' ';
+        }
+    }
+
+    return inserted.first->second;
+}
+
+
+
+/**
+ * @brief Drop cached joined values.
+ * @param var Variable whose values changed, or null to drop everything.
+ */
+void Enviroment::Expander::Invalidate(const Arcana::Semantic::InstructionAssign* var) noexcept
+{
+    if (var == nullptr)
+    {
+        joined_values.clear();
+        joined_globs.clear();
+        joined_rsps.clear();
+        return;
+    }
+
+    joined_values.erase(var);
+    joined_globs.erase(var);
+    joined_rsps.erase(var);
+}
+
+
 std::optional<std::string> Enviroment::Expander::ExpandLists()
 {
 
@@ -1351,7 +2157,8 @@ std::optional<std::string> Enviroment::Expander::ExpandLists()
  * @return Empty optional on success, error string on failure.
  */
 std::optional<std::string> Enviroment::Expander::ExpandText(std::string& s, const std::vector<Algorithm>& allowed_algorithms,
-                                                            std::vector<std::string>* list_exp) noexcept
+                                                            std::vector<std::string>* list_exp,
+                                                            Task::Elements* list_elems) noexcept
 {
     // EXPAND INTERNALS
     if (auto err = ExpandInternals(s); err.has_value())
@@ -1360,7 +2167,7 @@ std::optional<std::string> Enviroment::Expander::ExpandText(std::string& s, cons
     }
 
     // EXPAND VARIABLES
-    if (auto err = ExpandArcAll(s, allowed_algorithms, list_exp); err.has_value())
+    if (auto err = ExpandArcAll(s, allowed_algorithms, list_exp, list_elems); err.has_value())
     {
         return err;
     }
@@ -1370,6 +2177,141 @@ std::optional<std::string> Enviroment::Expander::ExpandText(std::string& s, cons
 
 
 
+/**
+ * @brief Expand every value of a variable whose references are already expanded.
+ * @param var Variable to expand in-place.
+ * @return Empty optional on success, error string on failure.
+ */
+std::optional<std::string> Enviroment::Expander::ExpandVariable(Arcana::Semantic::InstructionAssign& var) noexcept
+{
+    for (auto& value : var.var_value)
+    {
+        if (auto err = ExpandText(value, {}); err.has_value())
+        {
+            return err;
+        }
+    }
+
+    return std::nullopt;
+}
+
+
+
+/**
+ * @brief Expand a task: `@cache` inputs, interpreter override and instruction lines.
+ * @param task Task to expand in-place.
+ * @return Empty optional on success, error string on failure.
+ */
+std::optional<std::string> Enviroment::Expander::ExpandTask(Arcana::Semantic::InstructionTask& task) noexcept
+{
+    if (task.cache.enabled = task.hasAttribute(Attr::Type::CACHE); task.cache.enabled)
+    {
+        auto properties = task.getProperties(Attr::Type::CACHE);
+
+        if (properties[0] == "track")
+        {
+            task.cache.type = InstructionTask::Cache::Type::TRACK;
+        }
+        else if (properties[0] == "untrack")
+        {
+            task.cache.type = InstructionTask::Cache::Type::UNTRACK;
+        }
+        else
+        {
+            task.cache.type = InstructionTask::Cache::Type::STORE;
+
+        }
+
+        for (uint32_t i = 1; i < properties.size(); ++i)
+        {
+            std::size_t old_size = task.cache.data.size();
+
+            if (auto err = ExpandText(properties[i], {Algorithm::LIST}, &task.cache.data); err.has_value())
+            {
+                return err;
+            }
+
+#warning SF: handle multi value vars
+#if 0
+            if (!task.cache.data.size())
+            {
+                auto values = Support::split(task., ' ');
+                task.cache.data.insert(task.cache.data.end(), values.begin(), values.end());
+            }
+#endif
+            for (std::size_t j = old_size; j < task.cache.data.size(); ++j)
+            {
+                const auto& file = task.cache.data[j];
+
+                if (!Support::file_exists(file))
+                {
+                    std::stringstream ss;
+                    ss << "Cannot " << properties[0] << " " << TOKEN_CYAN(file) << " from instruction " << TOKEN_CYAN(properties[i]);
+                    return ss.str();
+                }
+            }
+        }
+    }
+
+    // EXPAND TASK INTERPRETER OVERRIDE
+    if (task.hasAttribute(Attr::Type::INTERPRETER))
+    {
+        std::stringstream ss;
+        auto properties = task.getProperties(Attr::Type::INTERPRETER);
+
+        if (auto err = ExpandText(properties[0], {}); err.has_value())
+        {
+            return err;
+        }
+        
+        task.interpreter = properties[0];
+
+        if (!Support::file_exists(task.interpreter))
+        {
+            ss << "Interpreter " << TOKEN_MAGENTA(task.interpreter) << " is missing or unknown";
+            return ss.str();
+        }
+    }
+
+
+    std::vector<std::string> expanded_instrs;
+    Task::Elements           expanded_elems;
+    task.expanded = false;
+    // EXPAND INSTRUCTION LINES
+    for (auto& instr : task.task_instrs)
+    {
+        size_t old_val = expanded_instrs.size();
+
+        if (auto err = ExpandText(instr, {
+            Algorithm::INLINE, 
+            Algorithm::LIST,
+            Algorithm::RSP
+        }, &expanded_instrs, &expanded_elems); err.has_value())
+        {
+            return err;
+        }
+        
+        if (expanded_instrs.size() - old_val > 1)
+        {
+            task.expanded = true;
+        }
+        else if (expanded_instrs.size() == old_val)
+        {
+            expanded_instrs.push_back(instr);
+        }
+
+        // LINES WITHOUT LIST SLOTS BELONG TO NO ELEMENT
+        expanded_elems.resize(expanded_instrs.size());
+    }
+
+    task.task_instrs   = std::move(expanded_instrs);
+    task.task_elements = std::move(expanded_elems);
+
+    return std::nullopt;
+}
+
+
+
 /**
  * @brief Extract `{fs:...}` paths from a string.
  * @param s Input string.
@@ -1377,13 +2319,46 @@ std::optional<std::string> Enviroment::Expander::ExpandText(std::string& s, cons
  */
 void Enviroment::Expander::ExtractFsPaths(const std::string& s, std::vector<fs::path>& out) noexcept
 {
-    std::smatch m;
+    static constexpr std::string_view OPEN = "{fs:";
+
+    const std::string_view sv(s);
+
+    // ITERATE ALL FS TOKENS: "{fs:" FOLLOWED BY AT LEAST ONE CHAR UP TO THE FIRST '}'
+    for (std::size_t at = sv.find(OPEN); at != std::string_view::npos; )
+    {
+        const std::size_t body  = at + OPEN.size();
+        const std::size_t close = sv.find('}', body);
+
+        if (close == std::string_view::npos)
+        {
+            break;
+        }
+
+        if (close == body)
+        {
+            at = sv.find(OPEN, at + 1);
+            continue;
+        }
+
+        out.push_back(fs::path(std::string(sv.substr(body, close - body))));
+        at = sv.find(OPEN, close + 1);
+    }
+}
+
+
+
+/**
+ * @brief Extract variable names referenced by `{arc:NAME}` / `{arc:<mode>:NAME}` tokens.
+ * @param s Input string.
+ * @param out Output list of referenced names.
+ */
+void Enviroment::Expander::ExtractVarRefs(const std::string& s, std::vector<std::string>& out) noexcept
+{
+    ArcRef ref;
 
-    // ITERATE ALL FS TOKENS
-    for (auto it = s.cbegin(); std::regex_search(it, s.cend(), m, re_fs); )
+    for (std::size_t pos = 0; NextArcRef(s, pos, ref); pos = ref.start + ref.length)
     {
-        out.push_back(fs::path(m[1].str()));
-        it = m.suffix().first;
+        out.emplace_back(ref.name);
     }
 }
 
@@ -129,6 +129,15 @@ LANGUAGE:
                                                     Omitting this statement will result in the use of all 
                                                     the cores on your machine.
 
+    using ignore [ignore file list]                 Honours gitignore-style rule files while expanding
+                                                    globs: ignored files and folders are never matched.
+                                                    Rules apply to the folder holding the file and below.
+                                                    Omitting the list uses .gitignore and .arcignore.
+
+    using pool <name> <size>                        Declares a resource pool: at most <size> instructions of 
+                                                    the tasks tagged with @pool <name> run at the same time.
+                                                    Each pool can be declared once.
+
     map <SOURCE> -> <TARGET>                        Same as attribute @map. 
 
     assert "lvalue" <op> "rvalue" -> "reason"       Executes assert operation with early-exit with 
@@ -206,6 +215,9 @@ LANGUAGE:
       3) list expansion, follows the grammar {arc:list:VARNAME}, translates into an expansion of the 
          statement into several sibling statements, each characterized by an entry of the glob type 
          variable.
+      4) response file expansion, follows the grammar {arc:rsp:VARNAME}, writes the entries of a glob 
+         variable into a response file, one per line, and translates into @<path to the file>.
+         Use it for tools that accept @file arguments, to keep long lists off the command line.
 
       For glob expansions, if the passed variable is not a glob, its nominal content will be used.
 
@@ -247,6 +259,12 @@ LANGUAGE:
     
     @multithread                    Enable the multithread for the selected task, not guaranteed.
 
+    @pool        <pool>             Charges the task instructions to the pool declared by 
+                                    'using pool <pool> <size>'.
+
+    @weight      <weight>           Each task instruction costs <weight> threads (and pool slots) 
+                                    instead of 1. An instruction heavier than the budget runs alone.
+
 CACHE:
     @cache <command> <var list>
 
@@ -458,48 +476,31 @@ Arcana_Result Support::PostProcError::operator() (const std::string& ctx, const
 
 
 /**
- * @brief Case-insensitive hash for std::string_view based on ASCII lowering.
+ * @brief Three-way comparison of a table key against a mangled key.
+ *
+ * Walks `base`, `@@` and `tag` in turn so the result matches comparing
+ * against the concatenated string, without materializing it.
  *
- * @param s Input string view.
- * @return Hash value.
+ * @param key     Stored table key.
+ * @param mangled Mangled probe.
+ * @return <0, 0 or >0 as `key` orders before, equal to or after the probe.
  */
-std::size_t Support::StringViewHash::operator() (std::string_view s) const noexcept
+int Support::TableKeyLess::compare(std::string_view key, const MangledKey& mangled) noexcept
 {
-    std::size_t h = 0;
+    const std::string_view parts[] = { mangled.base, "@@", mangled.tag };
 
-    for (char c : s)
+    for (const auto& part : parts)
     {
-        // UPDATE HASH USING LOWERCASED ASCII CHARACTER.
-        h = h * 131 + Support::toLowerAscii(c); 
-    }
-
-    return h;
-}
+        const auto chunk = key.substr(0, part.size());
+        const int  cmp   = chunk.compare(part.substr(0, chunk.size()));
 
+        if (cmp != 0)                   return cmp;
+        if (chunk.size() < part.size()) return -1;
 
-
-/**
- * @brief Case-insensitive equality for std::string_view based on ASCII lowering.
- *
- * @param a First string view.
- * @param b Second string view.
- * @return true if equal (case-insensitive ASCII), false otherwise.
- */
-bool Support::StringViewEq::operator() (std::string_view a, std::string_view b) const noexcept
-{
-    if (a.size() != b.size())
-    {
-        return false;
+        key.remove_prefix(part.size());
     }
 
-    for (size_t i = 0; i < a.size(); ++i)
-    {
-        if (Support::toLowerAscii(a[i]) != Support::toLowerAscii(b[i]))
-        {
-            return false;
-        }
-    }
-    return true;
+    return key.empty() ? 0 : 1;
 }
 
 
@@ -762,14 +763,9 @@ Arcana_Result Support::HandleArgsPostParse(const Arguments &args, Arcana::Semant
 {
     if (args.pubtasks)
     {
-        auto tasks = Table::GetValues(env.ftable, Semantic::Attr::Type::PUBLIC);
-
-        if (tasks)
+        for (const auto* task : env.TasksWith(Semantic::Attr::Type::PUBLIC))
         {
-            for (auto& task : tasks.value())
-            {
-                MSG(task.get().task_name);
-            }
+            MSG(task->task_name);
         }
         
         return Arcana_Result::ARCANA_RESULT__OK_AND_EXIT;
@@ -1026,6 +1022,19 @@ std::string Support::rtrim(const std::string& s)
 
 
 
+/**
+ * @brief Check whether the input only holds whitespace, without copying it.
+ *
+ * @param s Input string.
+ * @return true if @p s is empty or whitespace only.
+ */
+bool Support::is_blank(std::string_view s) noexcept
+{
+    return s.find_first_not_of(" \t\r\n\f\v") == std::string_view::npos;
+}
+
+
+
 /**
  * @brief Convert an ASCII character to lowercase.
  *
@@ -1221,9 +1230,13 @@ std::optional<long long> Support::to_number(const std::string& s)
  */
 std::string Support::generate_mangling(const std::string& target, const std::string& mangling)
 {
-    std::stringstream ss;
-    ss << target << "@@" << mangling;
-    return ss.str();
+    std::string mangled;
+
+    // SINGLE ALLOCATION: KEYS ARE BUILT ON EVERY PROFILE LOOKUP
+    mangled.reserve(target.size() + 2 + mangling.size());
+    mangled.append(target).append("@@").append(mangling);
+
+    return mangled;
 }
 
 
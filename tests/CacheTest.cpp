@@ -0,0 +1,176 @@
+#include "Test.h"
+#include "Cache.h"
+#include "Semantic.h"
+
+
+USE_MODULE(Arcana);
+
+namespace fs = std::filesystem;
+
+
+
+// ---------------------------------------------------------------------------
+// CONTENT DIGESTS (user-032)
+// ---------------------------------------------------------------------------
+
+TEST_CASE(DigestIsTakenOncePerRun)
+{
+    ArcanaTest::ScratchDir dir;
+    auto&                  cache = Cache::Manager::Instance();
+
+    dir.Write("src/a.c", "one");
+
+    const auto id = Cache::PathTable::Instance().Intern("src/a.c");
+
+    cache.LoadCache("test");
+    CHECK(cache.HasFileChanged(id));
+
+    // A TRACK TASK SAW "one": THE STORE TASK OF THE SAME RUN MUST RECORD THE SAME DIGEST
+    dir.Write("src/a.c", "two");
+
+    cache.HasFileChanged(id);
+    cache.Store(id);
+    cache.Freeze();
+
+    const std::string stored = dir.Read(fs::path(".arcana") / Cache::MD5("test"));
+
+    CHECK(stored.find(Cache::MD5_bin("one")) != std::string::npos);
+    CHECK(stored.find(Cache::MD5_bin("two")) == std::string::npos);
+}
+
+
+
+// ---------------------------------------------------------------------------
+// RESPONSE FILES (user-038)
+// ---------------------------------------------------------------------------
+
+TEST_CASE(ResponseFilesOfPreviousRunsArePruned)
+{
+    ArcanaTest::ScratchDir dir;
+    auto&                  cache = Cache::Manager::Instance();
+
+    dir.Write(".arcana/rsp/stale.rsp", "old.c\n");
+
+    const fs::path current = cache.WriteResponseFile("a.c\nb.c\n");
+
+    CHECK_EQ(dir.Read(current), std::string("a.c\nb.c\n"));
+
+    cache.PruneResponseFiles();
+
+    CHECK(fs::exists(current));
+    CHECK(!fs::exists(".arcana/rsp/stale.rsp"));
+}
+
+
+
+// ---------------------------------------------------------------------------
+// ENVIRONMENT SNAPSHOTS (user-042)
+// ---------------------------------------------------------------------------
+
+/**
+ * @brief Number of files in a directory.
+ */
+static std::size_t CountFiles(const fs::path& dir)
+{
+    std::error_code ec;
+    std::size_t     count = 0;
+
+    for (auto it = fs::directory_iterator(dir, ec); !ec && it != fs::directory_iterator(); it.increment(ec))
+    {
+        ++count;
+    }
+
+    return count;
+}
+
+
+
+TEST_CASE(SnapshotIsInvalidatedByAChangedSource)
+{
+    ArcanaTest::ScratchDir dir;
+    auto&                  cache = Cache::Manager::Instance();
+    Semantic::Enviroment   env;
+
+    dir.Write("arcfile", "A = 1\n");
+
+    cache.StoreEnvironment("sel", { "arcfile" }, env);
+    CHECK(cache.LoadEnvironment("sel", env));
+    CHECK(!cache.LoadEnvironment("other", env));
+
+    dir.Write("arcfile", "A = 2\n");
+    CHECK(!cache.LoadEnvironment("sel", env));
+}
+
+
+
+TEST_CASE(OnlyTheLatestSnapshotIsKept)
+{
+    ArcanaTest::ScratchDir dir;
+    auto&                  cache = Cache::Manager::Instance();
+    Semantic::Enviroment   env;
+
+    dir.Write("arcfile", "A = 1\n");
+
+    cache.StoreEnvironment("debug",   { "arcfile" }, env);
+    cache.StoreEnvironment("release", { "arcfile" }, env);
+
+    CHECK_EQ(CountFiles(".arcana/env"), 1u);
+    CHECK(cache.LoadEnvironment("release", env));
+    CHECK(!cache.LoadEnvironment("debug", env));
+}
+
+
+
+// ---------------------------------------------------------------------------
+// INTERNED PATHS AND PREFETCH SHUTDOWN (user-045)
+// ---------------------------------------------------------------------------
+
+TEST_CASE(PathsAreInternedOnceWithTheirKey)
+{
+    auto& paths = Cache::PathTable::Instance();
+
+    const auto a = paths.Intern("src/interned.c");
+    const auto b = paths.Intern("src/other.c");
+
+    CHECK_EQ(paths.Intern(std::string("src/interned.c")), a);
+    CHECK(a != b);
+    CHECK_EQ(paths.Path(a), std::string("src/interned.c"));
+    CHECK(paths.Key(a) == Cache::MD5_bin("src/interned.c"));
+}
+
+
+
+// STOPS THE WORKERS OF THE SINGLETON: KEEP THIS CASE LAST
+TEST_CASE(QueuedFilesAreHashedByTheCallerAfterStop)
+{
+    ArcanaTest::ScratchDir dir;
+    auto&                  cache = Cache::Manager::Instance();
+    auto&                  paths = Cache::PathTable::Instance();
+
+    std::vector<Cache::PathTable::Id> ids;
+
+    for (int i = 0; i < 64; ++i)
+    {
+        const std::string file = "src/f" + std::to_string(i) + ".c";
+
+        dir.Write(file, file);
+        ids.push_back(paths.Intern(file));
+    }
+
+    for (const auto id : ids) cache.Prefetch(id);
+
+    cache.StopHashers();
+    cache.StopHashers();
+
+    // PREFETCH IS A NO-OP ONCE STOPPED, CHECKS FALL BACK TO INLINE HASHING
+    cache.Prefetch(ids[0]);
+
+    bool all_changed = true;
+
+    for (const auto id : ids)
+    {
+        all_changed = all_changed && cache.HasFileChanged(id);
+    }
+
+    CHECK(all_changed);
+}
@@ -0,0 +1,387 @@
+#include "Test.h"
+#include "Core.h"
+#include "Jobs.h"
+#include "Parser.h"
+#include "Support.h"
+
+
+USE_MODULE(Arcana);
+
+namespace fs = std::filesystem;
+
+
+
+/**
+ * @brief Plan an arcfile the way the CLI does, up to the job list.
+ * @param arcfile Script path.
+ * @param env     Environment (must outlive the jobs).
+ * @param jobs    Output job list.
+ * @return True if every step succeeded.
+ */
+static bool Plan(const std::string& arcfile, Semantic::Enviroment& env, Jobs::List& jobs)
+{
+    Scan::Lexer              lexer(arcfile);
+    Grammar::Engine          engine;
+    Parsing::Parser          parser(lexer, engine);
+    Support::Arguments       args{};
+    std::vector<std::string> recovery;
+
+    args.arcfile = arcfile;
+
+    Core::update_symbol(Core::SymbolType::MAIN, "None");
+
+    parser.Set_ParsingError_Handler    (Support::ParserError   {lexer});
+    parser.Set_AnalisysError_Handler   (Support::SemanticError {lexer});
+    parser.Set_PostProcessError_Handler(Support::PostProcError {lexer});
+
+    return parser.Parse(env)                               == Arcana_Result::ARCANA_RESULT__OK &&
+           env.CheckArgs(args)                             == Arcana_Result::ARCANA_RESULT__OK &&
+           !env.AlignEnviroment().has_value()                                                 &&
+           env.CheckPools()                                == Arcana_Result::ARCANA_RESULT__OK &&
+           !env.Expand().has_value()                                                          &&
+           Jobs::List::FromEnv(env, jobs, recovery)        == Arcana_Result::ARCANA_RESULT__OK;
+}
+
+
+
+/**
+ * @brief Find a job by name.
+ */
+static const Jobs::Job* FindJob(const Jobs::List& jobs, const std::string& name)
+{
+    for (const auto& job : jobs.All())
+    {
+        if (job.name == name) return &job;
+    }
+
+    return nullptr;
+}
+
+
+
+/**
+ * @brief Count the instructions of a job bound to a list element.
+ */
+static std::size_t Keyed(const Jobs::Job& job)
+{
+    return std::count_if(job.elements.begin(), job.elements.end(), [] (const auto& e) { return e.list != nullptr; });
+}
+
+
+
+/**
+ * @brief Write a two-step pipeline over the C sources whose second step runs @p check per element.
+ *
+ * Compiling `d.c` takes @p slow seconds, the other sources are immediate.
+ */
+static void WritePipeline(const ArcanaTest::ScratchDir& dir, const std::string& check, const std::string& slow = "0")
+{
+    dir.Write("src/a.c", "0");
+    dir.Write("src/b.c", "0");
+    dir.Write("src/c.c", "0");
+    dir.Write("src/d.c", slow);
+    dir.Write("src/e.h", "");
+    dir.Write("obj/.keep", "");
+
+    dir.Write("arcfile",
+              "@glob\n"
+              "SRC = src/*.c\n"
+              "\n"
+              "@glob\n"
+              "HDR = src/*.h\n"
+              "\n"
+              "OBJ = obj/*.o\n"
+              "\n"
+              "map SRC -> OBJ;\n"
+              "\n"
+              "@multithread\n"
+              "task Compile()\n"
+              "{\n"
+              "    sleep $(cat {arc:list:SRC}) && touch {arc:list:OBJ}\n"
+              "}\n"
+              "\n"
+              "@pub\n"
+              "@main\n"
+              "@multithread\n"
+              "@requires Compile\n"
+              "task Check()\n"
+              "{\n"
+              "    " + check + "\n"
+              "}\n");
+}
+
+
+
+// ---------------------------------------------------------------------------
+// ENVIRONMENT HAND-OFF (user-043)
+// ---------------------------------------------------------------------------
+
+TEST_CASE(TaskReachedTwiceIsPlannedOnceWithItsInstructions)
+{
+    ArcanaTest::ScratchDir dir;
+    Semantic::Enviroment   env;
+    Jobs::List             jobs;
+
+    dir.Write("src/a.c", "");
+    dir.Write("src/b.c", "");
+    dir.Write("arcfile",
+              "@glob\n"
+              "SRC = src/*.c\n"
+              "\n"
+              "@always\n"
+              "@multithread\n"
+              "task Shared()\n"
+              "{\n"
+              "    echo {arc:list:SRC}\n"
+              "}\n"
+              "\n"
+              "@pub\n"
+              "@main\n"
+              "@requires Shared\n"
+              "task Build()\n"
+              "{\n"
+              "    echo build\n"
+              "}\n");
+
+    CHECK(Plan("arcfile", env, jobs));
+    CHECK_EQ(jobs.All().size(), 2u);
+
+    const auto* shared = FindJob(jobs, "Shared");
+
+    CHECK(shared != nullptr);
+
+    if (shared)
+    {
+        CHECK_EQ(shared->instructions.size(), 2u);
+        CHECK_EQ(shared->elements.size(),     2u);
+    }
+
+    // THE INSTRUCTIONS WERE MOVED OUT OF THE ENVIRONMENT, NOT COPIED
+    CHECK(env.ftable.at("Shared").task_instrs.empty());
+}
+
+
+
+// ---------------------------------------------------------------------------
+// ACTION GRAPH (user-049)
+// ---------------------------------------------------------------------------
+
+static const std::string PER_ELEMENT = "if [ -f obj/d.o ]; then echo late; else echo early; fi > {arc:list:OBJ}.log";
+
+TEST_CASE(ListSlotsOfOneMapChainShareTheElement)
+{
+    ArcanaTest::ScratchDir dir;
+    Semantic::Enviroment   env;
+    Jobs::List             jobs;
+
+    WritePipeline(dir, PER_ELEMENT);
+
+    CHECK(Plan("arcfile", env, jobs));
+
+    const auto* compile = FindJob(jobs, "Compile");
+    const auto* check   = FindJob(jobs, "Check");
+
+    CHECK(compile != nullptr && check != nullptr);
+
+    if (compile && check)
+    {
+        CHECK_EQ(Keyed(*compile), 4u);
+        CHECK_EQ(Keyed(*check),   4u);
+        CHECK(compile->elements[0].list == check->elements[0].list);
+    }
+}
+
+
+
+TEST_CASE(WholeListOnTheLineIsABarrier)
+{
+    ArcanaTest::ScratchDir dir;
+    Semantic::Enviroment   env;
+    Jobs::List             jobs;
+
+    WritePipeline(dir, "echo {arc:inline:OBJ} > {arc:list:OBJ}.log");
+
+    CHECK(Plan("arcfile", env, jobs));
+
+    const auto* check = FindJob(jobs, "Check");
+
+    CHECK(check != nullptr && check->elements.size() == 4 && Keyed(*check) == 0);
+}
+
+
+
+TEST_CASE(OtherGlobOnTheLineIsABarrier)
+{
+    ArcanaTest::ScratchDir dir;
+    Semantic::Enviroment   env;
+    Jobs::List             jobs;
+
+    WritePipeline(dir, "echo {arc:HDR} > {arc:list:OBJ}.log");
+
+    CHECK(Plan("arcfile", env, jobs));
+
+    const auto* check = FindJob(jobs, "Check");
+
+    CHECK(check != nullptr && check->elements.size() == 4 && Keyed(*check) == 0);
+}
+
+
+
+TEST_CASE(ElementEdgesLetDependentsStartEarly)
+{
+    ArcanaTest::ScratchDir dir;
+    Semantic::Enviroment   env;
+    Jobs::List             jobs;
+    Core::RunOptions       opt;
+
+    WritePipeline(dir, PER_ELEMENT, "1");
+
+    opt.silent          = true;
+    opt.max_parallelism = 4;
+
+    CHECK(Plan("arcfile", env, jobs));
+    CHECK(Core::run_jobs(jobs, opt) == Arcana_Result::ARCANA_RESULT__OK);
+
+    // a.o ONLY WAITS FOR a.c, NOT FOR THE SLOW d.c
+    CHECK_EQ(dir.Read("obj/a.o.log"), std::string("early\n"));
+    CHECK_EQ(dir.Read("obj/d.o.log"), std::string("late\n"));
+}
+
+
+
+TEST_CASE(BarrierWaitsForTheWholePreviousJob)
+{
+    ArcanaTest::ScratchDir dir;
+    Semantic::Enviroment   env;
+    Jobs::List             jobs;
+    Core::RunOptions       opt;
+
+    WritePipeline(dir, PER_ELEMENT + "; echo {arc:inline:OBJ} > /dev/null", "1");
+
+    opt.silent          = true;
+    opt.max_parallelism = 4;
+
+    CHECK(Plan("arcfile", env, jobs));
+    CHECK(Core::run_jobs(jobs, opt) == Arcana_Result::ARCANA_RESULT__OK);
+
+    CHECK_EQ(dir.Read("obj/a.o.log"), std::string("late\n"));
+}
+
+
+
+// ---------------------------------------------------------------------------
+// RESOURCE POOLS AND WEIGHTS (user-050)
+// ---------------------------------------------------------------------------
+
+/**
+ * @brief Write six sources and a task running one logged, slow instruction per source.
+ * @param attrs Extra task attributes (one per line).
+ * @param pools `using pool` statements.
+ */
+static void WriteBudgeted(const ArcanaTest::ScratchDir& dir, const std::string& attrs, const std::string& pools = "")
+{
+    for (const char* name : { "a", "b", "c", "d", "e", "f" })
+    {
+        dir.Write(std::string("src/") + name + ".c", "");
+    }
+
+    dir.Write("arcfile",
+              pools +
+              "\n"
+              "@glob\n"
+              "SRC = src/*.c\n"
+              "\n"
+              "@pub\n"
+              "@main\n"
+              "@multithread\n" +
+              attrs +
+              "task Build()\n"
+              "{\n"
+              "    echo S >> log; sleep 0.3; echo E >> log; touch {arc:list:SRC}\n"
+              "}\n");
+}
+
+
+
+/**
+ * @brief Most instructions running at once, replayed from the S/E log.
+ */
+static int MaxRunning(const std::string& log)
+{
+    int running = 0;
+    int peak    = 0;
+
+    for (const char c : log)
+    {
+        if (c == 'S') peak = std::max(peak, ++running);
+        if (c == 'E') --running;
+    }
+
+    return peak;
+}
+
+
+
+/**
+ * @brief Plan and run an arcfile with six workers, returning the peak concurrency.
+ */
+static int RunBudgeted(const ArcanaTest::ScratchDir& dir)
+{
+    Semantic::Enviroment env;
+    Jobs::List           jobs;
+    Core::RunOptions     opt;
+
+    CHECK(Plan("arcfile", env, jobs));
+
+    opt.silent          = true;
+    opt.max_parallelism = 6;
+    opt.pools           = env.GetPools();
+
+    CHECK(Core::run_jobs(jobs, opt) == Arcana_Result::ARCANA_RESULT__OK);
+
+    return MaxRunning(dir.Read("log"));
+}
+
+
+
+TEST_CASE(UnboundedTaskUsesEveryWorker)
+{
+    ArcanaTest::ScratchDir dir;
+
+    WriteBudgeted(dir, "");
+
+    CHECK(RunBudgeted(dir) > 2);
+}
+
+
+
+TEST_CASE(PoolCapsConcurrentInstructions)
+{
+    ArcanaTest::ScratchDir dir;
+
+    WriteBudgeted(dir, "@pool heavy\n", "using pool heavy 2;\n");
+
+    CHECK_EQ(RunBudgeted(dir), 2);
+}
+
+
+
+TEST_CASE(WeightChargesTheThreadBudget)
+{
+    ArcanaTest::ScratchDir dir;
+
+    WriteBudgeted(dir, "@weight 3\n");
+
+    CHECK_EQ(RunBudgeted(dir), 2);
+}
+
+
+
+TEST_CASE(WeightChargesThePoolSize)
+{
+    ArcanaTest::ScratchDir dir;
+
+    WriteBudgeted(dir, "@pool heavy\n@weight 2\n", "using pool heavy 5;\n");
+
+    CHECK_EQ(RunBudgeted(dir), 2);
+}
@@ -0,0 +1,350 @@
+#include "Test.h"
+#include "Glob.h"
+
+#include <chrono>
+
+
+USE_MODULE(Arcana);
+
+namespace fs = std::filesystem;
+
+
+
+/**
+ * @brief Expand one glob relative to the working directory.
+ * @param glob   Glob pattern.
+ * @param opt    Expansion options.
+ * @return Sorted matches.
+ */
+static std::vector<std::string> Expand(const std::string& glob, const Glob::ExpandOptions& opt = {})
+{
+    Glob::Pattern            pattern;
+    Glob::ParseError         error;
+    std::vector<std::string> out;
+
+    CHECK(Glob::Parse(glob, pattern, error));
+    Glob::Expand(pattern, ".", out, opt);
+
+    return out;
+}
+
+
+
+/**
+ * @brief Listing cache options writing to `.arcana/glob`.
+ */
+static Glob::ExpandOptions Cached(bool prune = false)
+{
+    Glob::ExpandOptions opt;
+
+    opt.listing_cache       = ".arcana/glob";
+    opt.prune_listing_cache = prune;
+
+    return opt;
+}
+
+
+
+/**
+ * @brief Put a directory mtime back to @p when (simulates a change inside the mtime granularity).
+ */
+static void SetMTime(const fs::path& dir, fs::file_time_type when)
+{
+    fs::last_write_time(dir, when);
+}
+
+
+
+static const std::vector<std::string> A_ONLY  = { "src/a.c" };
+static const std::vector<std::string> A_AND_B = { "src/a.c", "src/b.c" };
+
+
+
+// ---------------------------------------------------------------------------
+// LISTING CACHE (user-027)
+// ---------------------------------------------------------------------------
+
+TEST_CASE(ListingIsReusedWhileTheDirectoryStampIsUnchanged)
+{
+    ArcanaTest::ScratchDir dir;
+    const auto             old = fs::file_time_type::clock::now() - std::chrono::hours(1);
+
+    dir.Write("src/a.c", "a");
+    SetMTime("src", old);
+
+    CHECK(Expand("src/*.c", Cached()) == A_ONLY);
+
+    // A CHANGE THE STAMP DOES NOT SEE: THE CACHED LISTING IS SERVED
+    dir.Write("src/b.c", "b");
+    SetMTime("src", old);
+
+    CHECK(Expand("src/*.c", Cached()) == A_ONLY);
+    CHECK(Expand("src/*.c")           == A_AND_B);
+}
+
+
+
+TEST_CASE(ListingTakenWithinTheMTimeGranularityIsRelisted)
+{
+    ArcanaTest::ScratchDir dir;
+
+    dir.Write("src/a.c", "a");
+
+    const auto stamp = fs::last_write_time("src");
+
+    CHECK(Expand("src/*.c", Cached()) == A_ONLY);
+
+    // SAME MTIME AS WHEN THE LISTING WAS TAKEN (COARSE TIMESTAMP): MUST NOT BE TRUSTED
+    dir.Write("src/b.c", "b");
+    SetMTime("src", stamp);
+
+    CHECK(Expand("src/*.c", Cached()) == A_AND_B);
+}
+
+
+
+TEST_CASE(PartialExpansionKeepsTheListingsOfOtherGlobs)
+{
+    ArcanaTest::ScratchDir dir;
+    const auto             old = fs::file_time_type::clock::now() - std::chrono::hours(1);
+
+    dir.Write("src/a.c", "a");
+    dir.Write("lib/x.c", "x");
+    SetMTime("src", old);
+    SetMTime("lib", old);
+
+    CHECK(Expand("src/*.c", Cached()) == A_ONLY);
+    CHECK(Expand("lib/*.c", Cached()).size() == 1);
+
+    // THE src RECORD SURVIVED THE lib-ONLY CALL, SO IT IS STILL SERVED
+    dir.Write("src/b.c", "b");
+    SetMTime("src", old);
+
+    CHECK(Expand("src/*.c", Cached()) == A_ONLY);
+}
+
+
+
+TEST_CASE(BuildWideExpansionPrunesUnvisitedListings)
+{
+    ArcanaTest::ScratchDir dir;
+    const auto             old = fs::file_time_type::clock::now() - std::chrono::hours(1);
+
+    dir.Write("src/a.c", "a");
+    dir.Write("lib/x.c", "x");
+    SetMTime("src", old);
+    SetMTime("lib", old);
+
+    CHECK(Expand("src/*.c", Cached()) == A_ONLY);
+    CHECK(Expand("lib/*.c", Cached(true)).size() == 1);
+
+    // THE src RECORD WAS PRUNED: THE DIRECTORY IS LISTED AGAIN
+    dir.Write("src/b.c", "b");
+    SetMTime("src", old);
+
+    CHECK(Expand("src/*.c", Cached()) == A_AND_B);
+}
+
+
+
+// ---------------------------------------------------------------------------
+// IGNORE RULES (user-029)
+// ---------------------------------------------------------------------------
+
+/**
+ * @brief Options honouring `.gitignore` files.
+ */
+static Glob::ExpandOptions Ignoring()
+{
+    Glob::ExpandOptions opt;
+
+    opt.ignore_files = { ".gitignore" };
+
+    return opt;
+}
+
+
+
+TEST_CASE(DirectoryOnlyRuleSkipsFoldersButNotFiles)
+{
+    ArcanaTest::ScratchDir dir;
+
+    dir.Write(".gitignore", "build/\n");
+    dir.Write("src/a.c", "a");
+    dir.Write("src/build/gen.c", "g");
+    dir.Write("build", "a file named like the rule");
+
+    const std::vector<std::string> sources = { "src/a.c" };
+    const std::vector<std::string> top     = { "build" };
+
+    CHECK(Expand("src/**/*.c", Ignoring()) == sources);
+    CHECK(Expand("build", Ignoring())      == top);
+    CHECK(Expand("src/**/*.c").size()      == 2);
+}
+
+
+
+TEST_CASE(NegatedRuleReincludesAnIgnoredFile)
+{
+    ArcanaTest::ScratchDir dir;
+
+    dir.Write(".gitignore", "*.c\n!keep.c\n");
+    dir.Write("src/a.c", "a");
+    dir.Write("src/keep.c", "k");
+
+    const std::vector<std::string> kept = { "src/keep.c" };
+
+    CHECK(Expand("src/*.c", Ignoring()) == kept);
+}
+
+
+
+TEST_CASE(NestedIgnoreFileAppliesBelowItsFolder)
+{
+    ArcanaTest::ScratchDir dir;
+
+    dir.Write("src/.gitignore", "b.c\n");
+    dir.Write("src/a.c", "a");
+    dir.Write("src/b.c", "b");
+    dir.Write("lib/b.c", "b");
+
+    const std::vector<std::string> matches = { "lib/b.c", "src/a.c" };
+
+    CHECK(Expand("*/*.c", Ignoring()) == matches);
+}
+
+
+
+// ---------------------------------------------------------------------------
+// SINGLE-PASS EXPANSION (user-026)
+// ---------------------------------------------------------------------------
+
+TEST_CASE(OneTraversalServesEveryPattern)
+{
+    ArcanaTest::ScratchDir dir;
+
+    dir.Write("src/a.c", "a");
+    dir.Write("src/a.h", "a");
+    dir.Write("src/x/b.c", "b");
+    dir.Write("lib/c.c", "c");
+
+    std::vector<Glob::Pattern> patterns(3);
+    Glob::ParseError           error;
+
+    CHECK(Glob::Parse("src/**/*.c", patterns[0], error));
+    CHECK(Glob::Parse("src/*.h",    patterns[1], error));
+    CHECK(Glob::Parse("*/*.c",      patterns[2], error));
+
+    std::vector<std::vector<std::string>> outs;
+
+    CHECK(Glob::ExpandAll(patterns, ".", outs));
+    CHECK_EQ(outs.size(), 3u);
+
+    if (outs.size() == 3)
+    {
+        CHECK(outs[0] == Expand("src/**/*.c"));
+        CHECK(outs[1] == Expand("src/*.h"));
+        CHECK(outs[2] == Expand("*/*.c"));
+        CHECK_EQ(outs[0].size(), 2u);
+        CHECK_EQ(outs[2].size(), 2u);
+    }
+}
+
+
+
+// ---------------------------------------------------------------------------
+// EXCLUSIONS (user-028)
+// ---------------------------------------------------------------------------
+
+TEST_CASE(ExcludedDirectoriesAndFilesAreSkipped)
+{
+    ArcanaTest::ScratchDir dir;
+    Glob::ExpandOptions    opt;
+    Glob::ParseError       error;
+
+    dir.Write("src/a.c", "a");
+    dir.Write("src/b.c", "b");
+    dir.Write("src/gen/c.c", "c");
+
+    opt.exclude.resize(2);
+
+    CHECK(Glob::Parse("src/gen", opt.exclude[0], error));
+    CHECK(Glob::Parse("src/b.c", opt.exclude[1], error));
+
+    CHECK(Expand("src/**/*.c", opt) == A_ONLY);
+}
+
+
+
+// ---------------------------------------------------------------------------
+// MATCHER (user-030)
+// ---------------------------------------------------------------------------
+
+TEST_CASE(ClassesWildcardsAndLiteralsMatch)
+{
+    ArcanaTest::ScratchDir dir;
+
+    for (const char* name : { "a1.c", "b2.c", "c3.c", "d4.cpp", "e.c" })
+    {
+        dir.Write(std::string("src/") + name, "");
+    }
+
+    const std::vector<std::string> ab   = { "src/a1.c", "src/b2.c" };
+    const std::vector<std::string> notb = { "src/a1.c", "src/c3.c" };
+    const std::vector<std::string> one  = { "src/a1.c", "src/b2.c", "src/c3.c" };
+    const std::vector<std::string> cpp  = { "src/d4.cpp" };
+
+    CHECK(Expand("src/[ab]?.c")  == ab);
+    CHECK(Expand("src/[^b]?.c")  == notb);
+    CHECK(Expand("src/??.c")     == one);
+    CHECK(Expand("src/*.cpp")    == cpp);
+    CHECK_EQ(Expand("src/*.c").size(), 4u);
+}
+
+
+
+// ---------------------------------------------------------------------------
+// GLOB MAPPING (user-031)
+// ---------------------------------------------------------------------------
+
+TEST_CASE(MappingKeepsCapturedSegments)
+{
+    std::vector<std::string> out;
+    Glob::ParseError         err_from;
+    Glob::ParseError         err_to;
+    Glob::MapError           err_map;
+
+    const std::vector<std::string> sources  = { "src/a.c", "src/x/y/b.c" };
+    const std::vector<std::string> expected = { "obj/a.o", "obj/x/y/b.o" };
+
+    CHECK(Glob::MapGlobToGlob({ "src/**/*.c" }, "obj/**/*.o", sources, out, err_from, err_to, err_map));
+    CHECK(out == expected);
+}
+
+
+
+// ---------------------------------------------------------------------------
+// SYMLINK LOOPS (user-033)
+// ---------------------------------------------------------------------------
+
+TEST_CASE(SymlinkLoopIsWalkedOnce)
+{
+    ArcanaTest::ScratchDir dir;
+    Glob::ExpandOptions    opt;
+    std::error_code        ec;
+
+    dir.Write("src/a.c", "a");
+    fs::create_directory_symlink("..", "src/loop", ec);
+
+    if (ec)
+    {
+        return;
+    }
+
+    opt.follow_symlinks = true;
+
+    const auto out = Expand("src/**/*.c", opt);
+
+    // THE LINK LEADS BACK TO AN ALREADY VISITED DIRECTORY: NOT WALKED AGAIN
+    CHECK(out == A_ONLY);
+}
@@ -0,0 +1,189 @@
+#include "Test.h"
+#include "Lexer.h"
+#include "Support.h"
+
+
+USE_MODULE(Arcana);
+
+
+
+/**
+ * @brief Lex a whole script, ENDOFFILE included.
+ */
+static std::vector<Scan::Token> Tokens(Scan::Lexer& lexer)
+{
+    std::vector<Scan::Token> tokens;
+
+    for (;;)
+    {
+        tokens.push_back(lexer.next());
+
+        if (tokens.back().type == Scan::TokenType::ENDOFFILE) break;
+    }
+
+    return tokens;
+}
+
+
+
+// ---------------------------------------------------------------------------
+// VIEW TOKENS AND LINE SLICING (user-039)
+// ---------------------------------------------------------------------------
+
+TEST_CASE(LexemesAreViewsIntoTheSourceBuffer)
+{
+    ArcanaTest::ScratchDir dir;
+    const std::string      path = "arcfile";
+
+    dir.Write(path, "NAME = 42\ntask Build()\n");
+
+    Scan::Lexer lexer(path);
+
+    const auto tokens = Tokens(lexer);
+    const auto buffer = lexer.buffer();
+
+    CHECK_EQ(tokens.size(), 10u);
+    CHECK(tokens[0].type == Scan::TokenType::IDENTIFIER && tokens[0].lexeme == "NAME");
+    CHECK(tokens[2].type == Scan::TokenType::NUMBER     && tokens[2].lexeme == "42");
+    CHECK(tokens[4].type == Scan::TokenType::TASK       && tokens[4].line   == 2);
+
+    for (const auto& token : tokens)
+    {
+        if (token.lexeme.empty()) continue;
+
+        CHECK(token.lexeme.data() >= buffer.data() && token.lexeme.data() + token.lexeme.size() <= buffer.data() + buffer.size());
+    }
+}
+
+
+
+TEST_CASE(LinesAreSlicedWithoutTheirTerminator)
+{
+    ArcanaTest::ScratchDir dir;
+    const std::string      path = "arcfile";
+
+    dir.Write(path, "A = 1\n\nB = 2\n");
+
+    Scan::Lexer lexer(path);
+
+    // LINES ARE INDEXED ON DEMAND, OUT OF ORDER REQUESTS INCLUDED
+    CHECK_EQ(lexer[2], std::string_view("B = 2"));
+    CHECK_EQ(lexer[0], std::string_view("A = 1"));
+    CHECK(lexer[1].empty());
+
+    // A TRAILING NEWLINE DOES NOT OPEN AN EXTRA LINE
+    CHECK(lexer[3].empty());
+    CHECK(lexer[100].empty());
+
+    const auto tokens = Tokens(lexer);
+
+    CHECK_EQ(lexer[tokens[0]], std::string_view("A = 1"));
+}
+
+
+
+TEST_CASE(CommentsKeepColumnAccounting)
+{
+    ArcanaTest::ScratchDir dir;
+    const std::string      inner = "inner";
+    const std::string      last  = "last";
+    const std::string      blank = "blank";
+
+    dir.Write(inner, "A # note\nB\n");
+    dir.Write(last,  "A = 1 # c");
+    dir.Write(blank, "A = 1   ");
+
+    // A COMMENT ENDS AT ITS NEWLINE, WHICH IS STILL A TOKEN
+    Scan::Lexer lexer_inner(inner);
+
+    const auto in = Tokens(lexer_inner);
+
+    CHECK_EQ(in.size(), 5u);
+    CHECK(in[1].type == Scan::TokenType::NEWLINE && in[1].line == 1);
+    CHECK(in[2].lexeme == "B" && in[2].line == 2 && in[2].start == 0);
+
+    // AT END OF BUFFER THE COMMENT ALSO COUNTS THE EOF READ: ONE COLUMN PAST THE TEXT
+    Scan::Lexer lexer_last(last);
+    Scan::Lexer lexer_blank(blank);
+
+    const auto at_eof = Tokens(lexer_last);
+    const auto plain  = Tokens(lexer_blank);
+
+    CHECK_EQ(at_eof.size(), 4u);
+    CHECK_EQ(at_eof.back().line,  1u);
+    CHECK_EQ(at_eof.back().start, 10u);
+    CHECK_EQ(plain.back().start,  8u);
+}
+
+
+
+// ---------------------------------------------------------------------------
+// COMPILE-TIME KEYWORD TABLES (user-047)
+// ---------------------------------------------------------------------------
+
+TEST_CASE(KeywordMapFindsOnlyItsKeys)
+{
+    static constexpr auto folded = Support::make_keyword_map<int>({
+        { "alpha", 1 },
+        { "beta",  2 },
+        { "gamma", 3 },
+    });
+
+    static constexpr auto exact = Support::make_keyword_map<int, false>({
+        { "alpha", 1 },
+        { "Beta",  2 },
+    });
+
+    static_assert(folded.valid() && exact.valid(), "keyword maps must place every key");
+    static_assert(*folded.find("beta") == 2,       "lookups run in constant expressions");
+
+    CHECK(folded.find("gamma") && *folded.find("gamma") == 3);
+    CHECK(folded.find("GaMmA") && *folded.find("GaMmA") == 3);
+    CHECK(folded.find("delta") == nullptr);
+    CHECK(folded.find("alph")  == nullptr);
+    CHECK(folded.find("")      == nullptr);
+
+    CHECK(exact.find("Beta") && *exact.find("Beta") == 2);
+    CHECK(exact.find("beta")  == nullptr);
+    CHECK(exact.find("ALPHA") == nullptr);
+}
+
+
+
+TEST_CASE(DuplicateKeysInvalidateTheMap)
+{
+    // BUILT AT RUN TIME: A FAILED SEED SEARCH EXCEEDS THE CONSTANT EVALUATION LIMITS
+    const auto dup = Support::make_keyword_map<int>({
+        { "task", 1 },
+        { "TASK", 2 },
+    });
+
+    // KEYS EQUAL AFTER FOLDING COLLIDE
+    CHECK(!dup.valid());
+}
+
+
+
+TEST_CASE(KeywordsAreRecognizedInAnyCase)
+{
+    ArcanaTest::ScratchDir dir;
+    const std::string      path = "arcfile";
+
+    dir.Write(path, "task TASK Task tasks Import in IN\n");
+
+    Scan::Lexer lexer(path);
+
+    const auto tokens = Tokens(lexer);
+
+    CHECK_EQ(tokens.size(), 9u);
+    CHECK(tokens[0].type == Scan::TokenType::TASK);
+    CHECK(tokens[1].type == Scan::TokenType::TASK);
+    CHECK(tokens[2].type == Scan::TokenType::TASK);
+    CHECK(tokens[3].type == Scan::TokenType::IDENTIFIER);
+    CHECK(tokens[4].type == Scan::TokenType::IMPORT);
+    CHECK(tokens[5].type == Scan::TokenType::IN);
+    CHECK(tokens[6].type == Scan::TokenType::IN);
+
+    // THE LEXEME KEEPS ITS SPELLING
+    CHECK_EQ(tokens[1].lexeme, std::string_view("TASK"));
+}
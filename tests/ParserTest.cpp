@@ -0,0 +1,225 @@
+#include "Test.h"
+#include "Core.h"
+#include "Parser.h"
+#include "Support.h"
+
+
+USE_MODULE(Arcana);
+
+
+
+/**
+ * @brief Collects what is written to std::cerr while alive.
+ */
+class CaptureErr
+{
+public:
+    CaptureErr()  : previous(std::cerr.rdbuf(buffer.rdbuf())) {}
+    ~CaptureErr() { std::cerr.rdbuf(previous); }
+
+    std::string Text() const { return buffer.str(); }
+
+private:
+    std::ostringstream buffer;
+    std::streambuf*    previous;
+};
+
+
+
+/**
+ * @brief Parse a script the way the CLI does: imports prefetched, then the main parse.
+ * @param root Root script.
+ * @param env  Output environment.
+ * @return Parse result.
+ */
+static Arcana_Result ParseScript(const std::string& root, Semantic::Enviroment& env)
+{
+    Scan::Lexer          lexer(root);
+    Grammar::Engine      engine;
+    Parsing::Parser      parser(lexer, engine);
+    Parsing::ImportCache imports;
+
+    Core::update_symbol(Core::SymbolType::MAIN, "None");
+
+    imports.Prefetch(root, 4);
+
+    // PREFETCH MUST LEAVE THE BUILTIN SYMBOLS TO THE MAIN PARSE
+    CHECK(!Core::is_symbol_set(Core::SymbolType::MAIN));
+
+    parser.Set_ImportCache(&imports);
+    parser.Set_ParsingError_Handler    (Support::ParserError   {lexer});
+    parser.Set_AnalisysError_Handler   (Support::SemanticError {lexer});
+    parser.Set_PostProcessError_Handler(Support::PostProcError {lexer});
+
+    return parser.Parse(env);
+}
+
+
+
+/**
+ * @brief Parse a script and return the syntax error report, without colors.
+ */
+static std::string SyntaxError(const ArcanaTest::ScratchDir& dir, const std::string& script)
+{
+    Semantic::Enviroment env;
+    CaptureErr           err;
+
+    dir.Write("arcfile", script);
+
+    CHECK(ParseScript("arcfile", env) != Arcana_Result::ARCANA_RESULT__OK);
+
+    std::string text = err.Text();
+    std::string plain;
+
+    // DROP ANSI ESCAPE SEQUENCES
+    for (std::size_t i = 0; i < text.size(); ++i)
+    {
+        if (text[i] == '\x1b')
+        {
+            while (i < text.size() && text[i] != 'm') ++i;
+            continue;
+        }
+
+        plain += text[i];
+    }
+
+    return plain;
+}
+
+
+
+// ---------------------------------------------------------------------------
+// GRAMMAR ERROR CONTEXT (user-040)
+// ---------------------------------------------------------------------------
+
+TEST_CASE(ErrorNamesTheExpectedTerminalOfTheFailedRule)
+{
+    ArcanaTest::ScratchDir dir;
+
+    const std::string text = SyntaxError(dir, "A = 1\n\ntask Build(\n{\n    echo\n}\n");
+
+    CHECK(text.find("line 3: task Build(")                               != std::string::npos);
+    CHECK(text.find("Found:    <New Line>")                              != std::string::npos);
+    CHECK(text.find("Expected: right parenthesis for statement(s): Task Declaration") != std::string::npos);
+}
+
+
+
+TEST_CASE(ErrorListsEveryCandidateRule)
+{
+    ArcanaTest::ScratchDir dir;
+
+    const std::string text = SyntaxError(dir, "A = 1\nB\n");
+
+    CHECK(text.find("line 2: B")                                               != std::string::npos);
+    CHECK(text.find("Expected: assignment or plus for statement(s): Assignment, Join") != std::string::npos);
+}
+
+
+
+TEST_CASE(ErrorPointsAtTheOffendingTokenMidStatement)
+{
+    ArcanaTest::ScratchDir dir;
+
+    const std::string text = SyntaxError(dir, "map SRC OBJ;\n");
+
+    CHECK(text.find("Found:    OBJ (identifier)")             != std::string::npos);
+    CHECK(text.find("Expected: minus for statement(s): Mapping") != std::string::npos);
+}
+
+
+
+// ---------------------------------------------------------------------------
+// IMPORT PREFETCH (user-041)
+// ---------------------------------------------------------------------------
+
+TEST_CASE(PrefetchedImportReportsErrorsInImportOrder)
+{
+    ArcanaTest::ScratchDir dir;
+    Semantic::Enviroment   env;
+    CaptureErr             err;
+
+    dir.Write("arcfile", "import lib.arc\n");
+    dir.Write("lib.arc", "@pub\n@main\ntask Lib()\n{\n    echo lib\n}\n\nimport nothere.arc\n");
+
+    CHECK(ParseScript("arcfile", env) != Arcana_Result::ARCANA_RESULT__OK);
+
+    CHECK(err.Text().find("Invalid import file") != std::string::npos);
+    CHECK(err.Text().find("Cannot tag multiple") == std::string::npos);
+}
+
+
+
+TEST_CASE(PrefetchedImportSymbolsApplyAtTheImport)
+{
+    ArcanaTest::ScratchDir dir;
+    Semantic::Enviroment   before;
+    Semantic::Enviroment   after;
+
+    dir.Write("lib.arc", "using threads 2\n\n@pub\n@main\ntask Lib()\n{\n    echo lib\n}\n");
+
+    // ROOT SETTING AFTER THE IMPORT WINS
+    dir.Write("arcfile", "import lib.arc\nusing threads 3\n");
+
+    CHECK(ParseScript("arcfile", after) == Arcana_Result::ARCANA_RESULT__OK);
+    CHECK_EQ(Core::symbol(Core::SymbolType::MAIN),    std::string("Lib"));
+    CHECK_EQ(Core::symbol(Core::SymbolType::THREADS), std::string("3"));
+
+    // IMPORTED SETTING AFTER THE ROOT ONE WINS
+    dir.Write("arcfile", "using threads 3\nimport lib.arc\n");
+
+    CHECK(ParseScript("arcfile", before) == Arcana_Result::ARCANA_RESULT__OK);
+    CHECK_EQ(Core::symbol(Core::SymbolType::THREADS), std::string("2"));
+}
+
+
+
+TEST_CASE(SecondMainIsReportedInThePrefetchedImport)
+{
+    ArcanaTest::ScratchDir dir;
+    Semantic::Enviroment   env;
+    CaptureErr             err;
+
+    dir.Write("arcfile", "@pub\n@main\ntask Root()\n{\n    echo root\n}\n\nimport lib.arc\n");
+    dir.Write("lib.arc", "@pub\n@main\ntask Lib()\n{\n    echo lib\n}\n");
+
+    CHECK(ParseScript("arcfile", env) != Arcana_Result::ARCANA_RESULT__OK);
+
+    CHECK(err.Text().find("Cannot tag multiple") != std::string::npos);
+    CHECK(err.Text().find("lib.arc")             != std::string::npos);
+}
+
+
+
+// ---------------------------------------------------------------------------
+// RESOURCE POOLS (user-050)
+// ---------------------------------------------------------------------------
+
+TEST_CASE(ImportedPoolWithAnotherSizeIsRejected)
+{
+    ArcanaTest::ScratchDir dir;
+    Semantic::Enviroment   env;
+    CaptureErr             err;
+
+    dir.Write("lib.arc", "using pool link 2\n");
+    dir.Write("arcfile", "using pool link 3\nimport lib.arc\n");
+
+    CHECK(ParseScript("arcfile", env) != Arcana_Result::ARCANA_RESULT__OK);
+    CHECK(err.Text().find("Duplicate item") != std::string::npos);
+}
+
+
+
+TEST_CASE(ScriptImportedTwiceKeepsItsPool)
+{
+    ArcanaTest::ScratchDir dir;
+    Semantic::Enviroment   env;
+
+    dir.Write("common.arc", "using pool link 2\n");
+    dir.Write("a.arc",      "import common.arc\n");
+    dir.Write("b.arc",      "import common.arc\n");
+    dir.Write("arcfile",    "import a.arc\nimport b.arc\n");
+
+    CHECK(ParseScript("arcfile", env) == Arcana_Result::ARCANA_RESULT__OK);
+    CHECK(env.GetPools().size() == 1 && env.GetPools().at("link") == 2u);
+}
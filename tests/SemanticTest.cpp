@@ -0,0 +1,394 @@
+#include "Test.h"
+#include "Core.h"
+#include "Jobs.h"
+#include "Parser.h"
+#include "Support.h"
+
+
+USE_MODULE(Arcana);
+
+
+
+/**
+ * @brief Parse, align and expand an arcfile the way the CLI does.
+ * @param arcfile Script path.
+ * @param env     Output environment.
+ * @return Empty optional on success, error string on failure.
+ */
+static std::optional<std::string> Load(const std::string& arcfile, Semantic::Enviroment& env)
+{
+    Scan::Lexer        lexer(arcfile);
+    Grammar::Engine    engine;
+    Parsing::Parser    parser(lexer, engine);
+    Support::Arguments args{};
+
+    args.arcfile = arcfile;
+
+    Core::update_symbol(Core::SymbolType::MAIN, "None");
+
+    parser.Set_ParsingError_Handler    (Support::ParserError   {lexer});
+    parser.Set_AnalisysError_Handler   (Support::SemanticError {lexer});
+    parser.Set_PostProcessError_Handler(Support::PostProcError {lexer});
+
+    if (parser.Parse(env) != Arcana_Result::ARCANA_RESULT__OK || env.CheckArgs(args) != Arcana_Result::ARCANA_RESULT__OK)
+    {
+        return std::string("parse failed");
+    }
+
+    if (auto err = env.AlignEnviroment(); err.has_value())
+    {
+        return err;
+    }
+
+    return env.Expand();
+}
+
+
+
+/**
+ * @brief Instructions of a task after expansion.
+ */
+static const Semantic::Task::Instrs& Instrs(const Semantic::Enviroment& env, const std::string& task)
+{
+    return env.ftable.at(task).task_instrs;
+}
+
+
+
+// ---------------------------------------------------------------------------
+// VARIABLE EXPANSION (user-034)
+// ---------------------------------------------------------------------------
+
+TEST_CASE(PlainInlineAndSymbolReferencesExpandInPlace)
+{
+    ArcanaTest::ScratchDir dir;
+    Semantic::Enviroment   env;
+
+    dir.Write("src/a.c", "");
+    dir.Write("src/b.c", "");
+    dir.Write("arcfile",
+              "CC = gcc\n"
+              "FLAGS = -O2 {arc:CC}\n"
+              "\n"
+              "@glob\n"
+              "SRC = src/*.c\n"
+              "\n"
+              "@pub\n"
+              "@main\n"
+              "task Build()\n"
+              "{\n"
+              "    {arc:CC} {arc:FLAGS} {arc:inline:SRC} --os={arc:__os__}\n"
+              "}\n");
+
+    CHECK(!Load("arcfile", env).has_value());
+
+    const std::string expected = "    gcc -O2 gcc src/a.c src/b.c  --os=" + Core::symbol(Core::SymbolType::OS);
+
+    CHECK(Instrs(env, "Build").size() == 1 && Instrs(env, "Build")[0] == expected);
+}
+
+
+
+TEST_CASE(UndefinedVariableIsReported)
+{
+    ArcanaTest::ScratchDir dir;
+    Semantic::Enviroment   env;
+
+    dir.Write("arcfile",
+              "CC = gcc\n"
+              "\n"
+              "@pub\n"
+              "@main\n"
+              "task Build()\n"
+              "{\n"
+              "    {arc:CC} {arc:MISSING}\n"
+              "}\n");
+
+    const auto err = Load("arcfile", env);
+
+    CHECK(err.has_value() && err->find("Undefined variable") != std::string::npos);
+}
+
+
+
+// ---------------------------------------------------------------------------
+// LIST EXPANSION (user-035)
+// ---------------------------------------------------------------------------
+
+TEST_CASE(ListReferencesInstantiateOneLinePerElement)
+{
+    ArcanaTest::ScratchDir dir;
+    Semantic::Enviroment   env;
+
+    dir.Write("src/a.c", "");
+    dir.Write("src/b.c", "");
+    dir.Write("arcfile",
+              "@glob\n"
+              "SRC = src/*.c\n"
+              "OBJ = obj/*.o\n"
+              "\n"
+              "map SRC -> OBJ;\n"
+              "\n"
+              "@pub\n"
+              "@main\n"
+              "@multithread\n"
+              "task Build()\n"
+              "{\n"
+              "    cc -c {arc:list:SRC} -o {arc:list:OBJ}\n"
+              "}\n");
+
+    CHECK(!Load("arcfile", env).has_value());
+
+    const Semantic::Task::Instrs expected = { "    cc -c src/a.c -o obj/a.o", "    cc -c src/b.c -o obj/b.o" };
+
+    CHECK(Instrs(env, "Build") == expected);
+}
+
+
+
+// ---------------------------------------------------------------------------
+// LEVELLED EXPANSION (user-037)
+// ---------------------------------------------------------------------------
+
+TEST_CASE(VariablesExpandAfterTheVariablesTheyReference)
+{
+    ArcanaTest::ScratchDir dir;
+    Semantic::Enviroment   env;
+
+    // DECLARED USERS FIRST: EXPANSION ORDER COMES FROM THE REFERENCES, NOT THE SCRIPT
+    dir.Write("arcfile",
+              "CMD = {arc:CC} {arc:FLAGS} -c\n"
+              "FLAGS = {arc:OPT} -Wall\n"
+              "OPT = -O2\n"
+              "CC = gcc\n"
+              "\n"
+              "@pub\n"
+              "@main\n"
+              "task Build()\n"
+              "{\n"
+              "    {arc:CMD} main.c\n"
+              "}\n");
+
+    CHECK(!Load("arcfile", env).has_value());
+
+    const auto& instrs = Instrs(env, "Build");
+
+    CHECK(instrs.size() == 1 && instrs[0] == "    gcc -O2 -Wall -c main.c");
+}
+
+
+
+TEST_CASE(CircularReferencesAreReported)
+{
+    ArcanaTest::ScratchDir dir;
+    Semantic::Enviroment   env;
+
+    dir.Write("arcfile",
+              "AA = x {arc:BB}\n"
+              "BB = y {arc:AA}\n"
+              "CC = z\n"
+              "\n"
+              "@pub\n"
+              "@main\n"
+              "task Build()\n"
+              "{\n"
+              "    echo {arc:AA} {arc:CC}\n"
+              "}\n");
+
+    const auto err = Load("arcfile", env);
+
+    CHECK(err.has_value() && err->find("Circular reference") != std::string::npos);
+    CHECK(err.has_value() && err->find("CC") == std::string::npos);
+}
+
+
+
+// ---------------------------------------------------------------------------
+// REACHABILITY (user-036)
+// ---------------------------------------------------------------------------
+
+TEST_CASE(UnreachableTasksAreNotExpanded)
+{
+    ArcanaTest::ScratchDir dir;
+    Semantic::Enviroment   env;
+
+    dir.Write("src/a.c", "");
+    dir.Write("arcfile",
+              "@glob\n"
+              "SRC = src/*.c\n"
+              "\n"
+              "@glob\n"
+              "DOCS = docs/**/*.md\n"
+              "\n"
+              "@pub\n"
+              "@main\n"
+              "task Build()\n"
+              "{\n"
+              "    cc {arc:inline:SRC}\n"
+              "}\n"
+              "\n"
+              "@pub\n"
+              "task Docs()\n"
+              "{\n"
+              "    echo {arc:inline:DOCS} {arc:MISSING}\n"
+              "}\n");
+
+    CHECK(!Load("arcfile", env).has_value());
+    CHECK_EQ(env.vtable.at("SRC").glob_expansion.size(), 1u);
+    CHECK(env.vtable.at("DOCS").glob_expansion.empty());
+}
+
+
+
+// ---------------------------------------------------------------------------
+// FRONT-END COPIES (user-044)
+// ---------------------------------------------------------------------------
+
+TEST_CASE(BodiesJoinsAndProfileVariantsReachTheTables)
+{
+    ArcanaTest::ScratchDir dir;
+    Semantic::Enviroment   env;
+
+    dir.Write("arcfile",
+              "using profiles Debug Release\n"
+              "\n"
+              "FLAGS = -O2\n"
+              "FLAGS += -g\n"
+              "\n"
+              "@profile Debug\n"
+              "MODE = debug\n"
+              "@profile Release\n"
+              "MODE = release\n"
+              "\n"
+              "@pub\n"
+              "@main\n"
+              "task Build()\n"
+              "{\n"
+              "    if true; then\n"
+              "        echo {arc:MODE} {arc:FLAGS}\n"
+              "    fi\n"
+              "\n"
+              "    echo done\n"
+              "}\n");
+
+    CHECK(!Load("arcfile", env).has_value());
+
+    const auto& instrs = Instrs(env, "Build");
+
+    // THE BODY KEEPS ITS NESTING, THE BLANK LINE IS DROPPED
+    CHECK_EQ(instrs.size(), 4u);
+
+    if (instrs.size() == 4)
+    {
+        CHECK_EQ(instrs[0], std::string("    if true; then"));
+        CHECK_EQ(instrs[1].rfind("        echo debug -O2 -g", 0), 0u);
+        CHECK_EQ(instrs[2], std::string("    fi"));
+        CHECK_EQ(instrs[3], std::string("    echo done"));
+    }
+}
+
+
+
+TEST_CASE(BlankChecksAndManglingNeedNoCopies)
+{
+    CHECK(Support::is_blank(""));
+    CHECK(Support::is_blank(" \t\r"));
+    CHECK(!Support::is_blank("  x "));
+
+    CHECK_EQ(Support::generate_mangling("MODE", "Debug"), std::string("MODE@@Debug"));
+}
+
+
+
+// ---------------------------------------------------------------------------
+// ATTRIBUTE INDEX (user-046)
+// ---------------------------------------------------------------------------
+
+/**
+ * @brief Whether every task of a list lives in the task table of @p env.
+ */
+static bool OwnedBy(const std::vector<Semantic::InstructionTask*>& tasks, const Semantic::Enviroment& env)
+{
+    return std::all_of(tasks.begin(), tasks.end(), [&] (const auto* task)
+    {
+        const auto it = env.ftable.find(task->task_name);
+        return it != env.ftable.end() && &it->second == task;
+    });
+}
+
+
+
+TEST_CASE(AttributeIndexFollowsCopiesAndMoves)
+{
+    ArcanaTest::ScratchDir dir;
+    Semantic::Enviroment   env;
+
+    dir.Write("arcfile",
+              "@pub\n"
+              "task Test()\n{\n    echo test\n}\n\n"
+              "@pub\n"
+              "@main\n"
+              "task Build()\n{\n    echo build\n}\n");
+
+    CHECK(!Load("arcfile", env).has_value());
+    CHECK_EQ(env.TasksWith(Semantic::Attr::Type::PUBLIC).size(), 2u);
+
+    // A COPY INDEXES ITS OWN TABLE, NOT THE ONE IT WAS COPIED FROM
+    Semantic::Enviroment copy = env;
+
+    CHECK_EQ(copy.TasksWith(Semantic::Attr::Type::PUBLIC).size(), 2u);
+    CHECK(OwnedBy(copy.TasksWith(Semantic::Attr::Type::PUBLIC), copy));
+    CHECK(OwnedBy(copy.TasksWith(Semantic::Attr::Type::MAIN),   copy));
+
+    Semantic::Enviroment assigned;
+
+    assigned.TasksWith(Semantic::Attr::Type::MAIN);
+    assigned = copy;
+
+    CHECK_EQ(assigned.TasksWith(Semantic::Attr::Type::MAIN).size(), 1u);
+    CHECK(OwnedBy(assigned.TasksWith(Semantic::Attr::Type::MAIN), assigned));
+
+    // A MOVE KEEPS THE TABLE NODES, SO THE INDEX STAYS VALID
+    Semantic::Enviroment moved = std::move(copy);
+
+    CHECK_EQ(moved.TasksWith(Semantic::Attr::Type::PUBLIC).size(), 2u);
+    CHECK(OwnedBy(moved.TasksWith(Semantic::Attr::Type::PUBLIC), moved));
+    CHECK_EQ(moved.TasksWith(Semantic::Attr::Type::MAIN).front()->task_name, std::string("Build"));
+}
+
+
+
+// ---------------------------------------------------------------------------
+// JOB PLANNING (user-048)
+// ---------------------------------------------------------------------------
+
+TEST_CASE(JobsFollowRequiresAndThens)
+{
+    ArcanaTest::ScratchDir dir;
+    Semantic::Enviroment   env;
+    Jobs::List             jobs;
+
+    std::vector<std::string> recovery;
+
+    dir.Write("arcfile",
+              "task Fetch()\n{\n    echo fetch\n}\n\n"
+              "@requires Fetch\n"
+              "task Configure()\n{\n    echo configure\n}\n\n"
+              "task Package()\n{\n    echo package\n}\n\n"
+              "@pub\n"
+              "@main\n"
+              "@requires Configure Fetch\n"
+              "@then Package\n"
+              "task Build()\n{\n    echo build\n}\n");
+
+    CHECK(!Load("arcfile", env).has_value());
+    CHECK(Jobs::List::FromEnv(env, jobs, recovery) == Arcana_Result::ARCANA_RESULT__OK);
+
+    std::vector<std::string> order;
+
+    for (const auto& job : jobs.All()) order.push_back(job.name);
+
+    const std::vector<std::string> expected = { "Fetch", "Configure", "Build", "Package" };
+
+    CHECK(order == expected);
+}
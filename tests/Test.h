@@ -0,0 +1,232 @@
+#ifndef __ARCANA_TEST_H__
+#define __ARCANA_TEST_H__
+
+/**
+ * @defgroup Test Test Harness
+ * @brief Minimal harness shared by the test programs under `tests/`.
+ *
+ * Every `tests/NameTest.cpp` file is built into its own program, linked against
+ * the Arcana objects (all but the CLI entry point), and run by `make test`.
+ * A test program includes this header once: it provides test registration,
+ * check macros, a scratch working directory and `main`.
+ */
+
+
+/**
+ * @addtogroup Test
+ * @{
+ */
+
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <filesystem>
+#include <system_error>
+
+
+
+namespace ArcanaTest
+{
+
+namespace fs = std::filesystem;
+
+
+
+/**
+ * @brief A registered test case.
+ */
+struct Case
+{
+    const char* name;   ///< Test name.
+    void      (*fn)();  ///< Test body.
+};
+
+
+
+/**
+ * @brief Registered test cases, in definition order.
+ */
+inline std::vector<Case>& Registry()
+{
+    static std::vector<Case> cases;
+    return cases;
+}
+
+
+
+/**
+ * @brief Failed checks of the running test.
+ */
+inline std::atomic<int>& Failures()
+{
+    static std::atomic<int> failures { 0 };
+    return failures;
+}
+
+
+
+/**
+ * @brief Register a test case.
+ * @return Always true (used to run registration at static init time).
+ */
+inline bool Register(const char* name, void (*fn)())
+{
+    Registry().push_back( Case{ name, fn } );
+    return true;
+}
+
+
+
+/**
+ * @brief Report a failed check.
+ */
+inline void Fail(const char* file, int line, const std::string& what)
+{
+    ++Failures();
+    std::cerr << file << ":" << line << ": check failed: " << what << std::endl;
+}
+
+
+
+/**
+ * @brief Fresh temporary directory made the working directory for its lifetime.
+ *
+ * Arcana keeps its state (`.arcana`) and resolves globs relative to the working
+ * directory, so every test runs inside its own scratch tree.
+ */
+class ScratchDir
+{
+public:
+    ScratchDir()
+        : previous(fs::current_path())
+    {
+        static int counter = 0;
+
+        const auto tick = std::chrono::steady_clock::now().time_since_epoch().count();
+
+        root = fs::temp_directory_path() / ("arcana-test-" + std::to_string(tick) + "-" + std::to_string(counter++));
+
+        fs::create_directories(root);
+        fs::current_path(root);
+    }
+
+    ~ScratchDir()
+    {
+        std::error_code ec;
+
+        fs::current_path(previous, ec);
+        fs::remove_all(root, ec);
+    }
+
+    ScratchDir(const ScratchDir&)            = delete;
+    ScratchDir& operator=(const ScratchDir&) = delete;
+
+    /**
+     * @brief Write a file (creating its parent folders) relative to the scratch root.
+     */
+    void Write(const fs::path& file, const std::string& content) const
+    {
+        if (file.has_parent_path())
+        {
+            fs::create_directories(root / file.parent_path());
+        }
+
+        std::ofstream(root / file, std::ios::binary | std::ios::trunc) << content;
+    }
+
+    /**
+     * @brief Read a file relative to the scratch root (empty if missing).
+     */
+    std::string Read(const fs::path& file) const
+    {
+        std::ifstream      in(root / file, std::ios::binary);
+        std::ostringstream ss;
+
+        ss << in.rdbuf();
+        return ss.str();
+    }
+
+    /**
+     * @brief Absolute scratch root.
+     */
+    const fs::path& Root() const noexcept
+    {
+        return root;
+    }
+
+private:
+    fs::path previous;
+    fs::path root;
+};
+
+} // namespace ArcanaTest
+
+
+
+/**
+ * @brief Define and register a test case.
+ */
+#define TEST_CASE(name)                                                                         \
+    static void name();                                                                         \
+    static const bool name##_registered = ArcanaTest::Register(#name, name);                    \
+    static void name()
+
+/**
+ * @brief Check a condition, reporting and counting a failure without stopping the test.
+ */
+#define CHECK(cond)                                                                             \
+    do { if (!(cond)) ArcanaTest::Fail(__FILE__, __LINE__, #cond); } while (0)
+
+/**
+ * @brief Check two values for equality, printing both on failure.
+ */
+#define CHECK_EQ(a, b)                                                                          \
+    do {                                                                                        \
+        const auto& _a = (a);                                                                   \
+        const auto& _b = (b);                                                                   \
+        if (!(_a == _b))                                                                        \
+        {                                                                                       \
+            std::ostringstream _ss;                                                             \
+            _ss << #a << " == " << #b << " (" << _a << " vs " << _b << ")";                     \
+            ArcanaTest::Fail(__FILE__, __LINE__, _ss.str());                                    \
+        }                                                                                       \
+    } while (0)
+
+
+
+/**
+ * @brief Run every registered test case.
+ * @return 0 if every check passed, 1 otherwise.
+ */
+int main()
+{
+    int failed = 0;
+
+    for (const auto& test : ArcanaTest::Registry())
+    {
+        ArcanaTest::Failures() = 0;
+
+        test.fn();
+
+        const bool ok = (ArcanaTest::Failures() == 0);
+
+        std::cout << (ok ? "[ OK ] " : "[FAIL] ") << test.name << std::endl;
+
+        failed += ok ? 0 : 1;
+    }
+
+    std::cout << ArcanaTest::Registry().size() - failed << "/" << ArcanaTest::Registry().size() << " passed" << std::endl;
+
+    return failed == 0 ? 0 : 1;
+}
+
+
+/** @} */
+
+#endif /* __ARCANA_TEST_H__ */